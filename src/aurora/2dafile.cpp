@@ -39,6 +39,7 @@
 
 #include "src/aurora/types.h"
 #include "src/aurora/2dafile.h"
+#include "src/aurora/2dasnapshot.h"
 #include "src/aurora/gdafile.h"
 #include "src/aurora/gdaheaders.h"
 #include "src/aurora/gff4file.h"
@@ -50,93 +51,73 @@ static const uint32 kVersion2b = MKTAG('V', '2', '.', 'b');
 
 namespace Aurora {
 
-TwoDARow::TwoDARow(TwoDAFile &parent) : _parent(&parent) {
+TwoDARow::TwoDARow(TwoDAFile &parent, size_t row) : _parent(&parent), _row(row) {
 }
 
 TwoDARow::~TwoDARow() {
 }
 
 const Common::UString &TwoDARow::getString(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
+	if (_parent->isEmptyCell(_row, column))
 		return _parent->_defaultString;
 
-	return cell;
+	return _parent->getCell(_row, column);
 }
 
 const Common::UString &TwoDARow::getString(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
-
-	return cell;
+	return getString(_parent->headerToColumn(column));
 }
 
 int32 TwoDARow::getInt(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
+	// Empty cells already hold the default value
+	if ((column >= _parent->_columns.size()) || (_row >= _parent->_rows.size()))
 		return _parent->_defaultInt;
 
-	return _parent->parseInt(cell);
+	return _parent->_columns[column].ints[_row];
 }
 
 int32 TwoDARow::getInt(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return getInt(_parent->headerToColumn(column));
 }
 
 float TwoDARow::getFloat(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
+	// Empty cells already hold the default value
+	if ((column >= _parent->_columns.size()) || (_row >= _parent->_rows.size()))
 		return _parent->_defaultFloat;
 
-	return _parent->parseFloat(cell);
+	return _parent->_columns[column].floats[_row];
 }
 
 float TwoDARow::getFloat(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
+	return getFloat(_parent->headerToColumn(column));
 }
 
 bool TwoDARow::empty(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return true;
-
-	return false;
+	return _parent->isEmptyCell(_row, column);
 }
 
 bool TwoDARow::empty(const Common::UString &column) const {
 	return empty(_parent->headerToColumn(column));
 }
 
-static const Common::UString kEmpty;
-const Common::UString &TwoDARow::getCell(size_t n) const {
-	if (n >= _data.size())
-		return kEmpty;
-
-	return _data[n];
-}
-
 
 TwoDAFile::TwoDAFile(Common::SeekableReadStream &twoda) :
-	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this) {
+	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this, SIZE_MAX) {
 
 	load(twoda);
 }
 
 TwoDAFile::TwoDAFile(const GDAFile &gda) :
-	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this) {
+	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this, SIZE_MAX) {
 
 	load(gda);
 }
 
+TwoDAFile::TwoDAFile() :
+	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this, SIZE_MAX) {
+
+}
+
 TwoDAFile::~TwoDAFile() {
 }
 
@@ -159,8 +140,7 @@ void TwoDAFile::load(Common::SeekableReadStream &twoda) {
 		else if (_version == kVersion2b)
 			read2b(twoda); // Binary
 
-		// Create the map to quickly translate headers to column indices
-		createHeaderMap();
+		finishLoad();
 
 	} catch (Common::Exception &e) {
 		e.add("Failed reading 2DA file");
@@ -189,8 +169,10 @@ void TwoDAFile::read2a(Common::SeekableReadStream &twoda) {
 
 void TwoDAFile::read2b(Common::SeekableReadStream &twoda) {
 	readHeaders2b(twoda);
-	skipRowNames2b(twoda);
-	readRows2b(twoda);
+
+	const size_t rowCount = skipRowNames2b(twoda);
+
+	readRows2b(twoda, rowCount);
 }
 
 void TwoDAFile::readDefault2a(Common::SeekableReadStream &twoda,
@@ -231,9 +213,9 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 
 	const size_t columnCount = _headers.size();
 
-	while (!twoda.eos()) {
-		Common::ScopedPtr<TwoDARow> row(new TwoDARow(*this));
+	std::vector<Common::UString> cells;
 
+	while (!twoda.eos()) {
 		/* Skip the first token, which is the row index, possibly indented.
 		 * The row index is implicit in the data and its use in the 2DA
 		 * file is only meant as a guideline for people editing the file by
@@ -242,7 +224,7 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 		tokenize.skipToken(twoda);
 
 		// Read all the cells in the row
-		size_t count = tokenize.getTokens(twoda, row->_data, columnCount, columnCount, "****");
+		size_t count = tokenize.getTokens(twoda, cells, columnCount, columnCount, "****");
 
 		// And move to the next line
 		tokenize.nextChunk(twoda);
@@ -251,7 +233,7 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 		if (count == 0)
 			continue;
 
-		_rows.push_back(row.release());
+		addRow(cells);
 	}
 }
 
@@ -272,7 +254,7 @@ void TwoDAFile::readHeaders2b(Common::SeekableReadStream &twoda) {
 	}
 }
 
-void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
+size_t TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	/* Next up are the row names / indices. Like for the ASCII 2DA files,
 	 * the actual row indices are implicit in the data, so we're just
 	 * ignoring them. The only information we care about is how many rows
@@ -280,7 +262,6 @@ void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	 */
 
 	const uint32 rowCount = twoda.readUint32LE();
-	_rows.resize(rowCount, 0);
 
 	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleHeed);
 
@@ -289,9 +270,11 @@ void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	tokenize.addSeparator('\0');
 
 	tokenize.skipToken(twoda, rowCount);
+
+	return rowCount;
 }
 
-void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
+void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda, size_t rowCount) {
 	/* And now read the cells. In binary 2DA files, each cell only
 	 * stores a single 16-bit number, the offset into the data segment
 	 * where the data for this cell can be found. Moreover, a single
@@ -300,7 +283,6 @@ void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
 	 */
 
 	const size_t columnCount = _headers.size();
-	const size_t rowCount    = _rows.size();
 	const size_t cellCount   = columnCount * rowCount;
 
 	Common::ScopedArray<uint32> offsets(new uint32[cellCount]);
@@ -316,20 +298,21 @@ void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
 
 	const size_t dataOffset = twoda.pos();
 
-	for (size_t i = 0; i < rowCount; i++) {
-		_rows[i] = new TwoDARow(*this);
-
-		_rows[i]->_data.resize(columnCount);
+	std::vector<Common::UString> cells;
+	cells.resize(columnCount);
 
+	for (size_t i = 0; i < rowCount; i++) {
 		for (size_t j = 0; j < columnCount; j++) {
 			const size_t offset = dataOffset + offsets[i * columnCount + j];
 
 			twoda.seek(offset);
 
-			_rows[i]->_data[j] = tokenize.getToken(twoda);
-			if (_rows[i]->_data[j].empty())
-				_rows[i]->_data[j] = "****";
+			cells[j] = tokenize.getToken(twoda);
+			if (cells[j].empty())
+				cells[j] = "****";
 		}
+
+		addRow(cells);
 	}
 }
 
@@ -338,6 +321,66 @@ void TwoDAFile::createHeaderMap() {
 		_headerMap.insert(std::make_pair(_headers[i], i));
 }
 
+void TwoDAFile::addRow(const std::vector<Common::UString> &cells) {
+	/* Add a row of cells to the columns. Each distinct cell string is only
+	 * parsed once, and only stored once, in the string pool. Empty cells
+	 * directly get the default values, so that reading them needs no
+	 * special handling. */
+
+	assert(cells.size() == _headers.size());
+
+	_columns.resize(_headers.size());
+
+	for (size_t i = 0; i < cells.size(); i++) {
+		StringPoolMap::iterator pooled = _stringPoolMap.find(cells[i]);
+		if (pooled == _stringPoolMap.end()) {
+			PooledString string;
+
+			string.index = _strings.size();
+			string.empty = cells[i].empty() || (cells[i] == "****");
+
+			string.intValue   = string.empty ? _defaultInt   : parseInt  (cells[i]);
+			string.floatValue = string.empty ? _defaultFloat : parseFloat(cells[i]);
+
+			pooled = _stringPoolMap.insert(std::make_pair(cells[i], string)).first;
+
+			_strings.push_back(cells[i]);
+		}
+
+		Column &column = _columns[i];
+
+		column.strings.push_back(pooled->second.index);
+		column.ints.push_back(pooled->second.intValue);
+		column.floats.push_back(pooled->second.floatValue);
+		column.empty.push_back(pooled->second.empty);
+	}
+
+	_rows.push_back(new TwoDARow(*this, _rows.size()));
+}
+
+void TwoDAFile::finishLoad() {
+	// We don't need to look up cell strings in the pool anymore
+	StringPoolMap().swap(_stringPoolMap);
+
+	// Create the map to quickly translate headers to column indices
+	createHeaderMap();
+}
+
+bool TwoDAFile::isEmptyCell(size_t row, size_t column) const {
+	if ((column >= _columns.size()) || (row >= _rows.size()))
+		return true;
+
+	return _columns[column].empty[row];
+}
+
+static const Common::UString kEmpty;
+const Common::UString &TwoDAFile::getCell(size_t row, size_t column) const {
+	if ((column >= _columns.size()) || (row >= _rows.size()))
+		return kEmpty;
+
+	return _strings[_columns[column].strings[row]];
+}
+
 void TwoDAFile::load(const GDAFile &gda) {
 	try {
 
@@ -351,31 +394,32 @@ void TwoDAFile::load(const GDAFile &gda) {
 			_headers[i] = headerString ? headerString : Common::UString::format("[%u]", headers[i].hash);
 		}
 
-		_rows.resize(gda.getRowCount(), 0);
+		std::vector<Common::UString> cells;
+
 		for (size_t i = 0; i < gda.getRowCount(); i++) {
 			const GFF4Struct *row = gda.getRow(i);
 
-			_rows[i] = new TwoDARow(*this);
-			_rows[i]->_data.resize(gda.getColumnCount());
+			cells.clear();
+			cells.resize(gda.getColumnCount());
 
 			for (size_t j = 0; j < gda.getColumnCount(); j++) {
 				if (row) {
 					switch (headers[j].type) {
 						case GDAFile::kTypeString:
 						case GDAFile::kTypeResource:
-							_rows[i]->_data[j] = row->getString(headers[j].field);
+							cells[j] = row->getString(headers[j].field);
 							break;
 
 						case GDAFile::kTypeInt:
-							_rows[i]->_data[j] = Common::UString::format("%d", (int) row->getSint(headers[j].field));
+							cells[j] = Common::UString::format("%d", (int) row->getSint(headers[j].field));
 							break;
 
 						case GDAFile::kTypeFloat:
-							_rows[i]->_data[j] = Common::UString::format("%f", row->getDouble(headers[j].field));
+							cells[j] = Common::UString::format("%f", row->getDouble(headers[j].field));
 							break;
 
 						case GDAFile::kTypeBool:
-							_rows[i]->_data[j] = Common::UString::format("%u", (uint) row->getUint(headers[j].field));
+							cells[j] = Common::UString::format("%u", (uint) row->getUint(headers[j].field));
 							break;
 
 						default:
@@ -383,10 +427,12 @@ void TwoDAFile::load(const GDAFile &gda) {
 					}
 				}
 
-				if (_rows[i]->_data[j].empty())
-					_rows[i]->_data[j] = "****";
+				if (cells[j].empty())
+					cells[j] = "****";
 
 			}
+
+			addRow(cells);
 		}
 
 	} catch (Common::Exception &e) {
@@ -394,7 +440,7 @@ void TwoDAFile::load(const GDAFile &gda) {
 		throw;
 	}
 
-	createHeaderMap();
+	finishLoad();
 }
 
 size_t TwoDAFile::getRowCount() const {
@@ -431,13 +477,25 @@ const TwoDARow &TwoDAFile::getRow(const Common::UString &header, const Common::U
 	if (columnIndex == kFieldIDInvalid)
 		return _emptyRow;
 
-	for (std::vector<TwoDARow *>::const_iterator row = _rows.begin(); row != _rows.end(); ++row) {
-		if ((*row)->getString(columnIndex).equalsIgnoreCase(value))
-			return **row;
+	Common::StackLock lock(_rowIndexMutex);
+
+	const RowIndex::Index *index = _rowIndex.get(columnIndex);
+	if (!index) {
+		// First search in this column, create its index
+
+		RowIndex::Index newIndex;
+		for (size_t i = 0; i < _rows.size(); i++)
+			RowIndex::add(newIndex, _rows[i]->getString(columnIndex), i);
+
+		index = &_rowIndex.set(columnIndex, newIndex);
 	}
 
-	// No such row
-	return _emptyRow;
+	const size_t row = RowIndex::find(*index, value);
+	if (row == RowIndex::kInvalidRow)
+		// No such row
+		return _emptyRow;
+
+	return *_rows[row];
 }
 
 void TwoDAFile::writeASCII(Common::WriteStream &out) const {
@@ -460,9 +518,11 @@ void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 		colLength[i + 1] = _headers[i].size();
 
 	for (size_t i = 0; i < _rows.size(); i++) {
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool   needQuote = _rows[i]->_data[j].contains(' ');
-			const size_t length    = needQuote ? _rows[i]->_data[j].size() + 2 : _rows[i]->_data[j].size();
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const Common::UString &cell = getCell(i, j);
+
+			const bool   needQuote = cell.contains(' ');
+			const size_t length    = needQuote ? cell.size() + 2 : cell.size();
 
 			colLength[j + 1] = MAX<size_t>(colLength[j + 1], length);
 		}
@@ -482,14 +542,16 @@ void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 	for (size_t i = 0; i < _rows.size(); i++) {
 		out.writeString(Common::UString::format("%*u", (int)colLength[0], (uint)i));
 
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool needQuote = _rows[i]->_data[j].contains(' ');
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const Common::UString &cell = getCell(i, j);
+
+			const bool needQuote = cell.contains(' ');
 
 			Common::UString cellString;
 			if (needQuote)
-				cellString = Common::UString::format("\"%s\"", _rows[i]->_data[j].c_str());
+				cellString = Common::UString::format("\"%s\"", cell.c_str());
 			else
-				cellString = _rows[i]->_data[j];
+				cellString = cell;
 
 			out.writeString(Common::UString::format(" %-*s", (int)colLength[j + 1], cellString.c_str()));
 
@@ -641,19 +703,21 @@ void TwoDAFile::writeCSV(Common::WriteStream &out) const {
 	// Write array
 
 	for (size_t i = 0; i < _rows.size(); i++) {
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool needQuote = _rows[i]->_data[j].contains(',');
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const Common::UString &cell = getCell(i, j);
+
+			const bool needQuote = cell.contains(',');
 
 			if (needQuote)
 				out.writeByte('"');
 
-			if (_rows[i]->_data[j] != "****")
-				out.writeString(_rows[i]->_data[j]);
+			if (cell != "****")
+				out.writeString(cell);
 
 			if (needQuote)
 				out.writeByte('"');
 
-			if (j < (_rows[i]->_data.size() - 1))
+			if (j < (_columns.size() - 1))
 				out.writeByte(',');
 		}
 
@@ -674,6 +738,106 @@ bool TwoDAFile::writeCSV(const Common::UString &fileName) const {
 	return true;
 }
 
+void TwoDAFile::writeSnapshot(Common::WriteStream &out) const {
+	out.writeUint32BE(_id);
+	out.writeUint32BE(_version);
+
+	TwoDASnapshot::writeString(out, _defaultString);
+	out.writeSint32LE(_defaultInt);
+	out.writeIEEEFloatLE(_defaultFloat);
+
+	out.writeUint32LE(_headers.size());
+	for (std::vector<Common::UString>::const_iterator h = _headers.begin(); h != _headers.end(); ++h)
+		TwoDASnapshot::writeString(out, *h);
+
+	/* Store the parsed values of the pooled strings, so that reading the
+	 * snapshot back doesn't need to parse them again. */
+
+	out.writeUint32LE(_strings.size());
+	for (std::vector<Common::UString>::const_iterator s = _strings.begin(); s != _strings.end(); ++s) {
+		const bool empty = s->empty() || (*s == "****");
+
+		TwoDASnapshot::writeString(out, *s);
+
+		out.writeSint32LE(empty ? _defaultInt : parseInt(*s));
+		out.writeIEEEFloatLE(empty ? _defaultFloat : parseFloat(*s));
+		out.writeByte(empty ? 1 : 0);
+	}
+
+	out.writeUint32LE(_rows.size());
+	for (size_t i = 0; i < _columns.size(); i++)
+		for (size_t j = 0; j < _rows.size(); j++)
+			out.writeUint32LE(_columns[i].strings[j]);
+}
+
+TwoDAFile *TwoDAFile::readSnapshot(Common::SeekableReadStream &snapshot) {
+	Common::ScopedPtr<TwoDAFile> twoda(new TwoDAFile);
+
+	try {
+		twoda->_id      = snapshot.readUint32BE();
+		twoda->_version = snapshot.readUint32BE();
+
+		twoda->_defaultString = TwoDASnapshot::readString(snapshot);
+		twoda->_defaultInt    = snapshot.readSint32LE();
+		twoda->_defaultFloat  = snapshot.readIEEEFloatLE();
+
+		twoda->_headers.resize(TwoDASnapshot::readCount(snapshot, 4));
+		for (size_t i = 0; i < twoda->_headers.size(); i++)
+			twoda->_headers[i] = TwoDASnapshot::readString(snapshot);
+
+		std::vector<PooledString> pool(TwoDASnapshot::readCount(snapshot, 13));
+
+		twoda->_strings.resize(pool.size());
+		for (size_t i = 0; i < pool.size(); i++) {
+			twoda->_strings[i] = TwoDASnapshot::readString(snapshot);
+
+			pool[i].index      = i;
+			pool[i].intValue   = snapshot.readSint32LE();
+			pool[i].floatValue = snapshot.readIEEEFloatLE();
+			pool[i].empty      = snapshot.readByte() != 0;
+		}
+
+		const size_t columnCount = twoda->_headers.size();
+		const size_t rowCount    = snapshot.readUint32LE();
+
+		if ((columnCount > 0) && (rowCount > ((snapshot.size() - snapshot.pos()) / (4 * columnCount))))
+			throw Common::Exception(Common::kReadError);
+
+		twoda->_columns.resize(columnCount);
+		for (size_t i = 0; i < columnCount; i++) {
+			Column &column = twoda->_columns[i];
+
+			column.strings.resize(rowCount);
+			column.ints.resize(rowCount);
+			column.floats.resize(rowCount);
+			column.empty.resize(rowCount);
+
+			for (size_t j = 0; j < rowCount; j++) {
+				const uint32 index = snapshot.readUint32LE();
+				if (index >= pool.size())
+					throw Common::Exception("Invalid string index %u", index);
+
+				column.strings[j] = index;
+				column.ints   [j] = pool[index].intValue;
+				column.floats [j] = pool[index].floatValue;
+				column.empty  [j] = pool[index].empty;
+			}
+		}
+
+		twoda->_rows.reserve(rowCount);
+		for (size_t i = 0; i < rowCount; i++)
+			twoda->_rows.push_back(new TwoDARow(*twoda, i));
+
+		twoda->finishLoad();
+
+	} catch (Common::Exception &e) {
+		e.add("Failed reading 2DA snapshot");
+		throw;
+	}
+
+	return twoda.release();
+}
+
 int32 TwoDAFile::parseInt(const Common::UString &str) {
 	if (str.empty())
 		return 0;
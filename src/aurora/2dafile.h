@@ -29,12 +29,15 @@
 #include <map>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
 #include "src/common/ptrvector.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/aurorafile.h"
+#include "src/aurora/columnindex.h"
 
 namespace Common {
 	class SeekableReadStream;
@@ -54,7 +57,11 @@ class GDAFile;
  *  string.
  *
  *  For convenience's sake, there are also methods to directly parse
- *  the cell strings into integer or floating point values.
+ *  the cell strings into integer or floating point values. These
+ *  values are parsed once, when the 2DA is loaded, so reading them
+ *  is cheap. Reading a cell by column index is a simple array access,
+ *  so code that reads the same column in many rows should look up
+ *  the column index once with TwoDAFile::headerToColumn().
  *
  *  See also class TwoDAFile.
  */
@@ -83,13 +90,11 @@ public:
 private:
 	TwoDAFile *_parent; ///< The parent 2DA.
 
-	std::vector<Common::UString> _data;
+	size_t _row; ///< The index of this row within the parent 2DA.
 
-	TwoDARow(TwoDAFile &parent);
+	TwoDARow(TwoDAFile &parent, size_t row);
 	~TwoDARow();
 
-	const Common::UString &getCell(size_t n) const;
-
 	friend class TwoDAFile;
 
 	template<typename T>
@@ -119,6 +124,11 @@ private:
  *  be read and modified with a simple text editor. The binary
  *  version cannot.
  *
+ *  Internally, the cells are stored column by column. Each column
+ *  holds, for every row, an index into a pool of distinct cell
+ *  strings, the cell parsed into an integer and a floating point
+ *  value, and whether the cell is empty.
+ *
  *  See also classes TwoDARow and TwoDARegistry.
  */
 class TwoDAFile : boost::noncopyable, public AuroraFile {
@@ -142,7 +152,13 @@ public:
 	/** Get a row. */
 	const TwoDARow &getRow(size_t row) const;
 
-	/** Get a row whose value in the column named header is the given string value. */
+	/** Get a row whose value in the column named header is the given string value.
+	 *
+	 *  The values are compared case-insensitively. Should several rows match,
+	 *  the first of them is returned. The first search in a column builds an
+	 *  index of all its values, making every later search in that column
+	 *  a simple hash lookup.
+	 */
 	const TwoDARow &getRow(const Common::UString &header, const Common::UString &value) const;
 
 	// .--- 2DA file writers
@@ -162,9 +178,43 @@ public:
 	bool writeCSV(const Common::UString &fileName) const;
 	// '---
 
+	// .--- Snapshots
+	/** Write the already parsed 2DA data into a snapshot.
+	 *
+	 *  A snapshot holds the cells exactly as they are stored internally, so
+	 *  that it can be read back without any tokenizing or number parsing.
+	 *  It is only meant to be stored within a TwoDASnapshot, which
+	 *  identifies and versions the format.
+	 */
+	void writeSnapshot(Common::WriteStream &out) const;
+
+	/** Create a 2DA out of a snapshot written by writeSnapshot(). */
+	static TwoDAFile *readSnapshot(Common::SeekableReadStream &snapshot);
+	// '---
+
 private:
 	typedef std::map<Common::UString, size_t, Common::UString::iless> HeaderMap;
 
+	/** All cells of a column, parsed into their different types. */
+	struct Column {
+		std::vector<uint32> strings; ///< Indices into the string pool.
+		std::vector<int32>  ints;    ///< The cells parsed into ints.
+		std::vector<float>  floats;  ///< The cells parsed into floats.
+		std::vector<bool>   empty;   ///< Is the cell empty?
+	};
+
+	/** A distinct cell string, already parsed into its different types. */
+	struct PooledString {
+		uint32 index;      ///< Index into the string pool.
+		int32  intValue;   ///< The string parsed into an int.
+		float  floatValue; ///< The string parsed into a float.
+		bool   empty;      ///< Is this an empty cell?
+	};
+
+	typedef boost::unordered_map<Common::UString, PooledString, Common::hashUStringCaseSensitive> StringPoolMap;
+
+	typedef ColumnIndex<Common::UString, Common::hashUStringCaseInsensitive, Common::UString::iequal> RowIndex;
+
 	Common::UString _defaultString; ///< The default string to return should a cell not exist.
 	int32           _defaultInt;    ///< The default int to return should a cell not exist.
 	float           _defaultFloat;  ///< The default float to return should a cell not exist.
@@ -175,6 +225,19 @@ private:
 	TwoDARow _emptyRow;
 	Common::PtrVector<TwoDARow> _rows;
 
+	std::vector<Column> _columns; ///< The cells, column by column.
+
+	std::vector<Common::UString> _strings; ///< All distinct cell strings.
+	StringPoolMap _stringPoolMap;          ///< Translating cell strings into the pool, while loading.
+
+	/** Indices for finding rows by their cell value, built on demand. */
+	mutable RowIndex _rowIndex;
+	/** Protects building and searching the row indices from const methods. */
+	mutable Common::Mutex _rowIndexMutex;
+
+	/** Create an empty 2DA, to be filled by readSnapshot(). */
+	TwoDAFile();
+
 	// Loading helpers
 	void load(Common::SeekableReadStream &twoda);
 	void read2a(Common::SeekableReadStream &twoda);
@@ -186,15 +249,24 @@ private:
 	void readRows2a   (Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
 
 	// Binary loading helpers
-	void readHeaders2b (Common::SeekableReadStream &twoda);
-	void skipRowNames2b(Common::SeekableReadStream &twoda);
-	void readRows2b    (Common::SeekableReadStream &twoda);
+	void   readHeaders2b (Common::SeekableReadStream &twoda);
+	size_t skipRowNames2b(Common::SeekableReadStream &twoda);
+	void   readRows2b    (Common::SeekableReadStream &twoda, size_t rowCount);
 
 	// GDA loading/conversion helpers
 	void load(const GDAFile &gda);
 
 	void createHeaderMap();
 
+	// Cell storage helpers
+	void addRow(const std::vector<Common::UString> &cells);
+	void finishLoad();
+
+	/** Is this cell empty or does it not exist? */
+	bool isEmptyCell(size_t row, size_t column) const;
+	/** Return the raw string of this cell, or an empty string if the cell doesn't exist. */
+	const Common::UString &getCell(size_t row, size_t column) const;
+
 	static int32 parseInt(const Common::UString &str);
 	static float parseFloat(const Common::UString &str);
 
@@ -24,7 +24,9 @@
 
 #include "src/common/error.h"
 #include "src/common/scopedptr.h"
+#include "src/common/ptrvector.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
 
 #include "src/aurora/2dareg.h"
 #include "src/aurora/types.h"
@@ -36,7 +38,7 @@ DECLARE_SINGLETON(Aurora::TwoDARegistry)
 
 namespace Aurora {
 
-TwoDARegistry::TwoDARegistry() {
+TwoDARegistry::TwoDARegistry() : _hasSnapshot(false) {
 }
 
 TwoDARegistry::~TwoDARegistry() {
@@ -45,9 +47,29 @@ TwoDARegistry::~TwoDARegistry() {
 
 void TwoDARegistry::clear() {
 	_twodas.clear();
+	_m2das.clear();
 	_gdas.clear();
 }
 
+bool TwoDARegistry::loadSnapshot(const Common::UString &fileName) {
+	_hasSnapshot = true;
+
+	return _snapshot.load(fileName);
+}
+
+void TwoDARegistry::saveSnapshot(const Common::UString &fileName) {
+	if (!_hasSnapshot || !_snapshot.isModified())
+		return;
+
+	_snapshot.save(fileName);
+}
+
+void TwoDARegistry::clearSnapshot() {
+	_snapshot.clear();
+
+	_hasSnapshot = false;
+}
+
 const TwoDAFile &TwoDARegistry::get2DA(const Common::UString &name) {
 	TwoDAMap::const_iterator twoda = _twodas.find(name);
 	if (twoda != _twodas.end())
@@ -64,6 +86,22 @@ const TwoDAFile &TwoDARegistry::get2DA(const Common::UString &name) {
 	return *result.first->second;
 }
 
+const TwoDAFile &TwoDARegistry::getM2DA(const Common::UString &prefix) {
+	TwoDAMap::const_iterator twoda = _m2das.find(prefix);
+	if (twoda != _m2das.end())
+		// Entry exists => return
+		return *twoda->second;
+
+	// Entry doesn't exist => load and add
+
+	TwoDAFile *newTwoDA = loadM2DA(prefix);
+
+	std::pair<TwoDAMap::iterator, bool> result;
+	result = _m2das.insert(std::make_pair(prefix, newTwoDA));
+
+	return *result.first->second;
+}
+
 const GDAFile &TwoDARegistry::getGDA(const Common::UString &name) {
 	GDAMap::const_iterator gda = _gdas.find(name);
 	if (gda != _gdas.end())
@@ -153,7 +191,24 @@ TwoDAFile *TwoDARegistry::load2DA(const Common::UString &name) {
 		if (!twodaFile)
 			throw Common::Exception("No such 2DA");
 
-		twoda.reset(new TwoDAFile(*twodaFile));
+		if (!_hasSnapshot) {
+			twoda.reset(new TwoDAFile(*twodaFile));
+			return twoda.release();
+		}
+
+		// Read the whole 2DA, to check it against the snapshot
+		Common::ScopedPtr<Common::MemoryReadStream> data(twodaFile->readStream(twodaFile->size()));
+
+		const uint64 hash = TwoDASnapshot::hashData(data->getData(), data->size());
+
+		twoda.reset(_snapshot.get(name, data->size(), hash));
+		if (twoda)
+			return twoda.release();
+
+		// Not in the snapshot, or changed since => parse it and remember it
+		twoda.reset(new TwoDAFile(*data));
+
+		_snapshot.add(name, data->size(), hash, *twoda);
 
 	} catch (Common::Exception &e) {
 		e.add("Failed loading 2DA \"%s\"", name.c_str());
@@ -182,30 +237,40 @@ GDAFile *TwoDARegistry::loadGDA(const Common::UString &name) {
 	return gda.release();
 }
 
-GDAFile *TwoDARegistry::loadMGDA(Common::UString prefix) {
-	/* Load multiple GDAs with the same prefix, and merge them together into a single GDA. */
+void TwoDARegistry::findMGDA(Common::UString prefix, std::list<Common::UString> &gdas) {
+	/* Find all GDAs with the same prefix, which are to be merged together into a single GDA. */
 
 	if (prefix.empty())
 		throw Common::Exception("Trying to load MGDA \"\"");
 
 	prefix.makeLower();
 
-	std::list<ResourceManager::ResourceID> gdas;
-	ResMan.getAvailableResources(kFileTypeGDA, gdas);
+	std::list<ResourceManager::ResourceID> resources;
+	ResMan.getAvailableResources(kFileTypeGDA, resources);
+
+	for (std::list<ResourceManager::ResourceID>::const_iterator r = resources.begin(); r != resources.end(); ++r)
+		if (r->name.toLower().beginsWith(prefix))
+			gdas.push_back(r->name);
+
+	if (gdas.empty())
+		throw Common::Exception("No such GDA");
+}
+
+GDAFile *TwoDARegistry::loadMGDA(const Common::UString &prefix) {
+	/* Load multiple GDAs with the same prefix, and merge them together into a single GDA. */
 
 	Common::ScopedPtr<GDAFile> gda;
 
 	try {
-		for (std::list<ResourceManager::ResourceID>::const_iterator g = gdas.begin(); g != gdas.end(); ++g) {
-			// Find all GDAs that match the prefix
-			if (!g->name.toLower().beginsWith(prefix))
-				continue;
+		std::list<Common::UString> gdas;
+		findMGDA(prefix, gdas);
 
+		for (std::list<Common::UString>::const_iterator g = gdas.begin(); g != gdas.end(); ++g) {
 			// Load the GDA
 
-			Common::ScopedPtr<Common::SeekableReadStream> stream(ResMan.getResource(g->name, kFileTypeGDA));
+			Common::ScopedPtr<Common::SeekableReadStream> stream(ResMan.getResource(*g, kFileTypeGDA));
 			if (!stream)
-				throw Common::Exception("No such GDA \"%s\"", g->name.c_str());
+				throw Common::Exception("No such GDA \"%s\"", g->c_str());
 
 			// If this is the first GDA, plain load it. Otherwise, merge it into the first one
 			if (!gda)
@@ -214,9 +279,6 @@ GDAFile *TwoDARegistry::loadMGDA(Common::UString prefix) {
 				gda->add(stream.release());
 		}
 
-		if (!gda)
-			throw Common::Exception("No such GDA");
-
 	} catch (Common::Exception &e) {
 		e.add("Failed loading multiple GDA \"%s\"", prefix.c_str());
 		throw;
@@ -225,4 +287,68 @@ GDAFile *TwoDARegistry::loadMGDA(Common::UString prefix) {
 	return gda.release();
 }
 
+TwoDAFile *TwoDARegistry::loadM2DA(const Common::UString &prefix) {
+	/* Load multiple GDAs with the same prefix, merge them together and
+	 * convert the result into a 2DA. Unlike the GDAs themselves, this
+	 * converted 2DA can be kept in the snapshot. */
+
+	if (!_hasSnapshot) {
+		Common::ScopedPtr<GDAFile> gda(loadMGDA(prefix));
+
+		return new TwoDAFile(*gda);
+	}
+
+	Common::PtrVector<Common::MemoryReadStream> data;
+	Common::ScopedPtr<TwoDAFile> twoda;
+
+	try {
+		std::list<Common::UString> gdas;
+		findMGDA(prefix, gdas);
+
+		// Read all the GDAs, to check them together against the snapshot
+
+		uint64 size = 0;
+		uint64 hash = TwoDASnapshot::kHashInit;
+
+		for (std::list<Common::UString>::const_iterator g = gdas.begin(); g != gdas.end(); ++g) {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(ResMan.getResource(*g, kFileTypeGDA));
+			if (!stream)
+				throw Common::Exception("No such GDA \"%s\"", g->c_str());
+
+			data.push_back(stream->readStream(stream->size()));
+
+			size += data.back()->size();
+			hash  = TwoDASnapshot::hashData(data.back()->getData(), data.back()->size(), hash);
+		}
+
+		const Common::UString name = prefix + ".m2da";
+
+		twoda.reset(_snapshot.get(name, size, hash));
+		if (twoda)
+			return twoda.release();
+
+		// Not in the snapshot, or changed since => merge, convert and remember it
+
+		Common::ScopedPtr<GDAFile> gda;
+		for (size_t i = 0; i < data.size(); i++) {
+			Common::MemoryReadStream *stream = new Common::MemoryReadStream(data[i]->getData(), data[i]->size());
+
+			if (!gda)
+				gda.reset(new GDAFile(stream));
+			else
+				gda->add(stream);
+		}
+
+		twoda.reset(new TwoDAFile(*gda));
+
+		_snapshot.add(name, size, hash, *twoda);
+
+	} catch (Common::Exception &e) {
+		e.add("Failed loading multiple GDA \"%s\" as 2DA", prefix.c_str());
+		throw;
+	}
+
+	return twoda.release();
+}
+
 } // End of namespace Aurora
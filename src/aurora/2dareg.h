@@ -25,10 +25,14 @@
 #ifndef AURORA_2DAREG_H
 #define AURORA_2DAREG_H
 
+#include <list>
+
 #include "src/common/ptrmap.h"
 #include "src/common/singleton.h"
 #include "src/common/ustring.h"
 
+#include "src/aurora/2dasnapshot.h"
+
 namespace Aurora {
 
 class TwoDAFile;
@@ -54,6 +58,12 @@ class GDAFile;
  *
  *  All 2DA and GDA files are directly and automatically loaded from
  *  the ResourceManager.
+ *
+ *  Optionally, the registry keeps a snapshot of all parsed 2DAs (see
+ *  TwoDASnapshot), which can be saved to disk and loaded again on the
+ *  next start. 2DAs whose resource data hasn't changed are then created
+ *  out of the snapshot instead of being parsed again. This includes
+ *  MGDAs requested as a 2DA with getM2DA().
  */
 class TwoDARegistry : public Common::Singleton<TwoDARegistry> {
 public:
@@ -71,6 +81,12 @@ public:
 	/** Get a certain multiple GDA, loading it if necessary. */
 	const GDAFile &getMGDA(const Common::UString &prefix);
 
+	/** Get a certain multiple GDA converted into a 2DA, loading it if necessary.
+	 *
+	 *  Unlike the GDA returned by getMGDA(), the 2DA is kept in the snapshot.
+	 */
+	const TwoDAFile &getM2DA(const Common::UString &prefix);
+
 	/** Add a certain 2DA to the registry, reloading it if necessary. */
 	void add2DA(const Common::UString &name);
 	/** Remove a certain 2DA from the registry. */
@@ -83,16 +99,44 @@ public:
 	/** Remove a certain GDA from the registry. */
 	void removeGDA(const Common::UString &name);
 
+	// .--- 2DA snapshot
+	/** Load a snapshot of parsed 2DAs from a file, and keep it up-to-date from now on.
+	 *
+	 *  Unlike the 2DAs themselves, the snapshot is not affected by clear().
+	 *
+	 *  @param  fileName The snapshot file to load.
+	 *  @return true if the snapshot was loaded, false otherwise.
+	 */
+	bool loadSnapshot(const Common::UString &fileName);
+
+	/** Save the snapshot of parsed 2DAs into a file.
+	 *
+	 *  If no 2DA has been parsed since the snapshot was loaded,
+	 *  the file is not written.
+	 */
+	void saveSnapshot(const Common::UString &fileName);
+
+	/** Drop the snapshot of parsed 2DAs, and stop keeping one. */
+	void clearSnapshot();
+	// '---
+
 private:
 	typedef Common::PtrMap<Common::UString, TwoDAFile> TwoDAMap;
 	typedef Common::PtrMap<Common::UString, GDAFile> GDAMap;
 
 	TwoDAMap _twodas;
+	TwoDAMap _m2das;
 	GDAMap   _gdas;
 
+	TwoDASnapshot _snapshot;
+	bool          _hasSnapshot; ///< Are we keeping a snapshot of parsed 2DAs?
+
 	TwoDAFile *load2DA(const Common::UString &name);
 	GDAFile   *loadGDA(const Common::UString &name);
-	GDAFile   *loadMGDA(Common::UString prefix);
+	GDAFile   *loadMGDA(const Common::UString &prefix);
+	TwoDAFile *loadM2DA(const Common::UString &prefix);
+
+	void findMGDA(Common::UString prefix, std::list<Common::UString> &gdas);
 };
 
 } // End of namespace Aurora
@@ -0,0 +1,199 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A persistent snapshot of parsed 2DA files.
+ */
+
+#include <cstring>
+
+#include "src/common/scopedptr.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/endianness.h"
+#include "src/common/encoding.h"
+#include "src/common/hash.h"
+#include "src/common/filepath.h"
+#include "src/common/readfile.h"
+#include "src/common/writefile.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/2dasnapshot.h"
+#include "src/aurora/2dafile.h"
+
+static const uint32 kSnapshotID      = MKTAG('X', '2', 'D', 'A');
+static const uint32 kSnapshotVersion = 2;
+
+namespace Aurora {
+
+TwoDASnapshot::Entry::Entry() : size(0), hash(0) {
+}
+
+
+TwoDASnapshot::TwoDASnapshot() : _modified(false) {
+}
+
+TwoDASnapshot::~TwoDASnapshot() {
+}
+
+void TwoDASnapshot::clear() {
+	_entries.clear();
+
+	_modified = false;
+}
+
+bool TwoDASnapshot::isModified() const {
+	return _modified;
+}
+
+bool TwoDASnapshot::load(const Common::UString &fileName) {
+	clear();
+
+	if (!Common::FilePath::isRegularFile(fileName))
+		return false;
+
+	try {
+		// Read the whole snapshot in one go
+		Common::ScopedPtr<Common::MemoryReadStream> stream;
+		{
+			Common::ReadFile file(fileName);
+			stream.reset(file.readStream(file.size()));
+		}
+
+		if ((stream->readUint32BE() != kSnapshotID) || (stream->readUint32LE() != kSnapshotVersion))
+			throw Common::Exception("Not a 2DA snapshot file");
+
+		const uint32 entryCount = readCount(*stream, 24);
+		for (uint32 i = 0; i < entryCount; i++) {
+			const Common::UString name = readString(*stream);
+
+			Entry &entry = _entries[name];
+
+			entry.size = stream->readUint64LE();
+			entry.hash = stream->readUint64LE();
+
+			const uint32 length = stream->readUint32LE();
+			if ((length == 0) || (length > (stream->size() - stream->pos())))
+				throw Common::Exception(Common::kReadError);
+
+			entry.snapshot.resize(length);
+			if (stream->read(&entry.snapshot[0], length) != length)
+				throw Common::Exception(Common::kReadError);
+		}
+
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed to load 2DA snapshot \"%s\"", fileName.c_str());
+
+		clear();
+		return false;
+	}
+
+	_modified = false;
+	return true;
+}
+
+void TwoDASnapshot::save(const Common::UString &fileName) {
+	Common::WriteFile file;
+	if (!file.open(fileName))
+		throw Common::Exception(Common::kOpenError);
+
+	file.writeUint32BE(kSnapshotID);
+	file.writeUint32LE(kSnapshotVersion);
+
+	file.writeUint32LE(_entries.size());
+	for (EntryMap::const_iterator e = _entries.begin(); e != _entries.end(); ++e) {
+		writeString(file, e->first);
+
+		file.writeUint64LE(e->second.size);
+		file.writeUint64LE(e->second.hash);
+
+		file.writeUint32LE(e->second.snapshot.size());
+		file.write(&e->second.snapshot[0], e->second.snapshot.size());
+	}
+
+	file.flush();
+	file.close();
+
+	_modified = false;
+}
+
+TwoDAFile *TwoDASnapshot::get(const Common::UString &name, uint64 size, uint64 hash) const {
+	EntryMap::const_iterator e = _entries.find(name.toLower());
+	if ((e == _entries.end()) || (e->second.size != size) || (e->second.hash != hash))
+		return 0;
+
+	try {
+		Common::MemoryReadStream stream(&e->second.snapshot[0], e->second.snapshot.size());
+
+		return TwoDAFile::readSnapshot(stream);
+
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed to read 2DA \"%s\" from the snapshot", name.c_str());
+	}
+
+	return 0;
+}
+
+void TwoDASnapshot::add(const Common::UString &name, uint64 size, uint64 hash, const TwoDAFile &twoda) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	twoda.writeSnapshot(stream);
+
+	Entry &entry = _entries[name.toLower()];
+
+	entry.size = size;
+	entry.hash = hash;
+
+	entry.snapshot.assign(stream.getData(), stream.getData() + stream.size());
+
+	_modified = true;
+}
+
+uint64 TwoDASnapshot::hashData(const byte *data, size_t size, uint64 hash) {
+	for (size_t i = 0; i < size; i++)
+		hash = Common::hashFNV64(hash, data[i]);
+
+	return hash;
+}
+
+void TwoDASnapshot::writeString(Common::WriteStream &stream, const Common::UString &str) {
+	const uint32 length = std::strlen(str.c_str());
+
+	stream.writeUint32LE(length);
+	stream.write(str.c_str(), length);
+}
+
+Common::UString TwoDASnapshot::readString(Common::SeekableReadStream &stream) {
+	const uint32 length = stream.readUint32LE();
+	if (length > (stream.size() - stream.pos()))
+		throw Common::Exception(Common::kReadError);
+
+	return Common::readStringFixed(stream, Common::kEncodingUTF8, length);
+}
+
+uint32 TwoDASnapshot::readCount(Common::SeekableReadStream &stream, size_t size) {
+	const uint32 count = stream.readUint32LE();
+	if (count > ((stream.size() - stream.pos()) / size))
+		throw Common::Exception(Common::kReadError);
+
+	return count;
+}
+
+} // End of namespace Aurora
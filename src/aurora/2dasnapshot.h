@@ -0,0 +1,142 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A persistent snapshot of parsed 2DA files.
+ */
+
+#ifndef AURORA_2DASNAPSHOT_H
+#define AURORA_2DASNAPSHOT_H
+
+#include <vector>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+namespace Common {
+	class SeekableReadStream;
+	class WriteStream;
+}
+
+namespace Aurora {
+
+class TwoDAFile;
+
+/** A collection of parsed 2DA files, that can be saved to and loaded from disk.
+ *
+ *  Parsing the ASCII 2DAs a game needs, each with up to several thousand
+ *  rows, is a noticeable part of the loading time. The snapshot remembers
+ *  the parsed tables, so that the next time a 2DA is needed, it can be
+ *  created directly out of the snapshot instead.
+ *
+ *  Each entry is keyed by the name of the 2DA and is only valid while the
+ *  size and the hash of the 2DA resource data stay the same. For a 2DA
+ *  that was merged out of several resources, like the M2DAs of the
+ *  Dragon Age games, size and hash cover the data of all of them. The
+ *  whole snapshot is read in one go, but each table is only recreated
+ *  once it is actually requested.
+ *
+ *  The snapshot file is the only place the format is identified and
+ *  versioned. The tables inside are written by TwoDAFile::writeSnapshot(),
+ *  using the string helpers of this class.
+ */
+class TwoDASnapshot : boost::noncopyable {
+public:
+	/** The initial hash of 2DA resource data, see hashData(). */
+	static const uint64 kHashInit = 0xCBF29CE484222325ULL;
+
+	TwoDASnapshot();
+	~TwoDASnapshot();
+
+	/** Remove all entries from the snapshot. */
+	void clear();
+
+	/** Does the snapshot contain entries that haven't been saved yet? */
+	bool isModified() const;
+
+	/** Load the snapshot from a file, replacing all current entries.
+	 *
+	 *  @param  fileName The file to read.
+	 *  @return true if the snapshot was loaded, false if the file
+	 *          doesn't exist or was not a valid snapshot file.
+	 */
+	bool load(const Common::UString &fileName);
+
+	/** Save the snapshot into a file. */
+	void save(const Common::UString &fileName);
+
+	/** Create a 2DA out of the snapshot.
+	 *
+	 *  @param  name The name of the 2DA.
+	 *  @param  size The current size of the 2DA resource data.
+	 *  @param  hash The current hash of the 2DA resource data, see hashData().
+	 *  @return The 2DA, or 0 if there is no entry or the resource has changed since.
+	 */
+	TwoDAFile *get(const Common::UString &name, uint64 size, uint64 hash) const;
+
+	/** Add a parsed 2DA to the snapshot, replacing an existing entry.
+	 *
+	 *  @param name The name of the 2DA.
+	 *  @param size The size of the 2DA resource data the 2DA was parsed from.
+	 *  @param hash The hash of the 2DA resource data, see hashData().
+	 *  @param twoda The parsed 2DA.
+	 */
+	void add(const Common::UString &name, uint64 size, uint64 hash, const TwoDAFile &twoda);
+
+	/** Hash 2DA resource data.
+	 *
+	 *  To hash the data of several resources, pass the hash of the
+	 *  previous ones as the initial hash.
+	 */
+	static uint64 hashData(const byte *data, size_t size, uint64 hash = kHashInit);
+
+	/** Write a string into a snapshot. */
+	static void writeString(Common::WriteStream &stream, const Common::UString &str);
+	/** Read a string written by writeString() out of a snapshot. */
+	static Common::UString readString(Common::SeekableReadStream &stream);
+
+	/** Read a count of records out of a snapshot, making sure they can be
+	 *  there at all, with each record taking at least size bytes. */
+	static uint32 readCount(Common::SeekableReadStream &stream, size_t size);
+
+private:
+	/** The snapshot of one 2DA. */
+	struct Entry {
+		uint64 size; ///< The size of the 2DA resource data.
+		uint64 hash; ///< The hash of the 2DA resource data.
+
+		std::vector<byte> snapshot; ///< The 2DA, as written by TwoDAFile::writeSnapshot().
+
+		Entry();
+	};
+
+	typedef std::map<Common::UString, Entry> EntryMap;
+
+	EntryMap _entries;
+
+	bool _modified;
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_2DASNAPSHOT_H
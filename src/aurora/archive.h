@@ -66,9 +66,13 @@ public:
 	virtual uint32 getResourceSize(uint32 index) const;
 
 	/** Return a stream of the resource's contents.
+	 *
+	 *  This method may be called from several threads at once, even for the
+	 *  same resource. Implementations either never touch the position of the
+	 *  archive stream (see SeekableReadStream::readAt()), or serialize access.
 	 *
 	 *  @param  index The index of the resource we want.
-	 *  @param  tryNoCopy Try to return a SeekableSubReadStream of the archive instead of copying.
+	 *  @param  tryNoCopy Try to return a stream referencing the archive's data instead of copying.
 	 *  @return A (sub)stream of the resource's contents.
 	 */
 	virtual Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const = 0;
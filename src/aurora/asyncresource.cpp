@@ -0,0 +1,121 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A resource read in the background.
+ */
+
+#include "src/common/readstream.h"
+
+#include "src/aurora/asyncresource.h"
+
+namespace Aurora {
+
+AsyncResource::AsyncResource() : _type(kFileTypeNone), _state(kStateDone), _stream(0),
+	_failed(false), _done(_mutex) {
+
+}
+
+AsyncResource::AsyncResource(const Reader &reader, FileType type) : _reader(reader), _type(type),
+	_state(kStatePending), _stream(0), _failed(false), _done(_mutex) {
+
+}
+
+AsyncResource::~AsyncResource() {
+	delete _stream;
+}
+
+bool AsyncResource::exists() const {
+	return !_reader.empty();
+}
+
+FileType AsyncResource::getType() const {
+	return _type;
+}
+
+bool AsyncResource::isDone() const {
+	Common::StackLock lock(_mutex);
+
+	return _state == kStateDone;
+}
+
+Common::SeekableReadStream *AsyncResource::take() {
+	// Don't wait for a worker thread that hasn't even started yet
+	read();
+
+	Common::StackLock lock(_mutex);
+
+	while (_state != kStateDone)
+		_done.wait();
+
+	if (_failed)
+		throw _error;
+
+	Common::SeekableReadStream *stream = _stream;
+	_stream = 0;
+
+	return stream;
+}
+
+void AsyncResource::read() {
+	if (claim())
+		readClaimed();
+}
+
+bool AsyncResource::claim() {
+	Common::StackLock lock(_mutex);
+
+	if (_state != kStatePending)
+		return false;
+
+	_state = kStateReading;
+	return true;
+}
+
+void AsyncResource::readClaimed() {
+	Common::SeekableReadStream *stream = 0;
+
+	bool failed = false;
+	Common::Exception error;
+
+	try {
+		stream = _reader();
+	} catch (Common::Exception &e) {
+		failed = true;
+		error  = e;
+	} catch (std::exception &e) {
+		failed = true;
+		error  = Common::Exception(e);
+	} catch (...) {
+		failed = true;
+		error  = Common::Exception("Unknown exception");
+	}
+
+	Common::StackLock lock(_mutex);
+
+	_stream = stream;
+	_failed = failed;
+	_error  = error;
+	_state  = kStateDone;
+
+	_done.broadcast();
+}
+
+} // End of namespace Aurora
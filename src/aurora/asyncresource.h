@@ -0,0 +1,113 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A resource read in the background.
+ */
+
+#ifndef AURORA_ASYNCRESOURCE_H
+#define AURORA_ASYNCRESOURCE_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "src/common/types.h"
+#include "src/common/error.h"
+#include "src/common/mutex.h"
+
+#include "src/aurora/types.h"
+
+namespace Common {
+	class SeekableReadStream;
+}
+
+namespace Aurora {
+
+/** A resource read in the background, as returned by ResourceManager::getResourceAsync().
+ *
+ *  The resource is read by a worker thread. Taking the resource waits for
+ *  that read to finish. If no worker thread has picked up the read yet, the
+ *  taking thread reads the resource itself instead of waiting in line.
+ */
+class AsyncResource : boost::noncopyable {
+public:
+	/** A function reading the resource. */
+	typedef boost::function<Common::SeekableReadStream *()> Reader;
+
+	/** Create the handle of a resource that doesn't exist. */
+	AsyncResource();
+	/** Create the handle of a resource of this type, to be read with this reader. */
+	AsyncResource(const Reader &reader, FileType type);
+	~AsyncResource();
+
+	/** Does the resource exist? */
+	bool exists() const;
+	/** Return the type of the resource, or kFileTypeNone if the resource doesn't exist. */
+	FileType getType() const;
+
+	/** Has the resource been read already? */
+	bool isDone() const;
+
+	/** Wait for the resource to be read and take over its stream.
+	 *
+	 *  If reading the resource failed, the exception thrown by the read
+	 *  is rethrown here.
+	 *
+	 *  @return The resource stream, or 0 if the resource doesn't exist or
+	 *          the stream has already been taken.
+	 */
+	Common::SeekableReadStream *take();
+
+	/** Read the resource, unless it is already being read. */
+	void read();
+
+private:
+	enum State {
+		kStatePending, ///< The resource still needs to be read.
+		kStateReading, ///< A thread is reading the resource.
+		kStateDone     ///< The resource has been read.
+	};
+
+	Reader   _reader; ///< The function reading the resource.
+	FileType _type;   ///< The type of the resource.
+
+	State _state;
+
+	Common::SeekableReadStream *_stream; ///< The read resource stream.
+
+	bool _failed;             ///< Did reading the resource fail?
+	Common::Exception _error; ///< The reason reading the resource failed.
+
+	mutable Common::Mutex _mutex;
+	Common::Condition _done; ///< Signals that the resource has been read.
+
+	/** Claim reading the resource for the calling thread. */
+	bool claim();
+	/** Read the resource, after the calling thread claimed it. */
+	void readClaimed();
+};
+
+/** A shared handle to a resource read in the background. */
+typedef boost::shared_ptr<AsyncResource> AsyncResourcePtr;
+
+} // End of namespace Aurora
+
+#endif // AURORA_ASYNCRESOURCE_H
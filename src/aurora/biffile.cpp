@@ -31,6 +31,7 @@
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
 
 #include "src/aurora/biffile.h"
@@ -82,17 +83,21 @@ void BIFFile::load(Common::SeekableReadStream &bif) {
 }
 
 void BIFFile::readVarResTable(Common::SeekableReadStream &bif, uint32 offset) {
-	bif.seek(offset);
+	// Read the whole table at once, so that the entries are parsed directly from memory
+	const size_t entrySize = (_version == kVersion11) ? 20 : 16;
+
+	Common::ScopedPtr<Common::SeekableReadStream>
+		table(bif.readStreamAt(offset, _iResources.size() * entrySize));
 
 	for (IResourceList::iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
-		bif.skip(4); // ID
+		table->skip(4); // ID
 
 		if (_version == kVersion11)
-			bif.skip(4); // Flags
+			table->skip(4); // Flags
 
-		res->offset = bif.readUint32LE();
-		res->size   = bif.readUint32LE();
-		res->type   = (FileType) bif.readUint32LE();
+		res->offset = table->readUint32LE();
+		res->size   = table->readUint32LE();
+		res->type   = (FileType) table->readUint32LE();
 	}
 }
 
@@ -142,11 +147,9 @@ Common::SeekableReadStream *BIFFile::getResource(uint32 index, bool tryNoCopy) c
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_bif.get(), res.offset, res.offset + res.size);
-
-	_bif->seek(res.offset);
+		return Common::createSubReadStream(*_bif, res.offset, res.offset + res.size);
 
-	return _bif->readStream(res.size);
+	return _bif->readStreamAt(res.offset, res.size);
 }
 
 } // End of namespace Aurora
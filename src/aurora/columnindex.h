@@ -0,0 +1,114 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A lazily built index from cell values to rows, for table-like files.
+ */
+
+#ifndef AURORA_COLUMNINDEX_H
+#define AURORA_COLUMNINDEX_H
+
+#include <map>
+#include <functional>
+
+#include <boost/unordered/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
+#include "src/common/types.h"
+
+namespace Aurora {
+
+/** An index from the cell values of table columns to the rows holding them.
+ *
+ *  Table-like files, like TwoDAFile and GDAFile, are often searched for the
+ *  row that holds a certain value in a certain column. Instead of scanning
+ *  through all rows for every search, the owning file can build an index for
+ *  a column the first time this column is searched, and keep it around for
+ *  all subsequent searches.
+ *
+ *  Should several rows hold the same value in a column, only the first of
+ *  those rows is found, same as with a linear search.
+ *
+ *  The owner is responsible for building a new index and for
+ *  clearing all indices should the contents of the table change. Since
+ *  the indices are usually built from within const lookup methods, the
+ *  owner also needs to serialize all accesses to them with a mutex.
+ */
+template<typename Value, class Hash = boost::hash<Value>, class Pred = std::equal_to<Value> >
+class ColumnIndex {
+public:
+	static const size_t kInvalidRow = SIZE_MAX;
+
+	typedef boost::unordered_map<Value, size_t, Hash, Pred> Index;
+
+	/** Return the index for this column, or 0 if it hasn't been created yet. */
+	const Index *get(size_t column) const {
+		typename IndexMap::const_iterator index = _indices.find(column);
+		if (index == _indices.end())
+			return 0;
+
+		return &index->second;
+	}
+
+	/** Take over a completely filled index for this column, leaving the passed index empty.
+	 *
+	 *  The index should be built with add() first, so that a failure while
+	 *  reading the cells never leaves a partial index behind.
+	 */
+	const Index &set(size_t column, Index &index) {
+		Index &newIndex = _indices[column];
+
+		newIndex.clear();
+		newIndex.swap(index);
+
+		return newIndex;
+	}
+
+	/** Remove all indices. */
+	void clear() {
+		_indices.clear();
+	}
+
+	/** Add this row to the index, unless an earlier row already holds the same value. */
+	static void add(Index &index, const Value &value, size_t row) {
+		index.insert(std::make_pair(value, row));
+	}
+
+	/** Find the first row holding this value, or kInvalidRow if there's none. */
+	static size_t find(const Index &index, const Value &value) {
+		typename Index::const_iterator row = index.find(value);
+		if (row == index.end())
+			return kInvalidRow;
+
+		return row->second;
+	}
+
+private:
+	typedef std::map<size_t, Index> IndexMap;
+
+	IndexMap _indices;
+};
+
+template<typename Value, class Hash, class Pred>
+const size_t ColumnIndex<Value, Hash, Pred>::kInvalidRow;
+
+} // End of namespace Aurora
+
+#endif // AURORA_COLUMNINDEX_H
@@ -32,6 +32,7 @@
 #include "src/common/readstream.h"
 
 #include "src/aurora/gff3file.h"
+#include "src/aurora/talkman.h"
 #include "src/aurora/dlgfile.h"
 
 #include "src/aurora/nwscript/types.h"
@@ -193,6 +194,23 @@ void DLGFile::load(const GFF3Struct &dlg) {
 	_entriesStart.reserve(starters.size());
 
 	readLinks(starters, _entriesStart);
+
+	prefetchStrings();
+}
+
+void DLGFile::prefetchStrings() {
+	/* Decode the text of all lines in one go now, instead of one by one
+	 * whenever a line is shown during the conversation. */
+
+	std::vector<uint32> strRefs;
+	strRefs.reserve(_entriesNPC.size() + _entriesPC.size());
+
+	for (std::vector<Entry>::const_iterator e = _entriesNPC.begin(); e != _entriesNPC.end(); ++e)
+		strRefs.push_back(e->line.text.getID());
+	for (std::vector<Entry>::const_iterator e = _entriesPC.begin(); e != _entriesPC.end(); ++e)
+		strRefs.push_back(e->line.text.getID());
+
+	TalkMan.prefetch(strRefs);
 }
 
 void DLGFile::readEntries(const GFF3List &list, std::vector<Entry> &entries, bool isPC) {
@@ -156,6 +156,9 @@ private:
 	void readEntry(const GFF3Struct &gff, Entry &entry);
 	void readLink(const GFF3Struct &gff, Link &link);
 
+	/** Decode the text of all lines in advance, see TalkManager::prefetch(). */
+	void prefetchStrings();
+
 	bool evaluateEntries(const std::vector<Link> &entries,
 	                     std::vector<Entry>::iterator &active);
 	bool evaluateReplies(const std::vector<Link> &entries,
@@ -663,12 +663,10 @@ Common::SeekableReadStream *ERFFile::getResource(uint32 index, bool tryNoCopy) c
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy && (_header.encryption == kEncryptionNone) && (_header.compression == kCompressionNone))
-		return new Common::SeekableSubReadStream(_erf.get(), res.offset, res.offset + res.packedSize);
-
-	_erf->seek(res.offset);
+		return Common::createSubReadStream(*_erf, res.offset, res.offset + res.packedSize);
 
 	// Read
-	Common::MemoryReadStream *stream = _erf->readStream(res.packedSize);
+	Common::MemoryReadStream *stream = _erf->readStreamAt(res.offset, res.packedSize);
 
 	// Decrypt
 	if (_header.encryption != kEncryptionNone)
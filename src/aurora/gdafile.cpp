@@ -93,26 +93,36 @@ const GFF4Struct *GDAFile::getRow(size_t row) const {
 }
 
 size_t GDAFile::findRow(uint32 id) const {
+	Common::StackLock lock(_rowIndexMutex);
+
 	size_t idColumn = findColumn("ID");
 	if (idColumn == kInvalidColumn)
 		return kInvalidRow;
 
-	// Go through all rows of all GFF4s, and look for the ID
+	const RowIndex::Index *index = _rowIndex.get(idColumn);
+	if (!index) {
+		// First search for an ID. Go through all rows of all GFF4s, and index their IDs
 
-	size_t gff4 = 0;
-	for (size_t i = 0, j = 0; i < _rowCount; i++, j++) {
-		if (j >= _rows[gff4]->size()) {
-			if (++gff4 >= _rows.size())
-				break;
+		RowIndex::Index newIndex;
+
+		size_t gff4 = 0;
+		for (size_t i = 0, j = 0; i < _rowCount; i++, j++) {
+			if (j >= _rows[gff4]->size()) {
+				if (++gff4 >= _rows.size())
+					break;
 
-			j = 0;
+				j = 0;
+			}
+
+			if ((*_rows[gff4])[j])
+				RowIndex::add(newIndex, (*_rows[gff4])[j]->getUint(idColumn), i);
 		}
 
-		if ((*_rows[gff4])[j] && ((*_rows[gff4])[j]->getUint(idColumn) == id))
-			return i;
+		// Only keep the index once all IDs have been read
+		index = &_rowIndex.set(idColumn, newIndex);
 	}
 
-	return kInvalidRow;
+	return RowIndex::find(*index, id);
 }
 
 size_t GDAFile::findColumn(const Common::UString &name) const {
@@ -304,6 +314,12 @@ void GDAFile::load(Common::SeekableReadStream *gda) {
 }
 
 void GDAFile::add(Common::SeekableReadStream *gda) {
+	// The new rows need to be indexed as well
+	{
+		Common::StackLock lock(_rowIndexMutex);
+		_rowIndex.clear();
+	}
+
 	try {
 		_gff4s.push_back(new GFF4File(gda, kG2DAID));
 
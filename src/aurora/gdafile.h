@@ -32,8 +32,10 @@
 
 #include "src/common/ustring.h"
 #include "src/common/ptrvector.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/types.h"
+#include "src/aurora/columnindex.h"
 
 namespace Common {
 	class UString;
@@ -113,7 +115,11 @@ public:
 	/** Get a row as a GFF4 struct. */
 	const GFF4Struct *getRow(size_t row) const;
 
-	/** Find a row by its ID value. */
+	/** Find a row by its ID value.
+	 *
+	 *  The first search builds an index of all IDs, making every later
+	 *  search a simple hash lookup.
+	 */
 	size_t findRow(uint32 id) const;
 
 	/** Find a column by its name. */
@@ -142,6 +148,8 @@ private:
 	typedef std::map<uint32, size_t> ColumnHashMap;
 	typedef std::map<Common::UString, size_t> ColumnNameMap;
 
+	typedef ColumnIndex<uint64> RowIndex;
+
 
 	GFF4s _gff4s;
 
@@ -157,6 +165,11 @@ private:
 	mutable ColumnHashMap _columnHashMap;
 	mutable ColumnNameMap _columnNameMap;
 
+	/** Indices for finding rows by their cell value, built on demand. */
+	mutable RowIndex _rowIndex;
+	/** Protects building and searching the row indices from const methods. */
+	mutable Common::Mutex _rowIndexMutex;
+
 
 	void load(Common::SeekableReadStream *gda);
 
@@ -28,6 +28,8 @@
 
 #include <cassert>
 
+#include <algorithm>
+
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/encoding.h"
@@ -42,6 +44,8 @@
 static const uint32 kVersion32 = MKTAG('V', '3', '.', '2');
 static const uint32 kVersion33 = MKTAG('V', '3', '.', '3'); // Found in The Witcher, different language table
 
+static const uint32 kStructSize = 12;
+
 namespace Aurora {
 
 GFF3File::Header::Header() {
@@ -98,6 +102,7 @@ void GFF3File::load(uint32 id) {
 	try {
 
 		loadHeader(id);
+		loadLabels();
 		loadStructs();
 		loadLists();
 
@@ -180,12 +185,48 @@ void GFF3File::loadHeader(uint32 id) {
 		throw Common::Exception("GFF3 header broken: section offset points outside stream");
 }
 
+void GFF3File::loadLabels() {
+	/* Read all field labels once, and intern them.
+	 *
+	 * Each distinct label gets a small, unique label ID. The structs then
+	 * only store those IDs, and a field lookup by name only needs to
+	 * find the ID for the name once, instead of comparing strings.
+	 */
+
+	static const uint32 kLabelSize = 16;
+
+	if ((_header.labelCount > (_stream->size() / kLabelSize)) ||
+	    ((_header.labelOffset + _header.labelCount * kLabelSize) > (uint32) _stream->size()))
+		throw Common::Exception("GFF3 header broken: label section points outside stream");
+
+	_stream->seek(_header.labelOffset);
+
+	_labelIndexToID.resize(_header.labelCount);
+	_labels.reserve(_header.labelCount);
+
+	for (uint32 i = 0; i < _header.labelCount; i++) {
+		const Common::UString label = Common::readStringFixed(*_stream, Common::kEncodingASCII, kLabelSize);
+
+		std::pair<LabelMap::iterator, bool> result =
+			_labelMap.insert(std::make_pair(label, (uint32) _labels.size()));
+
+		if (result.second)
+			_labels.push_back(label);
+
+		_labelIndexToID[i] = result.first->second;
+	}
+}
+
 void GFF3File::loadStructs() {
-	static const uint32 kStructSize = 12;
+	/* We don't load any structs here. Instead, we only make sure that the
+	 * struct section fits into the stream, and each struct is loaded when
+	 * it's first accessed. */
+
+	if ((_header.structCount > (_stream->size() / kStructSize)) ||
+	    ((_header.structOffset + _header.structCount * kStructSize) > (uint32) _stream->size()))
+		throw Common::Exception("GFF3 header broken: struct section points outside stream");
 
-	_structs.reserve(_header.structCount);
-	for (uint32 i = 0; i < _header.structCount; i++)
-		_structs.push_back(new GFF3Struct(*this, _header.structOffset + i * kStructSize));
+	_structs.resize(_header.structCount, 0);
 }
 
 void GFF3File::loadLists() {
@@ -199,53 +240,35 @@ void GFF3File::loadLists() {
 	 * The first list contains struct indices 0 to 2, the second 3 to 7, the
 	 * third 8 and the fourth 9 and 10.
 	 *
-	 * For easy handling, we convert this list into an array of struct
-	 * pointer arrays, and a small array to convert from an index into this
-	 * list of lists into a list index.
+	 * For easy handling, we keep the raw list array around, together with
+	 * a small array to convert from an index into this list of lists into
+	 * a list index. The actual lists of struct pointers are only created
+	 * when a list is first accessed.
 	 */
 
 	_stream->seek(_header.listIndicesOffset);
 
 	// Read list array
-	std::vector<uint32> rawLists;
-	rawLists.resize(_header.listIndicesCount / 4);
-	for (std::vector<uint32>::iterator it = rawLists.begin(); it != rawLists.end(); ++it)
+	_rawLists.resize(_header.listIndicesCount / 4);
+	for (std::vector<uint32>::iterator it = _rawLists.begin(); it != _rawLists.end(); ++it)
 		*it = _stream->readUint32LE();
 
-	// Counting the actual amount of lists
+	_listOffsetToIndex.resize(_rawLists.size(), 0xFFFFFFFF);
+
+	// Counting the actual amount of lists, and mark where they start
 	uint32 listCount = 0;
-	for (size_t i = 0; i < rawLists.size(); i++) {
-		uint32 n = rawLists[i];
+	for (size_t i = 0; i < _rawLists.size(); i++) {
+		const uint32 n = _rawLists[i];
 
-		if ((i + n) > rawLists.size())
+		if ((i + n) >= _rawLists.size())
 			throw Common::Exception("GFF3: List indices broken during counting");
 
+		_listOffsetToIndex[i] = listCount++;
+
 		i += n;
-		listCount++;
 	}
 
-	_lists.resize(listCount);
-	_listOffsetToIndex.resize(rawLists.size(), 0xFFFFFFFF);
-
-	// Converting the raw list array into real, usable lists
-	uint32 listIndex = 0;
-	for (size_t i = 0; i < rawLists.size(); listIndex++) {
-		_listOffsetToIndex[i] = listIndex;
-
-		const uint32 n = rawLists[i++];
-		if ((i + n) > rawLists.size())
-			throw Common::Exception("GFF3: List indices broken during conversion");
-
-		_lists[listIndex].resize(n);
-		for (uint32 j = 0; j < n; j++, i++) {
-			const size_t structIndex = rawLists[i];
-			if (structIndex >= _structs.size())
-				throw Common::Exception("GFF3: List struct index out of range (%u >= %u)",
-				                        (uint) structIndex, (uint) _structs.size());
-
-			_lists[listIndex][j] = _structs[structIndex];
-		}
-	}
+	_lists.resize(listCount, 0);
 }
 
 // --- Helpers for GFF3Struct ---
@@ -254,6 +277,9 @@ const GFF3Struct &GFF3File::getStruct(uint32 i) const {
 	if (i >= _structs.size())
 		throw Common::Exception("GFF3: Struct index out of range (%u >= %u)", i, (uint) _structs.size());
 
+	if (!_structs[i])
+		_structs[i] = new GFF3Struct(*this, _header.structOffset + i * kStructSize);
+
 	return *_structs[i];
 }
 
@@ -269,7 +295,42 @@ const GFF3List &GFF3File::getList(uint32 i) const {
 
 	assert(listIndex < _lists.size());
 
-	return _lists[listIndex];
+	if (!_lists[listIndex]) {
+		// Converting the raw list into a real, usable list
+
+		const uint32 n = _rawLists[i];
+		assert((i + n) < _rawLists.size());
+
+		Common::ScopedPtr<GFF3List> list(new GFF3List(n));
+		for (uint32 j = 0; j < n; j++)
+			(*list)[j] = &getStruct(_rawLists[i + 1 + j]);
+
+		_lists[listIndex] = list.release();
+	}
+
+	return *_lists[listIndex];
+}
+
+uint32 GFF3File::getLabelID(uint32 index) const {
+	if (index >= _labelIndexToID.size())
+		throw Common::Exception("GFF3: Label index out of range (%u >= %u)",
+		                        index, (uint) _labelIndexToID.size());
+
+	return _labelIndexToID[index];
+}
+
+uint32 GFF3File::findLabel(const Common::UString &label) const {
+	LabelMap::const_iterator l = _labelMap.find(label);
+	if (l == _labelMap.end())
+		return kInvalidLabel;
+
+	return l->second;
+}
+
+const Common::UString &GFF3File::getLabel(uint32 id) const {
+	assert(id < _labels.size());
+
+	return _labels[id];
 }
 
 Common::SeekableReadStream &GFF3File::getStream(uint32 offset) const {
@@ -283,10 +344,10 @@ Common::SeekableReadStream &GFF3File::getFieldData() const {
 }
 
 
-GFF3Struct::Field::Field() : type(kFieldTypeNone), data(0), extended(false) {
+GFF3Struct::Field::Field() : label(GFF3File::kInvalidLabel), type(kFieldTypeNone), data(0), extended(false) {
 }
 
-GFF3Struct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
+GFF3Struct::Field::Field(uint32 l, FieldType t, uint32 d) : label(l), type(t), data(d) {
 	// These field types need extended field data
 	extended = (type == kFieldTypeUint64     ) ||
 	           (type == kFieldTypeSint64     ) ||
@@ -300,6 +361,10 @@ GFF3Struct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
 	           (type == kFieldTypeStrRef     );
 }
 
+bool GFF3Struct::Field::operator<(const Field &right) const {
+	return label < right.label;
+}
+
 
 GFF3Struct::GFF3Struct(const GFF3File &parent, uint32 offset) : _parent(&parent) {
 	load(offset);
@@ -326,6 +391,22 @@ void GFF3Struct::load(uint32 offset) {
 		readField (data, _fieldIndex);
 	else if (_fieldCount > 1)
 		readFields(data, _fieldIndex, _fieldCount);
+
+	/* Sort the fields by their label ID, for quick lookups. Should a label
+	 * appear more than once, only the last field with that label is kept. */
+
+	std::stable_sort(_fields.begin(), _fields.end());
+
+	FieldArray::iterator last = _fields.begin();
+	for (FieldArray::iterator f = _fields.begin(); f != _fields.end(); ++f) {
+		if ((f != _fields.begin()) && (last->label != f->label))
+			++last;
+
+		*last = *f;
+	}
+
+	if (!_fields.empty())
+		_fields.erase(last + 1, _fields.end());
 }
 
 void GFF3Struct::readField(Common::SeekableReadStream &data, uint32 index) {
@@ -342,13 +423,7 @@ void GFF3Struct::readField(Common::SeekableReadStream &data, uint32 index) {
 	const uint32 fieldLabel = data.readUint32LE();
 	const uint32 fieldData  = data.readUint32LE();
 
-	// Read the name
-	Common::UString fieldName = readLabel(data, fieldLabel);
-
-	// And add the field to the map and name list
-	_fields[fieldName] = Field((FieldType) fieldType, fieldData);
-
-	_fieldNames.push_back(fieldName);
+	_fields.push_back(Field(_parent->getLabelID(fieldLabel), (FieldType) fieldType, fieldData));
 }
 
 void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32 index, uint32 count) {
@@ -365,6 +440,7 @@ void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32 index, uint
 	readIndices(data, indices, count);
 
 	// Read the fields
+	_fields.reserve(count);
 	for (std::vector<uint32>::const_iterator i = indices.begin(); i != indices.end(); ++i)
 		readField(data, *i);
 }
@@ -376,12 +452,6 @@ void GFF3Struct::readIndices(Common::SeekableReadStream &data,
 		indices.push_back(data.readUint32LE());
 }
 
-Common::UString GFF3Struct::readLabel(Common::SeekableReadStream &data, uint32 index) const {
-	data.seek(_parent->_header.labelOffset + index * 16);
-
-	return Common::readStringFixed(data, Common::kEncodingASCII, 16);
-}
-
 Common::SeekableReadStream &GFF3Struct::getData(const Field &field) const {
 	assert(field.extended);
 
@@ -401,8 +471,14 @@ bool GFF3Struct::hasField(const Common::UString &field) const {
 	return getField(field) != 0;
 }
 
-const std::vector<Common::UString> &GFF3Struct::getFieldNames() const {
-	return _fieldNames;
+std::vector<Common::UString> GFF3Struct::getFieldNames() const {
+	std::vector<Common::UString> names;
+
+	names.reserve(_fields.size());
+	for (FieldArray::const_iterator f = _fields.begin(); f != _fields.end(); ++f)
+		names.push_back(_parent->getLabel(f->label));
+
+	return names;
 }
 
 GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) const {
@@ -416,11 +492,16 @@ GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) con
 // --- Field value reader helpers ---
 
 const GFF3Struct::Field *GFF3Struct::getField(const Common::UString &name) const {
-	FieldMap::const_iterator field = _fields.find(name);
-	if (field == _fields.end())
+	const uint32 label = _parent->findLabel(name);
+	if (label == GFF3File::kInvalidLabel)
+		return 0;
+
+	FieldArray::const_iterator field = std::lower_bound(_fields.begin(), _fields.end(),
+	                                                    Field(label, kFieldTypeNone, 0));
+	if ((field == _fields.end()) || (field->label != label))
 		return 0;
 
-	return &field->second;
+	return &*field;
 }
 
 char GFF3Struct::getChar(const Common::UString &field, char def) const {
@@ -26,9 +26,9 @@
 #define AURORA_GFF3FILE_H
 
 #include <vector>
-#include <map>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
@@ -79,6 +79,18 @@ class GFF3Struct;
  *  LocStrings is different. Since xoreos has more flexible handling of
  *  language IDs anyway, this doesn't concern us.
  *
+ *  The structs and lists within a GFF3 file are loaded lazily: only when
+ *  a struct or list is first reached, through getTopLevel(), or through
+ *  GFF3Struct::getStruct() and GFF3Struct::getList(), will its data be
+ *  read. Loading a GFF3 file therefore scales with the parts of it that
+ *  are actually accessed, not with the size of the file.
+ *
+ *  Consequently, a GFF3File is not thread-safe, not even when only used
+ *  through const methods: reaching a struct or list for the first time
+ *  modifies the file's struct and list tables, and reading field data
+ *  seeks within the shared stream. Users that access the same GFF3File
+ *  from several threads at once need to lock it themselves.
+ *
  *  See also: GFF4File in gff4file.h for the later V4.0/V4.1 versions of
  *  the GFF format.
  */
@@ -119,7 +131,11 @@ private:
 	};
 
 	typedef Common::PtrVector<GFF3Struct> StructArray;
-	typedef std::vector<GFF3List> ListArray;
+	typedef Common::PtrVector<GFF3List>   ListArray;
+
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> LabelMap;
+
+	static const uint32 kInvalidLabel = 0xFFFFFFFF;
 
 
 	Common::ScopedPtr<Common::SeekableReadStream> _stream;
@@ -131,16 +147,29 @@ private:
 	/** The correctional value for offsets to repair Neverwinter Nights premium modules. */
 	uint32 _offsetCorrection;
 
-	StructArray _structs; ///< Our structs.
-	ListArray   _lists;   ///< Our lists.
+	/** Our structs. Each one is only loaded when first accessed, 0 until then.
+	 *  Modified by const methods, see the thread-safety note on the class. */
+	mutable StructArray _structs;
+	/** Our lists. Each one is only loaded when first accessed, 0 until then. */
+	mutable ListArray   _lists;
 
+	/** The raw list indices section of the GFF3. */
+	std::vector<uint32> _rawLists;
 	/** To convert list offsets found in GFF3 to real indices. */
 	std::vector<uint32> _listOffsetToIndex;
 
+	/** All distinct field labels in this GFF3, indexed by their label ID. */
+	std::vector<Common::UString> _labels;
+	/** To convert label indices found in the GFF3 to label IDs. */
+	std::vector<uint32> _labelIndexToID;
+	/** To convert field labels to label IDs. */
+	LabelMap _labelMap;
+
 
 	// .--- Loading helpers
 	void load(uint32 id);
 	void loadHeader(uint32 id);
+	void loadLabels();
 	void loadStructs();
 	void loadLists();
 	// '---
@@ -151,10 +180,17 @@ private:
 	/** Return the GFF3 stream seeked to the start of the field data. */
 	Common::SeekableReadStream &getFieldData() const;
 
-	/** Return a struct within the GFF3. */
+	/** Return a struct within the GFF3, loading it if necessary. */
 	const GFF3Struct &getStruct(uint32 i) const;
-	/** Return a list within the GFF3. */
+	/** Return a list within the GFF3, loading it and its structs if necessary. */
 	const GFF3List   &getList  (uint32 i) const;
+
+	/** Return the label ID of a label index found in the GFF3. */
+	uint32 getLabelID(uint32 index) const;
+	/** Return the label ID of this field label, or kInvalidLabel if no field has this label. */
+	uint32 findLabel(const Common::UString &label) const;
+	/** Return the field label of this label ID. */
+	const Common::UString &getLabel(uint32 id) const;
 	// '---
 
 	friend class GFF3Struct;
@@ -203,8 +239,8 @@ public:
 	/** Does this specific field exist? */
 	bool hasField(const Common::UString &field) const;
 
-	/** Return a list of all field names in this struct. */
-	const std::vector<Common::UString> &getFieldNames() const;
+	/** Return a list of all field names in this struct, ordered by their position in the GFF3's label table. */
+	std::vector<Common::UString> getFieldNames() const;
 
 	/** Return the type of this field, or kFieldTypeNone if such a field doesn't exist. */
 	FieldType getFieldType(const Common::UString &field) const;
@@ -244,15 +280,19 @@ public:
 private:
 	/** A field in the GFF3 struct. */
 	struct Field {
+		uint32    label;    ///< ID of the field's label within the parent GFF3.
 		FieldType type;     ///< Type of the field.
 		uint32    data;     ///< Data of the field.
 		bool      extended; ///< Does this field need extended data?
 
 		Field();
-		Field(FieldType t, uint32 d);
+		Field(uint32 l, FieldType t, uint32 d);
+
+		bool operator<(const Field &right) const;
 	};
 
-	typedef std::map<Common::UString, Field> FieldMap;
+	/** The fields, sorted by their label ID. */
+	typedef std::vector<Field> FieldArray;
 
 
 	const GFF3File *_parent; ///< The parent GFF3.
@@ -261,10 +301,7 @@ private:
 	uint32 _fieldIndex; ///< Field / Field indices index.
 	uint32 _fieldCount; ///< Field count.
 
-	FieldMap _fields; ///< The fields, indexed by their label.
-
-	/** The names of all fields in this struct. */
-	std::vector<Common::UString> _fieldNames;
+	FieldArray _fields; ///< The fields, sorted by their label ID.
 
 
 	// .--- Loader
@@ -277,8 +314,6 @@ private:
 	void readFields (Common::SeekableReadStream &data, uint32 index, uint32 count);
 	void readIndices(Common::SeekableReadStream &data,
 	                 std::vector<uint32> &indices, uint32 count) const;
-
-	Common::UString readLabel(Common::SeekableReadStream &data, uint32 index) const;
 	// '---
 
 	// .--- Field and field data accessors
@@ -30,6 +30,8 @@
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/scopedptr.h"
 #include "src/common/encoding.h"
 
 #include "src/aurora/keyfile.h"
@@ -117,18 +119,22 @@ void KEYFile::readBIFList(Common::SeekableReadStream &key, uint32 offset) {
 }
 
 void KEYFile::readResList(Common::SeekableReadStream &key, uint32 offset) {
-	key.seek(offset);
+	// Read the whole list at once, so that the entries are parsed directly from memory
+	const size_t entrySize = (_version == kVersion11) ? 26 : 22;
+
+	Common::ScopedPtr<Common::SeekableReadStream>
+		list(key.readStreamAt(offset, _resources.size() * entrySize));
 
 	for (ResourceList::iterator res = _resources.begin(); res != _resources.end(); ++res) {
-		res->name = Common::readStringFixed(key, Common::kEncodingASCII, 16);
-		res->type = (FileType) key.readUint16LE();
+		res->name = Common::readStringFixed(*list, Common::kEncodingASCII, 16);
+		res->type = (FileType) list->readUint16LE();
 
-		uint32 id = key.readUint32LE();
+		uint32 id = list->readUint32LE();
 
 		// The new flags field holds the bifIndex now. The rest contains fixed
 		// resource info.
 		if (_version == kVersion11) {
-			uint32 flags = key.readUint32LE();
+			uint32 flags = list->readUint32LE();
 			res->bifIndex = (flags & 0xFFF00000) >> 20;
 		} else
 			res->bifIndex = id >> 20;
@@ -328,6 +328,8 @@ Common::SeekableReadStream *NSBTXFile::getResource(uint32 index, bool UNUSED(try
 	if (index >= _textures.size())
 		throw Common::Exception("Texture index out of range (%u/%u)", index, (uint)_textures.size());
 
+	Common::StackLock lock(_mutex);
+
 	Common::MemoryWriteStreamDynamic stream(true, getITEXSize(_textures[index]));
 
 	ReadContext ctx(*_nsbtx, _textures[index], stream);
@@ -31,6 +31,7 @@
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/archive.h"
@@ -121,6 +122,9 @@ private:
 	/** External list of resource names and types. */
 	ResourceList _resources;
 
+	/** Serializes the texture conversions, which all use the NSBTX's stream position. */
+	mutable Common::Mutex _mutex;
+
 	uint32 _textureOffset;
 
 	uint32 _textureInfoOffset;
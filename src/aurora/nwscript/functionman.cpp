@@ -116,6 +116,13 @@ void FunctionManager::call(uint32 function, FunctionContext &ctx) const {
 		       ctx.getName().c_str(), formatParams(ctx).c_str(), r.empty() ? "" : " => ", r.c_str());
 }
 
+Common::UString FunctionManager::getName(uint32 function) const {
+	if ((function >= _functionArray.size()) || _functionArray[function].empty)
+		return "";
+
+	return _functionArray[function].ctx.getName();
+}
+
 const FunctionManager::FunctionEntry &FunctionManager::find(const Common::UString &function) const {
 	FunctionMap::const_iterator f = _functionMap.find(function);
 	if ((f == _functionMap.end()) || f->second.empty)
@@ -57,6 +57,9 @@ public:
 	FunctionContext createContext(uint32 function) const;
 	void call(uint32 function, FunctionContext &ctx) const;
 
+	/** Return the name of the function with this ID, or an empty string if there is none. */
+	Common::UString getName(uint32 function) const;
+
 private:
 	struct FunctionEntry {
 		bool empty;
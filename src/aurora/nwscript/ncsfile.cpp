@@ -35,11 +35,8 @@
 #include "src/common/maths.h"
 #include "src/common/ustring.h"
 #include "src/common/readstream.h"
-#include "src/common/encoding.h"
 #include "src/common/debug.h"
 
-#include "src/aurora/resman.h"
-
 #include "src/aurora/nwscript/ncsfile.h"
 #include "src/aurora/nwscript/object.h"
 #include "src/aurora/nwscript/functionman.h"
@@ -59,6 +56,8 @@ namespace Aurora {
 namespace NWScript {
 
 NCSStack::NCSStack() {
+	reserve(kInitialSize);
+
 	reset();
 }
 
@@ -66,7 +65,11 @@ NCSStack::~NCSStack() {
 }
 
 void NCSStack::reset() {
-	clear();
+	/* Drop the values of the last run, but keep the variables themselves,
+	 * so that we can reuse their storage. */
+
+	for (iterator v = begin(); v != end(); ++v)
+		v->setType(kTypeVoid);
 
 	_stackPtr = -1;
 	_basePtr  = -1;
@@ -80,14 +83,23 @@ Variable &NCSStack::top() {
 	if (_stackPtr == -1)
 		throw Common::Exception("NCSStack: Stack underflow");
 
-	return at(_stackPtr);
+	return (*this)[_stackPtr];
 }
 
 Variable NCSStack::pop() {
+	Variable var;
+	pop(var);
+
+	return var;
+}
+
+void NCSStack::pop(Variable &var) {
 	if (_stackPtr == -1)
 		throw Common::Exception("NCSStack: Stack underflow");
 
-	return at(_stackPtr--);
+	// Take the value out of the stack, leaving an empty variable behind
+	var.setType(kTypeVoid);
+	var.swap((*this)[_stackPtr--]);
 }
 
 void NCSStack::push(const Variable &obj) {
@@ -97,7 +109,7 @@ void NCSStack::push(const Variable &obj) {
 	if (_stackPtr == (int32)size() - 1)
 		push_back(obj);
 	else
-		at(_stackPtr + 1) = obj;
+		(*this)[_stackPtr + 1] = obj;
 
 	_stackPtr++;
 }
@@ -188,104 +200,110 @@ void NCSStack::print() const {
 }
 
 
-#define OPCODE(x) { &NCSFile::x, #x }
-#define OPCODE0() { 0, "" }
-
-void NCSFile::setupOpcodes() {
-	static const Opcode opcodes[] = {
-		// 0x00
-		OPCODE(o_nop), // Doesn't exist
-		OPCODE(o_cpdownsp),
-		OPCODE(o_rsadd),
-		OPCODE(o_cptopsp),
-		// 0x04
-		OPCODE(o_const),
-		OPCODE(o_action),
-		OPCODE(o_logand),
-		OPCODE(o_logor),
-		// 0x08
-		OPCODE(o_incor),
-		OPCODE(o_excor),
-		OPCODE(o_booland),
-		OPCODE(o_eq),
-		// 0x0C
-		OPCODE(o_neq),
-		OPCODE(o_geq),
-		OPCODE(o_gt),
-		OPCODE(o_lt),
-		// 0x10
-		OPCODE(o_leq),
-		OPCODE(o_shleft),
-		OPCODE(o_shright),
-		OPCODE(o_ushright),
-		// 0x14
-		OPCODE(o_add),
-		OPCODE(o_sub),
-		OPCODE(o_mul),
-		OPCODE(o_div),
-		// 0x18
-		OPCODE(o_mod),
-		OPCODE(o_neg),
-		OPCODE(o_comp),
-		OPCODE(o_movsp),
-		// 0x1C
-		OPCODE(o_storestateall),
-		OPCODE(o_jmp),
-		OPCODE(o_jsr),
-		OPCODE(o_jz),
-		// 0x20
-		OPCODE(o_retn),
-		OPCODE(o_destruct),
-		OPCODE(o_not),
-		OPCODE(o_decsp),
-		// 0x24
-		OPCODE(o_incsp),
-		OPCODE(o_jnz),
-		OPCODE(o_cpdownbp),
-		OPCODE(o_cptopbp),
-		// 0x28
-		OPCODE(o_decbp),
-		OPCODE(o_incbp),
-		OPCODE(o_savebp),
-		OPCODE(o_restorebp),
-		// 0x2C
-		OPCODE(o_storestate),
-		OPCODE(o_nop),
-		OPCODE0(),
-		OPCODE0(),
-		// 0x30
-		OPCODE(o_writearray),
-		OPCODE0(),
-		OPCODE(o_readarray),
-		OPCODE0(),
-		// 0x34
-		OPCODE0(),
-		OPCODE0(),
-		OPCODE0(),
-		OPCODE(o_getref),
-		// 0x38
-		OPCODE0(),
-		OPCODE(o_getrefarray)
-	};
-
-	_opcodes = opcodes;
-	_opcodeListSize = ARRAYSIZE(opcodes);
+#define OPCODE(x) #x
+#define OPCODE0() 0
+
+/** The names of the opcodes, for debug output. */
+static const char * const kOpcodeNames[] = {
+	// 0x00
+	OPCODE0(),
+	OPCODE(o_cpdownsp),
+	OPCODE(o_rsadd),
+	OPCODE(o_cptopsp),
+	// 0x04
+	OPCODE(o_const),
+	OPCODE(o_action),
+	OPCODE(o_logand),
+	OPCODE(o_logor),
+	// 0x08
+	OPCODE(o_incor),
+	OPCODE(o_excor),
+	OPCODE(o_booland),
+	OPCODE(o_eq),
+	// 0x0C
+	OPCODE(o_neq),
+	OPCODE(o_geq),
+	OPCODE(o_gt),
+	OPCODE(o_lt),
+	// 0x10
+	OPCODE(o_leq),
+	OPCODE(o_shleft),
+	OPCODE(o_shright),
+	OPCODE(o_ushright),
+	// 0x14
+	OPCODE(o_add),
+	OPCODE(o_sub),
+	OPCODE(o_mul),
+	OPCODE(o_div),
+	// 0x18
+	OPCODE(o_mod),
+	OPCODE(o_neg),
+	OPCODE(o_comp),
+	OPCODE(o_movsp),
+	// 0x1C
+	OPCODE(o_storestateall),
+	OPCODE(o_jmp),
+	OPCODE(o_jsr),
+	OPCODE(o_jz),
+	// 0x20
+	OPCODE(o_retn),
+	OPCODE(o_destruct),
+	OPCODE(o_not),
+	OPCODE(o_decsp),
+	// 0x24
+	OPCODE(o_incsp),
+	OPCODE(o_jnz),
+	OPCODE(o_cpdownbp),
+	OPCODE(o_cptopbp),
+	// 0x28
+	OPCODE(o_decbp),
+	OPCODE(o_incbp),
+	OPCODE(o_savebp),
+	OPCODE(o_restorebp),
+	// 0x2C
+	OPCODE(o_storestate),
+	OPCODE(o_nop),
+	OPCODE0(),
+	OPCODE0(),
+	// 0x30
+	OPCODE(o_writearray),
+	OPCODE0(),
+	OPCODE(o_readarray),
+	OPCODE0(),
+	// 0x34
+	OPCODE0(),
+	OPCODE0(),
+	OPCODE0(),
+	OPCODE(o_getref),
+	// 0x38
+	OPCODE0(),
+	OPCODE(o_getrefarray)
+};
+
+#undef OPCODE0
+#undef OPCODE
+
+static const char *getOpcodeName(uint8 opcode) {
+	if ((opcode < ARRAYSIZE(kOpcodeNames)) && kOpcodeNames[opcode])
+		return kOpcodeNames[opcode];
+
+	return "???";
 }
 
-#undef OPCODE
+NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _owner(0), _triggerer(0), _profiling(false) {
+	assert(ncs);
 
-NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _script(ncs), _owner(0), _triggerer(0) {
-	assert(_script);
+	Common::ScopedPtr<Common::SeekableReadStream> stream(ncs);
 
-	load();
+	load(NCSProgramPtr(new NCSProgram(*stream)));
 }
 
-NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs), _owner(0), _triggerer(0) {
-	_script.reset(ResMan.getResource(ncs, kFileTypeNCS));
-	if (!_script)
-		throw Common::Exception("No such NCS \"%s\"", ncs.c_str());
+NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs), _owner(0), _triggerer(0), _profiling(false) {
+	load(NCSCache.get(ncs));
+}
 
-	load();
+NCSFile::NCSFile(const NCSProgramPtr &program) : _name(program->getName()), _owner(0), _triggerer(0), _profiling(false) {
+	load(program);
 }
 
 NCSFile::~NCSFile() {
@@ -311,26 +329,17 @@ ScriptState NCSFile::getEmptyState() {
 	return state;
 }
 
-void NCSFile::load() {
-	readHeader(*_script);
-
-	if (_id != kNCSTag)
-		throw Common::Exception("Try to load non-NCS file");
+void NCSFile::load(const NCSProgramPtr &program) {
+	assert(program);
 
-	if (_version != kVersion10)
-		throw Common::Exception("Unsupported NCS file version %08X", _version);
+	// The program's header has already been validated
+	_id      = kNCSTag;
+	_version = kVersion10;
 
-	byte lengthOpcode = _script->readByte();
-	if (lengthOpcode != 0x42)
-		throw Common::Exception("Script size opcode != 0x42 (0x%02X)", lengthOpcode);
+	_program = program;
 
-	uint32 length = _script->readUint32BE();
-	if (length > ((uint32) _script->size()))
-		throw Common::Exception("Script size %u > stream size %u", length, (uint)_script->size());
-	if (length < ((uint32) _script->size()))
-		warning("TODO: NCSFile::load(): Script size %u < stream size %u", length, (uint)_script->size());
-
-	setupOpcodes();
+	_instructions     = _program->getInstructions();
+	_instructionCount = _program->getInstructionCount();
 
 	reset();
 }
@@ -338,13 +347,16 @@ void NCSFile::load() {
 void NCSFile::reset() {
 	_stack.reset();
 
-	while (!_returnOffsets.empty())
-		_returnOffsets.pop();
+	while (!_returnStack.empty())
+		_returnStack.pop();
 
 	_storedState.setType(kTypeVoid);
 	_return.setType(kTypeVoid);
 
-	_script->seek(13); // 8 byte header + 5 byte program size dummy op
+	_profileStack.clear();
+	_profile.clear();
+
+	_pc = 0; // The first instruction, after the header and the program size dummy op
 }
 
 const Variable &NCSFile::run(Object *owner, Object *triggerer) {
@@ -357,7 +369,9 @@ const Variable &NCSFile::run(const ScriptState &state, Object *owner, Object *tr
 
 	reset();
 
-	_script->seek(state.offset);
+	_pc = _program->findInstruction(state.offset);
+	if (_pc == NCSProgram::kInvalidIndex)
+		throw Common::Exception("NCSFile::run(): No instruction at offset %u", state.offset);
 
 	// Push global variables
 	std::vector<class Variable>::const_reverse_iterator var;
@@ -377,8 +391,110 @@ const Variable &NCSFile::execute(Object *owner, Object *triggerer) {
 	_owner     = owner;
 	_triggerer = triggerer;
 
-	while (executeStep())
-		;
+	const bool debug = DebugMan.isEnabled(kDebugScripts, 1);
+
+	_profiling = ScriptProfiler.isEnabled();
+
+	const uint64 startTime = _profiling ? Profiler::getTicks() : 0;
+	uint64 instructions = 0;
+
+	if (_profiling)
+		enterSubroutine(_instructions[_pc].address, instructions);
+
+	bool running = true;
+	while (running) {
+		assert(_pc < _instructionCount);
+
+		const Instruction &instr = _instructions[_pc++];
+		instructions++;
+
+		if (debug)
+			debugC(kDebugScripts, 1, "NWScript opcode %s [0x%02X]", getOpcodeName(instr.opcode), instr.opcode);
+
+		switch (instr.opcode) {
+			case kOpcodeCPDOWNSP:      o_cpdownsp(instr);      break;
+			case kOpcodeRSADD:         o_rsadd(instr);         break;
+			case kOpcodeCPTOPSP:       o_cptopsp(instr);       break;
+			case kOpcodeCONST:         o_const(instr);         break;
+			case kOpcodeACTION:        o_action(instr);        break;
+			case kOpcodeLOGAND:        o_logand(instr);        break;
+			case kOpcodeLOGOR:         o_logor(instr);         break;
+			case kOpcodeINCOR:         o_incor(instr);         break;
+			case kOpcodeEXCOR:         o_excor(instr);         break;
+			case kOpcodeBOOLAND:       o_booland(instr);       break;
+			case kOpcodeEQ:            o_eq(instr);            break;
+			case kOpcodeNEQ:           o_neq(instr);           break;
+			case kOpcodeGEQ:           o_geq(instr);           break;
+			case kOpcodeGT:            o_gt(instr);            break;
+			case kOpcodeLT:            o_lt(instr);            break;
+			case kOpcodeLEQ:           o_leq(instr);           break;
+			case kOpcodeSHLEFT:        o_shleft(instr);        break;
+			case kOpcodeSHRIGHT:       o_shright(instr);       break;
+			case kOpcodeUSHRIGHT:      o_ushright(instr);      break;
+			case kOpcodeADD:           o_add(instr);           break;
+			case kOpcodeSUB:           o_sub(instr);           break;
+			case kOpcodeMUL:           o_mul(instr);           break;
+			case kOpcodeDIV:           o_div(instr);           break;
+			case kOpcodeMOD:           o_mod(instr);           break;
+			case kOpcodeNEG:           o_neg(instr);           break;
+			case kOpcodeCOMP:          o_comp(instr);          break;
+			case kOpcodeMOVSP:         o_movsp(instr);         break;
+			case kOpcodeSTORESTATEALL: o_storestateall(instr); break;
+			case kOpcodeJMP:           o_jmp(instr);           break;
+
+			case kOpcodeJSR:
+				o_jsr(instr);
+				if (_profiling)
+					enterSubroutine(_instructions[_pc].address, instructions);
+				break;
+
+			case kOpcodeJZ:            o_jz(instr);            break;
+
+			case kOpcodeRETN:
+				o_retn(instr);
+				if (_profiling)
+					leaveSubroutine(instructions);
+				break;
+
+			case kOpcodeDESTRUCT:      o_destruct(instr);      break;
+			case kOpcodeNOT:           o_not(instr);           break;
+			case kOpcodeDECSP:         o_decsp(instr);         break;
+			case kOpcodeINCSP:         o_incsp(instr);         break;
+			case kOpcodeJNZ:           o_jnz(instr);           break;
+			case kOpcodeCPDOWNBP:      o_cpdownbp(instr);      break;
+			case kOpcodeCPTOPBP:       o_cptopbp(instr);       break;
+			case kOpcodeDECBP:         o_decbp(instr);         break;
+			case kOpcodeINCBP:         o_incbp(instr);         break;
+			case kOpcodeSAVEBP:        o_savebp(instr);        break;
+			case kOpcodeRESTOREBP:     o_restorebp(instr);     break;
+			case kOpcodeSTORESTATE:    o_storestate(instr);    break;
+			case kOpcodeNOP:           o_nop(instr);           break;
+			case kOpcodeWRITEARRAY:    o_writearray(instr);    break;
+			case kOpcodeREADARRAY:     o_readarray(instr);     break;
+			case kOpcodeGETREF:        o_getref(instr);        break;
+			case kOpcodeGETREFARRAY:   o_getrefarray(instr);   break;
+
+			case kOpcodeEnd:
+				instructions--; // Not an actual instruction of the script
+				running = false;
+				break;
+
+			case kOpcodeTruncated:
+				throw Common::Exception(Common::kReadError);
+
+			default:
+				throw Common::Exception("NCSFile::execute(): Illegal instruction 0x%02x", instr.args[0]);
+		}
+
+		if (debug) {
+			_stack.print();
+			debugC(kDebugScripts, 2, "[RETURN: %d]",
+			       _returnStack.empty() ? -1 : (int) _instructions[_returnStack.top()].address);
+		}
+	}
+
+	if (_profiling)
+		finishProfile(instructions, Profiler::getTicks() - startTime);
 
 	if (!_stack.empty())
 		_return = _stack.top();
@@ -393,44 +509,66 @@ const Variable &NCSFile::execute(Object *owner, Object *triggerer) {
 	return _return;
 }
 
-bool NCSFile::executeStep() {
-	byte opcode, type;
+void NCSFile::jump(const Instruction &instr) {
+	if (instr.index == NCSProgram::kInvalidIndex)
+		throw Common::Exception("NCSFile::jump(): Invalid jump from %u by %d", instr.address, instr.args[0]);
 
-	try {
-		opcode = _script->readByte();
-		type   = _script->readByte();
-	} catch (...) {
-		return false;
-	}
+	_pc = instr.index;
+}
+
+void NCSFile::enterSubroutine(uint32 address, uint64 instructions) {
+	ProfileFrame frame;
+
+	frame.address            = address;
+	frame.startTime          = Profiler::getTicks();
+	frame.startInstructions  = instructions;
+	frame.calleeTime         = 0;
+	frame.calleeInstructions = 0;
+
+	_profileStack.push_back(frame);
+}
+
+void NCSFile::leaveSubroutine(uint64 instructions) {
+	if (_profileStack.empty())
+		return;
 
-	if ((opcode >= _opcodeListSize) || (!_opcodes[opcode].proc))
-		throw Common::Exception("NCSFile::executeStep(): Illegal instruction 0x%02x", opcode);
+	const ProfileFrame &frame = _profileStack.back();
 
-	debugC(kDebugScripts, 1, "NWScript opcode %s [0x%02X]", _opcodes[opcode].desc, opcode);
+	const uint64 time  = Profiler::getTicks() - frame.startTime;
+	const uint64 count = instructions - frame.startInstructions;
 
-	(this->*(_opcodes[opcode].proc))((InstructionType)type);
+	// Only count what the subroutine did itself, not what its callees did
+	_profile[frame.address].add(1, count - frame.calleeInstructions, time - frame.calleeTime);
 
-	_stack.print();
-	debugC(kDebugScripts, 2, "[RETURN: %d]",
-	       _returnOffsets.empty() ? -1 : _returnOffsets.top());
+	_profileStack.pop_back();
 
-	return true;
+	if (!_profileStack.empty()) {
+		_profileStack.back().calleeTime         += time;
+		_profileStack.back().calleeInstructions += count;
+	}
 }
 
-void NCSFile::decompile() {
-	uint32 oldScriptPos = _script->pos();
-	_script->seek(13); // 8 byte header + 5 byte program size dummy op
+void NCSFile::finishProfile(uint64 instructions, uint64 time) {
+	while (!_profileStack.empty())
+		leaveSubroutine(instructions);
 
-	// TODO
+	const Common::UString name = _name.empty() ? Common::UString("<unnamed>") : _name;
 
-	_script->seek(oldScriptPos);
+	ScriptProfiler.addScript(name, instructions, time);
+	ScriptProfiler.addSubroutines(name, _profile);
+
+	_profile.clear();
+}
+
+void NCSFile::decompile() {
+	// TODO
 }
 
 // OPCODES!
 
 /** RSADD: push an empty variable onto the stack. */
-void NCSFile::o_rsadd(InstructionType type) {
-	switch (type) {
+void NCSFile::o_rsadd(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeInt:
 			_stack.push(kTypeInt);
 			break;
@@ -466,26 +604,20 @@ void NCSFile::o_rsadd(InstructionType type) {
 			_stack.push(kTypeArray);
 			break;
 		default:
-			throw Common::Exception("NCSFile::o_rsadd(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_rsadd(): Illegal type %d", instr.type);
 	}
 }
 
 /** CONST: push a constant (predetermined value) variable onto the stack. */
-void NCSFile::o_const(InstructionType type) {
-	switch (type) {
+void NCSFile::o_const(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeInt:
-			_stack.push(_script->readSint32BE());
-			break;
-
 		case kInstTypeFloat:
-			_stack.push(_script->readIEEEFloatBE());
-			break;
-
 		case kInstTypeString:
-		case kInstTypeResource: {
-			_stack.push(Common::readStringFixed(*_script, Common::kEncodingASCII, _script->readUint16BE()));
+		case kInstTypeResource:
+			// Parsed when the program was loaded
+			_stack.push(_program->getConstant(instr.index));
 			break;
-		}
 
 		case kInstTypeObject: {
 			/* The scripts only know of two constant objects:
@@ -496,7 +628,7 @@ void NCSFile::o_const(InstructionType type) {
 			 * magic values. They *should* all have the same effect, though.
 			 */
 
-			uint32 objectID = _script->readUint32BE();
+			uint32 objectID = (uint32) instr.args[0];
 
 			if      (objectID == kScriptObjectSelf)
 				_stack.push(_owner);
@@ -513,7 +645,7 @@ void NCSFile::o_const(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_const(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_const(): Illegal type %d", instr.type);
 	}
 }
 
@@ -546,7 +678,8 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 			case kTypeEngineType:
 			case kTypeReference:
 			case kTypeArray:
-				param = _stack.pop();
+				// The popped stack element is dead now, so we can just take its value
+				_stack.pop(param);
 				break;
 
 			case kTypeVector: {
@@ -577,7 +710,15 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 
 	// Call the engine function
 	debugC(kDebugScripts, 1, "NWScript engine function %s (%d)", ctx.getName().c_str(), function);
-	FunctionMan.call(function, ctx);
+
+	if (_profiling) {
+		const uint64 startTime = Profiler::getTicks();
+
+		FunctionMan.call(function, ctx);
+
+		ScriptProfiler.addFunction(function, Profiler::getTicks() - startTime);
+	} else
+		FunctionMan.call(function, ctx);
 
 	// Push return values
 	Variable &retVal = ctx.getReturn();
@@ -614,12 +755,12 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 }
 
 /** ACTION: call a game-specific engine function. */
-void NCSFile::o_action(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_action(): Illegal type %d", type);
+void NCSFile::o_action(const Instruction &instr) {
+	if (instr.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_action(): Illegal type %d", instr.type);
 
-	uint16 routineNumber = _script->readUint16BE();
-	uint8  argCount      = _script->readByte();
+	uint16 routineNumber = instr.args[0];
+	uint8  argCount      = instr.args[1];
 
 	Aurora::NWScript::FunctionContext ctx = FunctionMan.createContext(routineNumber);
 
@@ -633,9 +774,9 @@ void NCSFile::o_action(InstructionType type) {
 }
 
 /** LOGAND: perform a logical boolean AND (&&). */
-void NCSFile::o_logand(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_logand(): Illegal type %d", type);
+void NCSFile::o_logand(const Instruction &instr) {
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_logand(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -643,9 +784,9 @@ void NCSFile::o_logand(InstructionType type) {
 }
 
 /** LOGOR: perform a logical boolean OR (||). */
-void NCSFile::o_logor(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_logor(): Illegal type %d", type);
+void NCSFile::o_logor(const Instruction &instr) {
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_logor(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -653,9 +794,9 @@ void NCSFile::o_logor(InstructionType type) {
 }
 
 /** INCOR: perform a bit-wise inclusive OR (|). */
-void NCSFile::o_incor(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_incor(): Illegal type %d", type);
+void NCSFile::o_incor(const Instruction &instr) {
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_incor(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -663,9 +804,9 @@ void NCSFile::o_incor(InstructionType type) {
 }
 
 /** EXCOR: perform a bit-wise exclusive OR (^). */
-void NCSFile::o_excor(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_excor(): Illegal type %d", type);
+void NCSFile::o_excor(const Instruction &instr) {
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_excor(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -673,9 +814,9 @@ void NCSFile::o_excor(InstructionType type) {
 }
 
 /** BOOLAND: perform a bit-wise AND (&). */
-void NCSFile::o_booland(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_booland(): Illegal type %d", type);
+void NCSFile::o_booland(const Instruction &instr) {
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_booland(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -683,13 +824,13 @@ void NCSFile::o_booland(InstructionType type) {
 }
 
 /** EQ: compare the top-most stack elements for equality (==). */
-void NCSFile::o_eq(InstructionType type) {
+void NCSFile::o_eq(const Instruction &instr) {
 	size_t n = 1;
 
-	if (type == kInstTypeStructStruct) {
+	if (instr.type == kInstTypeStructStruct) {
 		// Comparisons between two structs (or two vectors) come with the size of the type
 
-		const size_t size = _script->readUint16BE();
+		const size_t size = instr.args[0];
 
 		if ((size % 4) != 0)
 			throw Common::Exception("NCSFile::o_eq(): size %% 4 != 0");
@@ -712,13 +853,13 @@ void NCSFile::o_eq(InstructionType type) {
 }
 
 /** NEQ: compare the top-most stack elements for inequality (!=). */
-void NCSFile::o_neq(InstructionType type) {
+void NCSFile::o_neq(const Instruction &instr) {
 	size_t n = 1;
 
-	if (type == kInstTypeStructStruct) {
+	if (instr.type == kInstTypeStructStruct) {
 		// Comparisons between two structs (or two vectors) come with the size of the type
 
-		const size_t size = _script->readUint16BE();
+		const size_t size = instr.args[0];
 
 		if ((size % 4) != 0)
 			throw Common::Exception("NCSFile::o_neq(): size %% 4 != 0");
@@ -741,8 +882,8 @@ void NCSFile::o_neq(InstructionType type) {
 }
 
 /** GEQ: compare the top-most stack elements, greater-or-equal (>=). */
-void NCSFile::o_geq(InstructionType type) {
-	switch (type) {
+void NCSFile::o_geq(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeIntInt:
 			{
 				int32 arg1 = _stack.pop().getInt();
@@ -760,13 +901,13 @@ void NCSFile::o_geq(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_geq(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_geq(): Illegal type %d", instr.type);
 	}
 }
 
 /** GT: compare the top-most stack elements, greater (>). */
-void NCSFile::o_gt(InstructionType type) {
-	switch (type) {
+void NCSFile::o_gt(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeIntInt:
 			{
 				int32 arg1 = _stack.pop().getInt();
@@ -784,13 +925,13 @@ void NCSFile::o_gt(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_gt(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_gt(): Illegal type %d", instr.type);
 	}
 }
 
 /** LT: compare the top-most stack elements, less (<). */
-void NCSFile::o_lt(InstructionType type) {
-	switch (type) {
+void NCSFile::o_lt(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeIntInt:
 			{
 				int32 arg1 = _stack.pop().getInt();
@@ -808,13 +949,13 @@ void NCSFile::o_lt(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_lt(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_lt(): Illegal type %d", instr.type);
 	}
 }
 
 /** LEQ: compare the top-most stack elements, less-or-equal (<=). */
-void NCSFile::o_leq(InstructionType type) {
-	switch (type) {
+void NCSFile::o_leq(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeIntInt:
 			{
 				int32 arg1 = _stack.pop().getInt();
@@ -832,14 +973,14 @@ void NCSFile::o_leq(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_leq(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_leq(): Illegal type %d", instr.type);
 	}
 }
 
 /** SHLEFT: shift the top-most stack element to the left (<<). */
-void NCSFile::o_shleft(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_shleft(): Illegal type %d", type);
+void NCSFile::o_shleft(const Instruction &instr) {
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_shleft(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -847,15 +988,15 @@ void NCSFile::o_shleft(InstructionType type) {
 }
 
 /** SHRIGHT: signed-shift the top-most stack element to the right (>>>). */
-void NCSFile::o_shright(InstructionType type) {
+void NCSFile::o_shright(const Instruction &instr) {
 	/* According to Skywing's NWNScriptLib
 	 * (<https://github.com/SkywingvL/nwn2dev-public/blob/master/NWNScriptLib/NWScriptVM.cpp#L2233>):
 	 * "The operation implemented here is actually a complex sequence that, if
 	 *  the amount to be shifted is negative, involves both a front-loaded and
 	 *  end-loaded negate built on top of a signed shift." */
 
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_shright(): Illegal type %d", type);
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_shright(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -868,14 +1009,14 @@ void NCSFile::o_shright(InstructionType type) {
 }
 
 /** USHRIGHT: shift the top-most stack element to the right (>>). */
-void NCSFile::o_ushright(InstructionType type) {
+void NCSFile::o_ushright(const Instruction &instr) {
 	/* According to Skywing's NWNScriptLib
 	 * (<https://github.com/SkywingvL/nwn2dev-public/blob/master/NWNScriptLib/NWScriptVM.cpp#L2272>):
 	 * "While this operator may have originally been intended to implement
 	 *  an unsigned shift, it actually performs an arithmetic (signed) shift." */
 
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_ushright(): Illegal type %d", type);
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_ushright(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -883,9 +1024,9 @@ void NCSFile::o_ushright(InstructionType type) {
 }
 
 /** MOD: calculate the remainder (modulo) of an integer division (%). */
-void NCSFile::o_mod(InstructionType type) {
-	if (type != kInstTypeIntInt)
-		throw Common::Exception("NCSFile::o_mod(): Illegal type %d", type);
+void NCSFile::o_mod(const Instruction &instr) {
+	if (instr.type != kInstTypeIntInt)
+		throw Common::Exception("NCSFile::o_mod(): Illegal type %d", instr.type);
 
 	int32 arg1 = _stack.pop().getInt();
 	int32 arg2 = _stack.pop().getInt();
@@ -899,8 +1040,8 @@ void NCSFile::o_mod(InstructionType type) {
 }
 
 /** NEQ: negate the top-most stack element (unary -). */
-void NCSFile::o_neg(InstructionType type) {
-	switch (type) {
+void NCSFile::o_neg(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeInt:
 			_stack.push(-_stack.pop().getInt());
 			break;
@@ -910,101 +1051,96 @@ void NCSFile::o_neg(InstructionType type) {
 			break;
 
 		default:
-			throw Common::Exception("NCSFile::o_neg(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_neg(): Illegal type %d", instr.type);
 	}
 }
 
 /** COMP: calculate the 1-complement of the top-most stack element (~). */
-void NCSFile::o_comp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_comp(): Illegal type %d", type);
+void NCSFile::o_comp(const Instruction &instr) {
+	if (instr.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_comp(): Illegal type %d", instr.type);
 
 	_stack.push(~_stack.pop().getInt());
 }
 
 /** MOVSP: pop elements off the stack. */
-void NCSFile::o_movsp(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_movsp(): Illegal type %d", type);
+void NCSFile::o_movsp(const Instruction &instr) {
+	if (instr.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_movsp(): Illegal type %d", instr.type);
 
-	_stack.setStackPtr(_stack.getStackPtr() - _script->readSint32BE());
+	_stack.setStackPtr(_stack.getStackPtr() - instr.args[0]);
 }
 
 /** JMP: jump directly to a different script offset. */
-void NCSFile::o_jmp(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_jmp(): Illegal type %d", type);
+void NCSFile::o_jmp(const Instruction &instr) {
+	if (instr.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_jmp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
-	_script->skip(offset - 6);
+	jump(instr);
 }
 
 /** JZ: jump conditionally if the top-most stack element is 0. */
-void NCSFile::o_jz(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_jz(): Illegal type %d", type);
-
-	int32 offset = _script->readSint32BE();
+void NCSFile::o_jz(const Instruction &instr) {
+	if (instr.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_jz(): Illegal type %d", instr.type);
 
 	if (!_stack.pop().getInt())
-		_script->skip(offset - 6);
+		jump(instr);
 }
 
 /** NOT: boolean-negate the top-most stack element (!). */
-void NCSFile::o_not(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_not(): Illegal type %d", type);
+void NCSFile::o_not(const Instruction &instr) {
+	if (instr.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_not(): Illegal type %d", instr.type);
 
 	_stack.push(!_stack.pop().getInt());
 }
 
 /** DECSP: decrement the value of a stack element (--). */
-void NCSFile::o_decsp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_decsp(): Illegal type %d", type);
+void NCSFile::o_decsp(const Instruction &instr) {
+	if (instr.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_decsp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = instr.args[0];
 
 	_stack.setRelSP(offset, _stack.getRelSP(offset).getInt() - 1);
 }
 
 /** INCSP: increment the value of a stack element (++). */
-void NCSFile::o_incsp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_incsp(): Illegal type %d", type);
+void NCSFile::o_incsp(const Instruction &instr) {
+	if (instr.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_incsp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = instr.args[0];
 
 	_stack.setRelSP(offset, _stack.getRelSP(offset).getInt() + 1);
 }
 
 /** JNZ: jump conditionally if the top-most stack element is not 0. */
-void NCSFile::o_jnz(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_jnz(): Illegal type %d", type);
-
-	int32 offset = _script->readSint32BE();
+void NCSFile::o_jnz(const Instruction &instr) {
+	if (instr.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_jnz(): Illegal type %d", instr.type);
 
 	if (_stack.pop().getInt())
-		_script->skip(offset - 6);
+		jump(instr);
 }
 
 /** DECBP: decrement the value of a base-pointer stack element (--). */
-void NCSFile::o_decbp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_decbp(): Illegal type %d", type);
+void NCSFile::o_decbp(const Instruction &instr) {
+	if (instr.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_decbp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = instr.args[0];
 
 	_stack.setRelBP(offset, _stack.getRelBP(offset).getInt() - 1);
 }
 
 /** INCBP: increment the value of a base-pointer stack element (++). */
-void NCSFile::o_incbp(InstructionType type) {
-	if (type != kInstTypeInt)
-		throw Common::Exception("NCSFile::o_incbp(): Illegal type %d", type);
+void NCSFile::o_incbp(const Instruction &instr) {
+	if (instr.type != kInstTypeInt)
+		throw Common::Exception("NCSFile::o_incbp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = instr.args[0];
 
 	_stack.setRelBP(offset, _stack.getRelBP(offset).getInt() + 1);
 }
@@ -1013,9 +1149,9 @@ void NCSFile::o_incbp(InstructionType type) {
  *
  *  Used to create an anchor point to access global variables.
  */
-void NCSFile::o_savebp(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_savebp(): Illegal type %d", type);
+void NCSFile::o_savebp(const Instruction &instr) {
+	if (instr.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_savebp(): Illegal type %d", instr.type);
 
 	_stack.push(_stack.getBasePtr());
 	_stack.setBasePtr(_stack.getStackPtr());
@@ -1025,25 +1161,25 @@ void NCSFile::o_savebp(InstructionType type) {
  *
  *  Destroy the global variables anchor point after use.
  */
-void NCSFile::o_restorebp(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_restorebp(): Illegal type %d", type);
+void NCSFile::o_restorebp(const Instruction &instr) {
+	if (instr.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_restorebp(): Illegal type %d", instr.type);
 
 	_stack.setBasePtr(_stack.pop().getInt());
 }
 
 /** NOP: no operation. */
-void NCSFile::o_nop(InstructionType UNUSED(type)) {
+void NCSFile::o_nop(const Instruction &UNUSED(instr)) {
 	// Nothing! Yay!
 }
 
 /** CPDOWNSP: copy a value into an existing stack element. */
-void NCSFile::o_cpdownsp(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal type %d", type);
+void NCSFile::o_cpdownsp(const Instruction &instr) {
+	if (instr.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0];
+	int32 size   = instr.args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal size %d", size);
@@ -1059,12 +1195,12 @@ void NCSFile::o_cpdownsp(InstructionType type) {
 }
 
 /** CPTOPSP: push a copy of a stack element on top of the stack. */
-void NCSFile::o_cptopsp(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_cptopsp(): Illegal type %d", type);
+void NCSFile::o_cptopsp(const Instruction &instr) {
+	if (instr.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_cptopsp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0];
+	int32 size   = instr.args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cptopsp(): Illegal size %d", size);
@@ -1077,8 +1213,8 @@ void NCSFile::o_cptopsp(InstructionType type) {
 }
 
 /** ADD: add the top-most stack elements (+). */
-void NCSFile::o_add(InstructionType type) {
-	switch (type) {
+void NCSFile::o_add(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeIntInt: {
 			Variable op2 = _stack.pop();
 			Variable op1 = _stack.pop();
@@ -1134,13 +1270,13 @@ void NCSFile::o_add(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_add(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_add(): Illegal type %d", instr.type);
 	}
 }
 
 /** SUB: subtract the top-most stack elements (-). */
-void NCSFile::o_sub(InstructionType type) {
-	switch (type) {
+void NCSFile::o_sub(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeIntInt: {
 			Variable op2 = _stack.pop();
 			Variable op1 = _stack.pop();
@@ -1188,13 +1324,13 @@ void NCSFile::o_sub(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_sub(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_sub(): Illegal type %d", instr.type);
 	}
 }
 
 /** MUL: multiply the top-most stack elements (*). */
-void NCSFile::o_mul(InstructionType type) {
-	switch (type) {
+void NCSFile::o_mul(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeIntInt: {
 			Variable op2 = _stack.pop();
 			Variable op1 = _stack.pop();
@@ -1252,13 +1388,13 @@ void NCSFile::o_mul(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_mul(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_mul(): Illegal type %d", instr.type);
 	}
 }
 
 /** DIV: divide the top-most stack elements (/). */
-void NCSFile::o_div(InstructionType type) {
-	switch (type) {
+void NCSFile::o_div(const Instruction &instr) {
+	switch (instr.type) {
 		case kInstTypeIntInt: {
 			Variable op2 = _stack.pop();
 			Variable op1 = _stack.pop();
@@ -1337,13 +1473,13 @@ void NCSFile::o_div(InstructionType type) {
 		}
 
 		default:
-			throw Common::Exception("NCSFile::o_div(): Illegal type %d", type);
+			throw Common::Exception("NCSFile::o_div(): Illegal type %d", instr.type);
 	}
 }
 
 /** STORESTATEALL: unused, obsolete opcode. Hopefully. */
-void NCSFile::o_storestateall(InstructionType type) {
-	uint8  offset = (uint8) type;
+void NCSFile::o_storestateall(const Instruction &instr) {
+	uint8  offset = (uint8) instr.type;
 
 	// TODO: NCSFile::o_storestateall(): See o_storestate.
 	//       Supposedly obsolete. Whether it's used anywhere remains to be seen.
@@ -1351,37 +1487,36 @@ void NCSFile::o_storestateall(InstructionType type) {
 }
 
 /** JSR: call a subroutine. */
-void NCSFile::o_jsr(InstructionType type) {
-	if (type != kInstTypeNone)
-		throw Common::Exception("NCSFile::o_jsr(): Illegal type %d", type);
-
-	int32 offset = _script->readSint32BE();
+void NCSFile::o_jsr(const Instruction &instr) {
+	if (instr.type != kInstTypeNone)
+		throw Common::Exception("NCSFile::o_jsr(): Illegal type %d", instr.type);
 
-	// Push the current script position
-	_returnOffsets.push(_script->pos());
+	// Push the index of the instruction following the call
+	_returnStack.push(_pc);
 
-	_script->skip(offset - 6);
+	jump(instr);
 }
 
 /** RETN: return from a subroutine call. */
-void NCSFile::o_retn(InstructionType UNUSED(type)) {
-	uint32 returnAddress = _script->size();
-	if (!_returnOffsets.empty()) {
-		returnAddress = _returnOffsets.top();
-		_returnOffsets.pop();
+void NCSFile::o_retn(const Instruction &UNUSED(instr)) {
+	if (_returnStack.empty()) {
+		// Returning from the top-most level ends the script
+		_pc = _instructionCount - 1;
+		return;
 	}
 
-	_script->seek(returnAddress);
+	_pc = _returnStack.top();
+	_returnStack.pop();
 }
 
 /** DESTRUCT: remove elements from the stack.
  *
  *  Used to isolate struct elements.
  */
-void NCSFile::o_destruct(InstructionType UNUSED(type)) {
-	int16 stackSize        = _script->readSint16BE();
-	int16 dontRemoveOffset = _script->readSint16BE();
-	int16 dontRemoveSize   = _script->readSint16BE();
+void NCSFile::o_destruct(const Instruction &instr) {
+	int32 stackSize        = instr.args[0];
+	int32 dontRemoveOffset = instr.args[1];
+	int32 dontRemoveSize   = instr.args[2];
 
 	if ((stackSize % 4) != 0)
 		throw Common::Exception("NCSFile::o_destruct(): Illegal stack size %d", stackSize);
@@ -1412,12 +1547,12 @@ void NCSFile::o_destruct(InstructionType UNUSED(type)) {
  *
  *  Used to write into a global variable.
  */
-void NCSFile::o_cpdownbp(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal type %d", type);
+void NCSFile::o_cpdownbp(const Instruction &instr) {
+	if (instr.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE() - 4;
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0] - 4;
+	int32 size   = instr.args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal size %d", size);
@@ -1436,12 +1571,12 @@ void NCSFile::o_cpdownbp(InstructionType type) {
  *
  *  Used to read from a global variable.
  */
-void NCSFile::o_cptopbp(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_cptopbp(): Illegal type %d", type);
+void NCSFile::o_cptopbp(const Instruction &instr) {
+	if (instr.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_cptopbp(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE() - 4;
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0] - 4;
+	int32 size   = instr.args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cptopbp(): Illegal size %d", size);
@@ -1459,10 +1594,10 @@ void NCSFile::o_cptopbp(InstructionType type) {
  *  Used to create the "action" variables when calling an engine function that
  *  assigns a function to an object, or delays a function, or similar.
  */
-void NCSFile::o_storestate(InstructionType type) {
-	uint8  offset = (uint8) type;
-	uint32 sizeBP = _script->readUint32BE();
-	uint32 sizeSP = _script->readUint32BE();
+void NCSFile::o_storestate(const Instruction &instr) {
+	uint8  offset = (uint8) instr.type;
+	uint32 sizeBP = (uint32) instr.args[0];
+	uint32 sizeSP = (uint32) instr.args[1];
 
 	if ((sizeBP % 4) != 0)
 		throw Common::Exception("NCSFile::o_storestate(): Illegal BP size %d", sizeBP);
@@ -1472,7 +1607,7 @@ void NCSFile::o_storestate(InstructionType type) {
 	_storedState.setType(kTypeScriptState);
 	ScriptState &state = _storedState.getScriptState();
 
-	state.offset = _script->pos() - 10 + offset;
+	state.offset = instr.address + offset;
 
 	sizeBP /= 4;
 	sizeSP /= 4;
@@ -1495,12 +1630,12 @@ void NCSFile::o_storestate(InstructionType type) {
  *
  *  The index is popped off the stack, but the value written remains.
  */
-void NCSFile::o_writearray(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_writearray(): Illegal type %d", type);
+void NCSFile::o_writearray(const Instruction &instr) {
+	if (instr.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_writearray(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0];
+	int32 size   = instr.args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_writearray(): Invalid size %d", size);
@@ -1530,12 +1665,12 @@ void NCSFile::o_writearray(InstructionType type) {
  *  The index is popped off the stack, and the value read out of the
  *  array is pushed on top.
  */
-void NCSFile::o_readarray(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_readarray(): Illegal type %d", type);
+void NCSFile::o_readarray(const Instruction &instr) {
+	if (instr.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_readarray(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0];
+	int32 size   = instr.args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_readarray(): Invalid size %d", size);
@@ -1562,12 +1697,12 @@ void NCSFile::o_readarray(InstructionType type) {
  *  The offset to the variable to create a reference to is passed
  *  as a direct argument to the instruction.
  */
-void NCSFile::o_getref(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_getref(): Illegal type %d", type);
+void NCSFile::o_getref(const Instruction &instr) {
+	if (instr.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_getref(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0];
+	int32 size   = instr.args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_getref(): Invalid size %d", size);
@@ -1593,12 +1728,12 @@ void NCSFile::o_getref(InstructionType type) {
  *  The index is popped off the stack, and the reference to the
  *  variable inside the array is pushed on top.
  */
-void NCSFile::o_getrefarray(InstructionType type) {
-	if (type != kInstTypeDirect)
-		throw Common::Exception("NCSFile::o_getrefarray(): Illegal type %d", type);
+void NCSFile::o_getrefarray(const Instruction &instr) {
+	if (instr.type != kInstTypeDirect)
+		throw Common::Exception("NCSFile::o_getrefarray(): Illegal type %d", instr.type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0];
+	int32 size   = instr.args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_getrefarray(): Invalid size %d", size);
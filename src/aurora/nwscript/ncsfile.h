@@ -37,6 +37,8 @@
 #include "src/aurora/nwscript/types.h"
 #include "src/aurora/nwscript/variable.h"
 #include "src/aurora/nwscript/variablecontainer.h"
+#include "src/aurora/nwscript/ncsprogram.h"
+#include "src/aurora/nwscript/profiler.h"
 
 namespace Common {
 	class UString;
@@ -47,6 +49,11 @@ namespace Aurora {
 
 namespace NWScript {
 
+/** The stack of an NWScript execution.
+ *
+ *  The variables on the stack are kept around even when they're popped or
+ *  the stack is reset, so that their storage can be reused by later pushes.
+ */
 class NCSStack : public std::vector<Variable> {
 public:
 	NCSStack();
@@ -57,7 +64,10 @@ public:
 	bool empty() const;
 
 	Variable &top();
+	/** Pop the top-most element off the stack. */
 	Variable pop();
+	/** Pop the top-most element off the stack, moving its value into var. */
+	void pop(Variable &var);
 	void push(const Variable &obj);
 
 	Variable &getRelSP(int32 pos);
@@ -75,17 +85,31 @@ public:
 	void print() const;
 
 private:
+	/** The number of variables we make room for right away. */
+	static const size_t kInitialSize = 64;
+
 	int32 _stackPtr;
 	int32 _basePtr;
 };
 
-#define DECLARE_OPCODE(x) void x(InstructionType type)
+#define DECLARE_OPCODE(x) void x(const Instruction &instr)
 
-/** An NCS, BioWare's NWN Compile Script. */
+/** An NCS, BioWare's NWN Compile Script.
+ *
+ *  An NCSFile holds the state of one execution of a script. The script's
+ *  bytecode itself lives in an immutable NCSProgram that can be shared
+ *  between many NCSFile instances. Scripts loaded by name are taken out
+ *  of the NCSProgramCache, so constructing an NCSFile for a script that
+ *  has been run before is cheap.
+ */
 class NCSFile : public AuroraFile {
 public:
+	/** Load a script out of a stream, taking over the stream. */
 	NCSFile(Common::SeekableReadStream *ncs);
+	/** Load the named script, using the NCS program cache. */
 	NCSFile(const Common::UString &ncs);
+	/** Run this compiled program. */
+	NCSFile(const NCSProgramPtr &program);
 	~NCSFile();
 
 	const Common::UString &getName() const;
@@ -110,58 +134,16 @@ public:
 	static ScriptState getEmptyState();
 
 private:
-	enum InstructionType {
-		// Unary
-		kInstTypeNone        =  0,
-		kInstTypeDirect      =  1,
-		kInstTypeInt         =  3,
-		kInstTypeFloat       =  4,
-		kInstTypeString      =  5,
-		kInstTypeObject      =  6,
-		kInstTypeResource    = 96,
-		kInstTypeEngineType0 = 16, // NWN:     effect        DA: event
-		kInstTypeEngineType1 = 17, // NWN:     event         DA: location
-		kInstTypeEngineType2 = 18, // NWN:     location      DA: command
-		kInstTypeEngineType3 = 19, // NWN:     talent        DA: effect
-		kInstTypeEngineType4 = 20, // NWN:     itemproperty  DA: itemproperty
-		kInstTypeEngineType5 = 21, // Witcher: mod           DA: player
-
-		// Arrays
-		kInstTypeIntArray          = 64,
-		kInstTypeFloatArray        = 65,
-		kInstTypeStringArray       = 66,
-		kInstTypeObjectArray       = 67,
-		kInstTypeResourceArray     = 68,
-		kInstTypeEngineType0Array  = 80,
-		kInstTypeEngineType1Array  = 81,
-		kInstTypeEngineType2Array  = 82,
-		kInstTypeEngineType3Array  = 83,
-		kInstTypeEngineType4Array  = 84,
-		kInstTypeEngineType5Array  = 85,
-
-		// Binary
-		kInstTypeIntInt                 = 32,
-		kInstTypeFloatFloat             = 33,
-		kInstTypeObjectObject           = 34,
-		kInstTypeStringString           = 35,
-		kInstTypeStructStruct           = 36,
-		kInstTypeIntFloat               = 37,
-		kInstTypeFloatInt               = 38,
-		kInstTypeEngineType0EngineType0 = 48,
-		kInstTypeEngineType1EngineType1 = 49,
-		kInstTypeEngineType2EngineType2 = 50,
-		kInstTypeEngineType3EngineType3 = 51,
-		kInstTypeEngineType4EngineType4 = 52,
-		kInstTypeEngineType5EngineType5 = 53,
-		kInstTypeVectorVector           = 58,
-		kInstTypeVectorFloat            = 59,
-		kInstTypeFloatVector            = 60
-	};
-
 	Common::UString _name;
 
 	NCSStack _stack;
-	Common::ScopedPtr<Common::SeekableReadStream> _script;
+
+	NCSProgramPtr _program; ///< The script's compiled program.
+
+	const Instruction *_instructions; ///< The program's instructions.
+	size_t _instructionCount;         ///< The number of instructions in the program.
+
+	uint32 _pc; ///< The index of the next instruction to execute.
 
 	Variable _return;
 
@@ -170,28 +152,41 @@ private:
 
 	VariableContainer _env;
 
-	std::stack<uint32> _returnOffsets;
+	/** Indices of the instructions to return to. */
+	std::stack< uint32, std::vector<uint32> > _returnStack;
 
 	Variable _storedState;
 
-	typedef void (NCSFile::*OpcodeProc)(InstructionType type);
-	struct Opcode {
-		OpcodeProc proc;
-		const char *desc;
+	/** A subroutine call, as tracked for the profiler. */
+	struct ProfileFrame {
+		uint32 address;            ///< The offset of the subroutine.
+		uint64 startTime;          ///< The time the subroutine was entered.
+		uint64 startInstructions;  ///< The number of instructions executed before the call.
+		uint64 calleeTime;         ///< The time spent in subroutines called by this one.
+		uint64 calleeInstructions; ///< The number of instructions executed by called subroutines.
 	};
-	const Opcode *_opcodes;
-	size_t _opcodeListSize;
-	void setupOpcodes();
 
-	void load();
+	bool _profiling; ///< Are we recording a profile of this run?
+
+	std::vector<ProfileFrame>   _profileStack; ///< The subroutines currently being executed.
+	Profiler::SubroutineProfile _profile;      ///< The profile of this run's subroutines.
+
+	void load(const NCSProgramPtr &program);
 
 	/** Reset the script for another execution. */
 	void reset();
 
 	const Variable &execute(Object *owner = 0, Object *triggerer = 0);
 
-	/** Execute one script step. */
-	bool executeStep();
+	/** Continue execution at the target of this jump instruction. */
+	void jump(const Instruction &instr);
+
+	/** Start profiling a subroutine call. */
+	void enterSubroutine(uint32 address, uint64 instructions);
+	/** Finish profiling the current subroutine call. */
+	void leaveSubroutine(uint64 instructions);
+	/** Hand the profile of this run over to the profiler. */
+	void finishProfile(uint64 instructions, uint64 time);
 
 	void decompile(); // TODO
 
@@ -0,0 +1,381 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Compiled NWScript programs, shared between script runs.
+ */
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/encoding.h"
+#include "src/common/debug.h"
+
+#include "src/aurora/aurorafile.h"
+#include "src/aurora/resman.h"
+
+#include "src/aurora/nwscript/ncsprogram.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::NCSProgramCache)
+
+using Common::kDebugScripts;
+
+static const uint32 kNCSTag    = MKTAG('N', 'C', 'S', ' ');
+static const uint32 kVersion10 = MKTAG('V', '1', '.', '0');
+
+static const uint32 kScriptStart = 13; // 8 byte header + 5 byte program size dummy op
+
+namespace Aurora {
+
+namespace NWScript {
+
+NCSProgram::NCSProgram(Common::SeekableReadStream &ncs, const Common::UString &name) :
+	_name(name), _size(0) {
+
+	load(ncs);
+}
+
+NCSProgram::~NCSProgram() {
+}
+
+const Common::UString &NCSProgram::getName() const {
+	return _name;
+}
+
+const byte *NCSProgram::getData() const {
+	return _data.get();
+}
+
+size_t NCSProgram::getSize() const {
+	return _size;
+}
+
+const Instruction *NCSProgram::getInstructions() const {
+	return &_instructions[0];
+}
+
+size_t NCSProgram::getInstructionCount() const {
+	return _instructions.size();
+}
+
+const Variable &NCSProgram::getConstant(uint32 index) const {
+	assert(index < _constants.size());
+
+	return _constants[index];
+}
+
+uint32 NCSProgram::findInstruction(uint32 address) const {
+	// The end of the bytecode is always the end of the script
+	if (address == _size)
+		return _instructions.size() - 1;
+
+	// The instructions are ordered by address, so we can do a binary search
+	size_t first = 0, last = _instructions.size();
+	while (first < last) {
+		const size_t mid = first + (last - first) / 2;
+
+		if (_instructions[mid].address < address)
+			first = mid + 1;
+		else
+			last = mid;
+	}
+
+	if ((first == _instructions.size()) || (_instructions[first].address != address))
+		return kInvalidIndex;
+
+	return first;
+}
+
+void NCSProgram::load(Common::SeekableReadStream &ncs) {
+	uint32 id, version;
+	AuroraFile::readHeader(ncs, id, version);
+
+	if (id != kNCSTag)
+		throw Common::Exception("Try to load non-NCS file");
+
+	if (version != kVersion10)
+		throw Common::Exception("Unsupported NCS file version %08X", version);
+
+	byte lengthOpcode = ncs.readByte();
+	if (lengthOpcode != 0x42)
+		throw Common::Exception("Script size opcode != 0x42 (0x%02X)", lengthOpcode);
+
+	uint32 length = ncs.readUint32BE();
+	if (length > ((uint32) ncs.size()))
+		throw Common::Exception("Script size %u > stream size %u", length, (uint)ncs.size());
+	if (length < ((uint32) ncs.size()))
+		warning("TODO: NCSProgram::load(): Script size %u < stream size %u", length, (uint)ncs.size());
+
+	_size = ncs.size();
+	_data.reset(new byte[_size]);
+
+	ncs.seek(0);
+	if (ncs.read(_data.get(), _size) != _size)
+		throw Common::Exception(Common::kReadError);
+
+	decode();
+}
+
+/** Decode the bytecode into instructions.
+ *
+ *  This is a linear sweep over the whole bytecode. The sweep stops at an
+ *  instruction we can't know the length of, like an unknown opcode. Should
+ *  the script ever try to execute it, it will throw.
+ */
+void NCSProgram::decode() {
+	Common::MemoryReadStream script(_data.get(), _size);
+	script.seek(kScriptStart);
+
+	bool complete = true;
+	while (complete && ((script.size() - script.pos()) >= 2)) {
+		Instruction instr;
+
+		instr.address = script.pos();
+		instr.opcode  = script.readByte();
+		instr.type    = script.readByte();
+		instr.index   = kInvalidIndex;
+
+		instr.args[0] = instr.args[1] = instr.args[2] = 0;
+
+		try {
+			complete = decodeArguments(script, instr);
+		} catch (...) {
+			instr.args[0] = instr.opcode;
+			instr.opcode  = kOpcodeTruncated;
+
+			complete = false;
+		}
+
+		_instructions.push_back(instr);
+	}
+
+	// Finish with an explicit end of the script, so we never run off the instruction array
+
+	Instruction end;
+
+	end.address = complete ? script.pos() : _size;
+	end.opcode  = kOpcodeEnd;
+	end.type    = 0;
+	end.index   = kInvalidIndex;
+
+	end.args[0] = end.args[1] = end.args[2] = 0;
+
+	_instructions.push_back(end);
+
+	resolveJumps();
+
+	debugC(kDebugScripts, 3, "Decoded NCS \"%s\": %u instructions, %u constants",
+	       _name.c_str(), (uint)_instructions.size(), (uint)_constants.size());
+}
+
+/** Read the direct arguments of an instruction.
+ *
+ *  Returns false if the length of the instruction is unknown.
+ */
+bool NCSProgram::decodeArguments(Common::SeekableReadStream &script, Instruction &instr) {
+	switch (instr.opcode) {
+		case kOpcodeCPDOWNSP:
+		case kOpcodeCPTOPSP:
+		case kOpcodeCPDOWNBP:
+		case kOpcodeCPTOPBP:
+		case kOpcodeWRITEARRAY:
+		case kOpcodeREADARRAY:
+		case kOpcodeGETREF:
+		case kOpcodeGETREFARRAY:
+			instr.args[0] = script.readSint32BE();
+			instr.args[1] = script.readSint16BE();
+			break;
+
+		case kOpcodeMOVSP:
+		case kOpcodeJMP:
+		case kOpcodeJSR:
+		case kOpcodeJZ:
+		case kOpcodeJNZ:
+		case kOpcodeDECSP:
+		case kOpcodeINCSP:
+		case kOpcodeDECBP:
+		case kOpcodeINCBP:
+			instr.args[0] = script.readSint32BE();
+			break;
+
+		case kOpcodeACTION:
+			instr.args[0] = script.readUint16BE();
+			instr.args[1] = script.readByte();
+			break;
+
+		case kOpcodeEQ:
+		case kOpcodeNEQ:
+			// Comparisons between two structs (or two vectors) come with the size of the type
+			if (instr.type == kInstTypeStructStruct)
+				instr.args[0] = script.readUint16BE();
+			break;
+
+		case kOpcodeDESTRUCT:
+			instr.args[0] = script.readSint16BE();
+			instr.args[1] = script.readSint16BE();
+			instr.args[2] = script.readSint16BE();
+			break;
+
+		case kOpcodeSTORESTATE:
+			instr.args[0] = (int32) script.readUint32BE();
+			instr.args[1] = (int32) script.readUint32BE();
+			break;
+
+		case kOpcodeCONST:
+			switch (instr.type) {
+				case kInstTypeInt:
+					instr.index = _constants.size();
+					_constants.push_back(Variable(script.readSint32BE()));
+					break;
+
+				case kInstTypeFloat:
+					instr.index = _constants.size();
+					_constants.push_back(Variable(script.readIEEEFloatBE()));
+					break;
+
+				case kInstTypeString:
+				case kInstTypeResource: {
+					const size_t length = script.readUint16BE();
+
+					instr.index = _constants.size();
+					_constants.push_back(Variable(Common::readStringFixed(script, Common::kEncodingASCII, length)));
+					break;
+				}
+
+				case kInstTypeObject:
+					// Object constants depend on the script's owner, so they're resolved at run time
+					instr.args[0] = (int32) script.readUint32BE();
+					break;
+
+				default:
+					return false;
+			}
+			break;
+
+		case 0x00: // Doesn't exist, but it has always been run as a NOP
+			instr.opcode = kOpcodeNOP;
+			break;
+
+		case kOpcodeRSADD:
+		case kOpcodeLOGAND:
+		case kOpcodeLOGOR:
+		case kOpcodeINCOR:
+		case kOpcodeEXCOR:
+		case kOpcodeBOOLAND:
+		case kOpcodeGEQ:
+		case kOpcodeGT:
+		case kOpcodeLT:
+		case kOpcodeLEQ:
+		case kOpcodeSHLEFT:
+		case kOpcodeSHRIGHT:
+		case kOpcodeUSHRIGHT:
+		case kOpcodeADD:
+		case kOpcodeSUB:
+		case kOpcodeMUL:
+		case kOpcodeDIV:
+		case kOpcodeMOD:
+		case kOpcodeNEG:
+		case kOpcodeCOMP:
+		case kOpcodeSTORESTATEALL:
+		case kOpcodeRETN:
+		case kOpcodeNOT:
+		case kOpcodeSAVEBP:
+		case kOpcodeRESTOREBP:
+		case kOpcodeNOP:
+			break;
+
+		default:
+			instr.args[0] = instr.opcode;
+			instr.opcode  = kOpcodeIllegal;
+			return false;
+	}
+
+	return true;
+}
+
+/** Resolve the relative jump offsets into instruction indices. */
+void NCSProgram::resolveJumps() {
+	for (std::vector<Instruction>::iterator i = _instructions.begin(); i != _instructions.end(); ++i) {
+		if ((i->opcode != kOpcodeJMP) && (i->opcode != kOpcodeJSR) &&
+		    (i->opcode != kOpcodeJZ ) && (i->opcode != kOpcodeJNZ))
+			continue;
+
+		const int64 target = ((int64) i->address) + i->args[0];
+		if ((target < 0) || (target > (int64) _size))
+			continue;
+
+		i->index = findInstruction((uint32) target);
+	}
+}
+
+
+NCSProgramCache::NCSProgramCache() : _size(0), _generation(0) {
+}
+
+NCSProgramCache::~NCSProgramCache() {
+}
+
+void NCSProgramCache::clear() {
+	Common::StackLock lock(_mutex);
+
+	clearInternal();
+}
+
+void NCSProgramCache::clearInternal() {
+	_programs.clear();
+	_size = 0;
+}
+
+NCSProgramPtr NCSProgramCache::get(const Common::UString &name) {
+	Common::StackLock lock(_mutex);
+
+	const uint32 generation = ResMan.getGeneration();
+	if (generation != _generation) {
+		clearInternal();
+
+		_generation = generation;
+	}
+
+	ProgramMap::const_iterator p = _programs.find(name);
+	if (p != _programs.end())
+		return p->second;
+
+	Common::ScopedPtr<Common::SeekableReadStream> ncs(ResMan.getResource(name, kFileTypeNCS));
+	if (!ncs)
+		throw Common::Exception("No such NCS \"%s\"", name.c_str());
+
+	NCSProgramPtr program(new NCSProgram(*ncs, name));
+
+	if ((_size + program->getSize()) > kMaxSize)
+		clearInternal();
+
+	_programs.insert(std::make_pair(name, program));
+	_size += program->getSize();
+
+	debugC(kDebugScripts, 2, "Cached NCS \"%s\" (%u programs, %u bytes)",
+	       name.c_str(), (uint)_programs.size(), (uint)_size);
+
+	return program;
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
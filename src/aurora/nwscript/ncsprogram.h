@@ -0,0 +1,279 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Compiled NWScript programs, shared between script runs.
+ */
+
+#ifndef AURORA_NWSCRIPT_NCSPROGRAM_H
+#define AURORA_NWSCRIPT_NCSPROGRAM_H
+
+#include <map>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "src/common/types.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/singleton.h"
+#include "src/common/mutex.h"
+
+#include "src/aurora/nwscript/variable.h"
+
+namespace Common {
+	class SeekableReadStream;
+}
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** The opcodes of NWScript instructions. */
+enum Opcode {
+	kOpcodeCPDOWNSP       = 0x01,
+	kOpcodeRSADD          = 0x02,
+	kOpcodeCPTOPSP        = 0x03,
+	kOpcodeCONST          = 0x04,
+	kOpcodeACTION         = 0x05,
+	kOpcodeLOGAND         = 0x06,
+	kOpcodeLOGOR          = 0x07,
+	kOpcodeINCOR          = 0x08,
+	kOpcodeEXCOR          = 0x09,
+	kOpcodeBOOLAND        = 0x0A,
+	kOpcodeEQ             = 0x0B,
+	kOpcodeNEQ            = 0x0C,
+	kOpcodeGEQ            = 0x0D,
+	kOpcodeGT             = 0x0E,
+	kOpcodeLT             = 0x0F,
+	kOpcodeLEQ            = 0x10,
+	kOpcodeSHLEFT         = 0x11,
+	kOpcodeSHRIGHT        = 0x12,
+	kOpcodeUSHRIGHT       = 0x13,
+	kOpcodeADD            = 0x14,
+	kOpcodeSUB            = 0x15,
+	kOpcodeMUL            = 0x16,
+	kOpcodeDIV            = 0x17,
+	kOpcodeMOD            = 0x18,
+	kOpcodeNEG            = 0x19,
+	kOpcodeCOMP           = 0x1A,
+	kOpcodeMOVSP          = 0x1B,
+	kOpcodeSTORESTATEALL  = 0x1C,
+	kOpcodeJMP            = 0x1D,
+	kOpcodeJSR            = 0x1E,
+	kOpcodeJZ             = 0x1F,
+	kOpcodeRETN           = 0x20,
+	kOpcodeDESTRUCT       = 0x21,
+	kOpcodeNOT            = 0x22,
+	kOpcodeDECSP          = 0x23,
+	kOpcodeINCSP          = 0x24,
+	kOpcodeJNZ            = 0x25,
+	kOpcodeCPDOWNBP       = 0x26,
+	kOpcodeCPTOPBP        = 0x27,
+	kOpcodeDECBP          = 0x28,
+	kOpcodeINCBP          = 0x29,
+	kOpcodeSAVEBP         = 0x2A,
+	kOpcodeRESTOREBP      = 0x2B,
+	kOpcodeSTORESTATE     = 0x2C,
+	kOpcodeNOP            = 0x2D,
+	kOpcodeWRITEARRAY     = 0x30,
+	kOpcodeREADARRAY      = 0x32,
+	kOpcodeGETREF         = 0x37,
+	kOpcodeGETREFARRAY    = 0x39,
+
+	// Pseudo opcodes, only created by the decoder
+
+	kOpcodeEnd            = 0xF0, ///< The end of the script.
+	kOpcodeIllegal        = 0xF1, ///< An unknown opcode, found in args[0].
+	kOpcodeTruncated      = 0xF2  ///< An instruction cut off by the end of the script.
+};
+
+/** The types of NWScript instructions. */
+enum InstructionType {
+	// Unary
+	kInstTypeNone        =  0,
+	kInstTypeDirect      =  1,
+	kInstTypeInt         =  3,
+	kInstTypeFloat       =  4,
+	kInstTypeString      =  5,
+	kInstTypeObject      =  6,
+	kInstTypeResource    = 96,
+	kInstTypeEngineType0 = 16, // NWN:     effect        DA: event
+	kInstTypeEngineType1 = 17, // NWN:     event         DA: location
+	kInstTypeEngineType2 = 18, // NWN:     location      DA: command
+	kInstTypeEngineType3 = 19, // NWN:     talent        DA: effect
+	kInstTypeEngineType4 = 20, // NWN:     itemproperty  DA: itemproperty
+	kInstTypeEngineType5 = 21, // Witcher: mod           DA: player
+
+	// Arrays
+	kInstTypeIntArray          = 64,
+	kInstTypeFloatArray        = 65,
+	kInstTypeStringArray       = 66,
+	kInstTypeObjectArray       = 67,
+	kInstTypeResourceArray     = 68,
+	kInstTypeEngineType0Array  = 80,
+	kInstTypeEngineType1Array  = 81,
+	kInstTypeEngineType2Array  = 82,
+	kInstTypeEngineType3Array  = 83,
+	kInstTypeEngineType4Array  = 84,
+	kInstTypeEngineType5Array  = 85,
+
+	// Binary
+	kInstTypeIntInt                 = 32,
+	kInstTypeFloatFloat             = 33,
+	kInstTypeObjectObject           = 34,
+	kInstTypeStringString           = 35,
+	kInstTypeStructStruct           = 36,
+	kInstTypeIntFloat               = 37,
+	kInstTypeFloatInt               = 38,
+	kInstTypeEngineType0EngineType0 = 48,
+	kInstTypeEngineType1EngineType1 = 49,
+	kInstTypeEngineType2EngineType2 = 50,
+	kInstTypeEngineType3EngineType3 = 51,
+	kInstTypeEngineType4EngineType4 = 52,
+	kInstTypeEngineType5EngineType5 = 53,
+	kInstTypeVectorVector           = 58,
+	kInstTypeVectorFloat            = 59,
+	kInstTypeFloatVector            = 60
+};
+
+/** A decoded NWScript instruction. */
+struct Instruction {
+	uint32 address; ///< The offset of the instruction within the bytecode.
+
+	uint8 opcode; ///< The instruction's opcode.
+	uint8 type;   ///< The instruction's type.
+
+	int32 args[3]; ///< The instruction's direct arguments, in bytecode order.
+
+	/** For jumps, the index of the target instruction.
+	 *  For constants, the index of the value in the program's constant pool. */
+	uint32 index;
+};
+
+/** A compiled NWScript program.
+ *
+ *  This is the immutable part of an NCS file: its validated bytecode,
+ *  decoded into an array of instructions. Jump targets are resolved to
+ *  instruction indices and constant values are parsed beforehand, so
+ *  running the program doesn't need to look at the bytecode at all.
+ *
+ *  A program can be shared between any number of NCSFile instances,
+ *  each of which holds the state of one execution of the script.
+ */
+class NCSProgram : boost::noncopyable {
+public:
+	/** Load a program out of an NCS stream. */
+	NCSProgram(Common::SeekableReadStream &ncs, const Common::UString &name = "");
+	~NCSProgram();
+
+	/** Return the name of the script. */
+	const Common::UString &getName() const;
+
+	/** Return the complete bytecode, including the header. */
+	const byte *getData() const;
+	/** Return the size of the complete bytecode. */
+	size_t getSize() const;
+
+	/** Return the decoded instructions.
+	 *
+	 *  The last instruction is always a kOpcodeEnd.
+	 */
+	const Instruction *getInstructions() const;
+	/** Return the number of decoded instructions. */
+	size_t getInstructionCount() const;
+
+	/** Return the index of the instruction at this bytecode offset.
+	 *
+	 *  If there's no instruction starting at that offset, kInvalidIndex is returned.
+	 */
+	uint32 findInstruction(uint32 address) const;
+
+	/** Return a value out of the constant pool. */
+	const Variable &getConstant(uint32 index) const;
+
+	static const uint32 kInvalidIndex = 0xFFFFFFFF;
+
+private:
+	Common::UString _name;
+
+	Common::ScopedArray<byte> _data;
+	size_t _size;
+
+	std::vector<Instruction> _instructions;
+	std::vector<Variable>    _constants;
+
+	void load(Common::SeekableReadStream &ncs);
+
+	void decode();
+	bool decodeArguments(Common::SeekableReadStream &script, Instruction &instr);
+	void resolveJumps();
+};
+
+typedef boost::shared_ptr<const NCSProgram> NCSProgramPtr;
+
+/** A cache of compiled NWScript programs, by name.
+ *
+ *  Looking up a program that's already in the cache is cheap: there's no
+ *  need to fetch and validate the script resource again.
+ *
+ *  Whenever the resources known to the resource manager change, the cache
+ *  is emptied, since a different resource might now be found for a name.
+ *  The cache is also emptied should its programs grow too large.
+ */
+class NCSProgramCache : public Common::Singleton<NCSProgramCache> {
+public:
+	NCSProgramCache();
+	~NCSProgramCache();
+
+	/** Remove all programs from the cache. */
+	void clear();
+
+	/** Return the program of the named NCS script, loading it if necessary.
+	 *
+	 *  If no such script exists, an exception is thrown.
+	 */
+	NCSProgramPtr get(const Common::UString &name);
+
+private:
+	/** The maximum combined size of all programs in the cache. */
+	static const size_t kMaxSize = 16 * 1024 * 1024;
+
+	typedef std::map<Common::UString, NCSProgramPtr, Common::UString::iless> ProgramMap;
+
+	Common::Mutex _mutex;
+
+	ProgramMap _programs;
+	size_t     _size;
+
+	uint32 _generation; ///< The resource manager generation the cache is valid for.
+
+	void clearInternal();
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the NCS program cache. */
+#define NCSCache Aurora::NWScript::NCSProgramCache::instance()
+
+#endif // AURORA_NWSCRIPT_NCSPROGRAM_H
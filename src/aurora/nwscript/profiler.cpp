@@ -0,0 +1,208 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Profiling of NWScript execution.
+ */
+
+#include <algorithm>
+
+#include <SDL_timer.h>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/strutil.h"
+#include "src/common/writefile.h"
+
+#include "src/aurora/nwscript/profiler.h"
+#include "src/aurora/nwscript/functionman.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::Profiler)
+
+namespace Aurora {
+
+namespace NWScript {
+
+Profiler::Entry::Entry() : calls(0), instructions(0), time(0) {
+}
+
+void Profiler::Entry::add(uint64 c, uint64 i, uint64 t) {
+	calls        += c;
+	instructions += i;
+	time         += t;
+}
+
+
+Profiler::Profiler() : _enabled(false) {
+}
+
+Profiler::~Profiler() {
+}
+
+bool Profiler::isEnabled() const {
+	return _enabled;
+}
+
+void Profiler::setEnabled(bool enabled) {
+	_enabled = enabled;
+}
+
+void Profiler::reset() {
+	Common::StackLock lock(_mutex);
+
+	_scripts.clear();
+	_functions.clear();
+}
+
+uint64 Profiler::getTicks() {
+	return SDL_GetPerformanceCounter();
+}
+
+void Profiler::addScript(const Common::UString &script, uint64 instructions, uint64 time) {
+	Common::StackLock lock(_mutex);
+
+	_scripts[script].total.add(1, instructions, time);
+}
+
+void Profiler::addSubroutines(const Common::UString &script, const SubroutineProfile &subroutines) {
+	Common::StackLock lock(_mutex);
+
+	SubroutineProfile &profile = _scripts[script].subroutines;
+
+	for (SubroutineProfile::const_iterator s = subroutines.begin(); s != subroutines.end(); ++s)
+		profile[s->first].add(s->second.calls, s->second.instructions, s->second.time);
+}
+
+void Profiler::addFunction(uint32 function, uint64 time) {
+	Common::StackLock lock(_mutex);
+
+	if (_functions.size() <= function)
+		_functions.resize(function + 1);
+
+	_functions[function].add(1, 0, time);
+}
+
+/** An entry of the report, sortable by time. */
+struct ReportLine {
+	uint64 time;
+	Common::UString line;
+
+	ReportLine(uint64 t, const Common::UString &l) : time(t), line(l) {
+	}
+
+	bool operator<(const ReportLine &right) const {
+		return time > right.time;
+	}
+};
+
+static double ticksToMS(uint64 ticks) {
+	return (ticks * 1000.0) / SDL_GetPerformanceFrequency();
+}
+
+static void addReportLines(std::vector<Common::UString> &report, std::vector<ReportLine> &lines,
+                           size_t maxEntries) {
+
+	std::sort(lines.begin(), lines.end());
+
+	if ((maxEntries > 0) && (lines.size() > maxEntries))
+		lines.erase(lines.begin() + maxEntries, lines.end());
+
+	for (std::vector<ReportLine>::const_iterator l = lines.begin(); l != lines.end(); ++l)
+		report.push_back(l->line);
+}
+
+void Profiler::getReport(std::vector<Common::UString> &report, size_t maxEntries) const {
+	Common::StackLock lock(_mutex);
+
+	std::vector<ReportLine> scripts, subroutines, functions;
+
+	Entry total;
+	for (ScriptMap::const_iterator s = _scripts.begin(); s != _scripts.end(); ++s) {
+		const Entry &e = s->second.total;
+
+		total.add(e.calls, e.instructions, e.time);
+
+		scripts.push_back(ReportLine(e.time, Common::UString::format("%10s | %12s | %12.3f | %s",
+		    Common::composeString(e.calls).c_str(), Common::composeString(e.instructions).c_str(),
+		    ticksToMS(e.time), s->first.c_str())));
+
+		const SubroutineProfile &subs = s->second.subroutines;
+		for (SubroutineProfile::const_iterator r = subs.begin(); r != subs.end(); ++r) {
+			const Entry &re = r->second;
+
+			subroutines.push_back(ReportLine(re.time, Common::UString::format("%10s | %12s | %12.3f | %s @ %u",
+			    Common::composeString(re.calls).c_str(), Common::composeString(re.instructions).c_str(),
+			    ticksToMS(re.time), s->first.c_str(), r->first)));
+		}
+	}
+
+	for (size_t i = 0; i < _functions.size(); i++) {
+		const Entry &e = _functions[i];
+		if (e.calls == 0)
+			continue;
+
+		Common::UString name = FunctionMan.getName(i);
+		if (name.empty())
+			name = "???";
+
+		functions.push_back(ReportLine(e.time, Common::UString::format("%10s | %12.3f | %s (%u)",
+		    Common::composeString(e.calls).c_str(), ticksToMS(e.time), name.c_str(), (uint)i)));
+	}
+
+	report.push_back(Common::UString::format("NWScript profile: %s script runs, %s instructions, %.3f ms",
+	    Common::composeString(total.calls).c_str(), Common::composeString(total.instructions).c_str(),
+	    ticksToMS(total.time)));
+
+	report.push_back("");
+	report.push_back("      Runs | Instructions |    Time (ms) | Script");
+	report.push_back("-----------|--------------|--------------|-------");
+	addReportLines(report, scripts, maxEntries);
+
+	report.push_back("");
+	report.push_back("     Calls | Instructions |    Time (ms) | Subroutine (exclusive of its callees)");
+	report.push_back("-----------|--------------|--------------|-------------------------------------");
+	addReportLines(report, subroutines, maxEntries);
+
+	report.push_back("");
+	report.push_back("     Calls |    Time (ms) | Engine function");
+	report.push_back("-----------|--------------|----------------");
+	addReportLines(report, functions, maxEntries);
+}
+
+void Profiler::dump(const Common::UString &fileName) const {
+	std::vector<Common::UString> report;
+	getReport(report);
+
+	Common::WriteFile file;
+	if (!file.open(fileName))
+		throw Common::Exception(Common::kOpenError);
+
+	for (std::vector<Common::UString>::const_iterator l = report.begin(); l != report.end(); ++l) {
+		file.writeString(*l);
+		file.writeString("\n");
+	}
+
+	file.flush();
+	file.close();
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,114 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Profiling of NWScript execution.
+ */
+
+#ifndef AURORA_NWSCRIPT_PROFILER_H
+#define AURORA_NWSCRIPT_PROFILER_H
+
+#include <vector>
+#include <map>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/singleton.h"
+#include "src/common/mutex.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** A profiler for NWScript execution.
+ *
+ *  When enabled, every script run records how many instructions it
+ *  executed and how long it took. The numbers are collected per script,
+ *  per subroutine within a script and per engine function, and can then
+ *  be printed as a report, with the most expensive entries first.
+ *
+ *  The figures for subroutines are exclusive of the subroutines they call
+ *  themselves, so that they add up to the figures of the whole script.
+ */
+class Profiler : public Common::Singleton<Profiler> {
+public:
+	/** The profile of one script, subroutine or engine function. */
+	struct Entry {
+		uint64 calls;        ///< How often it was called.
+		uint64 instructions; ///< How many instructions it executed.
+		uint64 time;         ///< How long it ran, in profiler ticks.
+
+		Entry();
+
+		void add(uint64 c, uint64 i, uint64 t);
+	};
+
+	/** The profiles of the subroutines of a script, by their offset. */
+	typedef std::map<uint32, Entry> SubroutineProfile;
+
+	Profiler();
+	~Profiler();
+
+	bool isEnabled() const;
+	void setEnabled(bool enabled);
+
+	/** Throw away everything collected so far. */
+	void reset();
+
+	/** Record the run of a script. */
+	void addScript(const Common::UString &script, uint64 instructions, uint64 time);
+	/** Record the subroutines called during the run of a script. */
+	void addSubroutines(const Common::UString &script, const SubroutineProfile &subroutines);
+	/** Record the call of an engine function. */
+	void addFunction(uint32 function, uint64 time);
+
+	/** Create a report, with at most this many entries per category (0 == all). */
+	void getReport(std::vector<Common::UString> &report, size_t maxEntries = 0) const;
+
+	/** Write a report of everything collected so far into a file. */
+	void dump(const Common::UString &fileName) const;
+
+	/** Return the current time, in profiler ticks. */
+	static uint64 getTicks();
+
+private:
+	struct Script {
+		Entry total;
+		SubroutineProfile subroutines;
+	};
+
+	typedef std::map<Common::UString, Script, Common::UString::iless> ScriptMap;
+
+	bool _enabled;
+
+	ScriptMap          _scripts;
+	std::vector<Entry> _functions; ///< Indexed by function ID.
+
+	mutable Common::Mutex _mutex;
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the NWScript profiler. */
+#define ScriptProfiler Aurora::NWScript::Profiler::instance()
+
+#endif // AURORA_NWSCRIPT_PROFILER_H
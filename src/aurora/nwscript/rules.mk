@@ -32,6 +32,8 @@ src_aurora_nwscript_libnwscript_la_SOURCES += \
     src/aurora/nwscript/object.h \
     src/aurora/nwscript/objectcontainer.h \
     src/aurora/nwscript/functionman.h \
+    src/aurora/nwscript/ncsprogram.h \
+    src/aurora/nwscript/profiler.h \
     src/aurora/nwscript/ncsfile.h \
     $(EMPTY)
 
@@ -42,5 +44,7 @@ src_aurora_nwscript_libnwscript_la_SOURCES += \
     src/aurora/nwscript/functioncontext.cpp \
     src/aurora/nwscript/objectcontainer.cpp \
     src/aurora/nwscript/functionman.cpp \
+    src/aurora/nwscript/ncsprogram.cpp \
+    src/aurora/nwscript/profiler.cpp \
     src/aurora/nwscript/ncsfile.cpp \
     $(EMPTY)
@@ -22,6 +22,8 @@
  *  NWScript variable.
  */
 
+#include <new>
+
 #include <boost/make_shared.hpp>
 
 #include "src/common/error.h"
@@ -38,75 +40,158 @@ Variable::Variable(Type type) : _type(kTypeVoid) {
 	setType(type);
 }
 
-Variable::Variable(int32 value) : _type(kTypeVoid) {
-	setType(kTypeInt);
-
-	*this = value;
+Variable::Variable(int32 value) : _type(kTypeInt) {
+	_value._int = value;
 }
 
-Variable::Variable(float value) : _type(kTypeVoid) {
-	setType(kTypeFloat);
-
-	*this = value;
+Variable::Variable(float value) : _type(kTypeFloat) {
+	_value._float = value;
 }
 
 Variable::Variable(const Common::UString &value) : _type(kTypeVoid) {
-	setType(kTypeString);
+	new (_value._string) Common::UString(value);
 
-	*this = value;
+	_type = kTypeString;
 }
 
-Variable::Variable(Object *value) : _type(kTypeVoid) {
-	setType(kTypeObject);
-
-	*this = value;
+Variable::Variable(Object *value) : _type(kTypeObject) {
+	_value._object = value;
 }
 
 Variable::Variable(const EngineType *value) : _type(kTypeVoid) {
-	setType(kTypeEngineType);
+	_value._engineType = value ? value->clone() : 0;
 
-	*this = value;
+	_type = kTypeEngineType;
 }
 
 Variable::Variable(const EngineType &value) : _type(kTypeVoid) {
-	setType(kTypeEngineType);
+	_value._engineType = value.clone();
 
-	*this = value;
+	_type = kTypeEngineType;
 }
 
-Variable::Variable(float x, float y, float z) : _type(kTypeVoid) {
-	setType(kTypeVector);
-
-	setVector(x, y, z);
+Variable::Variable(float x, float y, float z) : _type(kTypeVector) {
+	_value._vector[0] = x;
+	_value._vector[1] = y;
+	_value._vector[2] = z;
 }
 
 Variable::Variable(const Variable &var) : _type(kTypeVoid) {
-	*this = var;
+	construct(var);
 }
 
 Variable::~Variable() {
-	setType(kTypeVoid);
+	destroy();
 }
 
-void Variable::setType(Type type) {
-	_array.reset();
+Common::UString &Variable::string() {
+	return *reinterpret_cast<Common::UString *>(_value._string);
+}
 
-	if      (_type == kTypeString)
-		delete _value._string;
-	else if (_type == kTypeEngineType)
-		delete _value._engineType;
-	else if (_type == kTypeScriptState)
-		delete _value._scriptState;
+const Common::UString &Variable::string() const {
+	return *reinterpret_cast<const Common::UString *>(_value._string);
+}
 
-	_type = type;
+Variable::ArrayPtr &Variable::array() {
+	return *reinterpret_cast<ArrayPtr *>(_value._array);
+}
+
+const Variable::ArrayPtr &Variable::array() const {
+	return *reinterpret_cast<const ArrayPtr *>(_value._array);
+}
 
+void Variable::destroy() {
 	switch (_type) {
+		case kTypeString:
+			string().~UString();
+			break;
+
+		case kTypeArray:
+			array().~ArrayPtr();
+			break;
+
+		case kTypeEngineType:
+			delete _value._engineType;
+			break;
+
+		case kTypeScriptState:
+			delete _value._scriptState;
+			break;
+
+		default:
+			break;
+	}
+
+	_type = kTypeVoid;
+}
+
+void Variable::construct(const Variable &var) {
+	assert(_type == kTypeVoid);
+
+	switch (var._type) {
+		case kTypeString:
+			new (_value._string) Common::UString(var.string());
+			break;
+
+		case kTypeArray:
+			new (_value._array) ArrayPtr(var.array());
+			break;
+
+		case kTypeEngineType:
+			_value._engineType = var._value._engineType ? var._value._engineType->clone() : 0;
+			break;
+
+		case kTypeScriptState:
+			_value._scriptState = new ScriptState(*var._value._scriptState);
+			break;
+
+		default:
+			_value = var._value;
+			break;
+	}
+
+	_type = var._type;
+}
+
+void Variable::move(Variable &var) {
+	assert(_type == kTypeVoid);
+
+	const Type type = var._type;
+
+	switch (type) {
+		case kTypeString:
+			new (_value._string) Common::UString;
+			string().swap(var.string());
+			break;
+
+		case kTypeArray:
+			new (_value._array) ArrayPtr;
+			array().swap(var.array());
+			break;
+
+		default:
+			// Plain values and pointers to heap objects, which we simply take over
+			_value = var._value;
+
+			var._type = kTypeVoid;
+			break;
+	}
+
+	_type = type;
+
+	var.destroy();
+}
+
+void Variable::setType(Type type) {
+	destroy();
+
+	switch (type) {
 		case kTypeVoid:
 		case kTypeAny:
 			break;
 
 		case kTypeArray:
-			_array = boost::make_shared<Array>();
+			new (_value._array) ArrayPtr(boost::make_shared<Array>());
 			break;
 
 		case kTypeInt:
@@ -118,7 +203,7 @@ void Variable::setType(Type type) {
 			break;
 
 		case kTypeString:
-			_value._string = new Common::UString;
+			new (_value._string) Common::UString;
 			break;
 
 		case kTypeObject:
@@ -147,28 +232,48 @@ void Variable::setType(Type type) {
 			throw Common::Exception("Variable::setType(): Invalid type %d", type);
 			break;
 	}
+
+	_type = type;
 }
 
 Variable &Variable::operator=(const Variable &var) {
 	if (&var == this)
 		return *this;
 
-	setType(var._type);
+	if (_type != var._type) {
+		destroy();
+		construct(var);
+
+		return *this;
+	}
+
+	// Same type: reuse what we already have
 
 	if      (_type == kTypeString)
-		*_value._string = *var._value._string;
+		string() = var.string();
 	else if (_type == kTypeEngineType)
 		*this = var._value._engineType;
 	else if (_type == kTypeScriptState)
 		*_value._scriptState = *var._value._scriptState;
 	else if (_type == kTypeArray)
-		_array = var._array;
+		array() = var.array();
 	else
 		_value = var._value;
 
 	return *this;
 }
 
+void Variable::swap(Variable &var) {
+	if (&var == this)
+		return;
+
+	Variable tmp;
+
+	tmp.move(*this);
+	move(var);
+	var.move(tmp);
+}
+
 Variable &Variable::operator=(int32 value) {
 	if (_type != kTypeInt)
 		throw Common::Exception("Can't assign an int value to a non-int variable");
@@ -191,7 +296,7 @@ Variable &Variable::operator=(const Common::UString &value) {
 	if (_type != kTypeString)
 		throw Common::Exception("Can't assign a string value to a non-string variable");
 
-	*_value._string = value;
+	string() = value;
 
 	return *this;
 }
@@ -242,7 +347,7 @@ bool Variable::operator==(const Variable &var) const {
 			return _value._float == var._value._float;
 
 		case kTypeString:
-			return *_value._string == *var._value._string;
+			return string() == var.string();
 
 		case kTypeObject:
 			return _value._object == var._value._object;
@@ -253,7 +358,7 @@ bool Variable::operator==(const Variable &var) const {
 			       _value._vector[2] == var._value._vector[2];
 
 		case kTypeArray:
-			return _array.get() && var._array.get() && *_array == *var._array;
+			return array().get() && var.array().get() && *array() == *var.array();
 
 		default:
 			break;
@@ -288,14 +393,14 @@ const Common::UString &Variable::getString() const {
 	if (_type != kTypeString)
 		throw Common::Exception("Can't get a string value from a non-string variable");
 
-	return *_value._string;
+	return string();
 }
 
 Common::UString &Variable::getString() {
 	if (_type != kTypeString)
 		throw Common::Exception("Can't get a string value from a non-string variable");
 
-	return *_value._string;
+	return string();
 }
 
 Object *Variable::getObject() const {
@@ -334,41 +439,43 @@ const Variable::Array &Variable::getArray() const {
 	if (_type != kTypeArray)
 		throw Common::Exception("Can't get an array value from a non-array variable");
 
-	assert(_array.get());
+	assert(array().get());
 
-	return *_array;
+	return *array();
 }
 
 Variable::Array &Variable::getArray() {
 	if (_type != kTypeArray)
 		throw Common::Exception("Can't get an array value from a non-array variable");
 
-	assert(_array.get());
+	assert(array().get());
 
-	return *_array;
+	return *array();
 }
 
 size_t Variable::getArraySize() const {
 	if (_type != kTypeArray)
 		throw Common::Exception("Can't get an array size from a non-array variable");
 
-	assert(_array.get());
+	assert(array().get());
 
-	return _array->size();
+	return array()->size();
 }
 
 void Variable::growArray(Type type, size_t size) {
 	if (_type != kTypeArray)
 		throw Common::Exception("Can't grow a non-array variable");
 
-	assert(_array.get());
+	assert(array().get());
+
+	Array &values = *array();
 
-	if (!_array->empty() && (*_array)[0].get() && (*_array)[0]->getType() != type)
-		throw Common::Exception("Array type mismatch (%d vs %d)", (*_array)[0]->getType(), type);
+	if (!values.empty() && values[0].get() && values[0]->getType() != type)
+		throw Common::Exception("Array type mismatch (%d vs %d)", values[0]->getType(), type);
 
-	_array->reserve(size);
-	while (_array->size() < size)
-		_array->push_back(boost::make_shared<Variable>(Variable(type)));
+	values.reserve(size);
+	while (values.size() < size)
+		values.push_back(boost::make_shared<Variable>(Variable(type)));
 }
 
 ScriptState &Variable::getScriptState() {
@@ -30,15 +30,12 @@
 #include <boost/shared_ptr.hpp>
 
 #include "src/common/types.h"
+#include "src/common/ustring.h"
 
 #include "src/aurora/types.h"
 
 #include "src/aurora/nwscript/types.h"
 
-namespace Common {
-	class UString;
-}
-
 namespace Aurora {
 
 namespace NWScript {
@@ -52,6 +49,15 @@ struct ScriptState {
 	std::vector<class Variable> locals;
 };
 
+/** A variable in an NWScript.
+ *
+ *  The value of a variable is held directly within the variable object:
+ *  a string is constructed in-place (short strings don't need any extra
+ *  memory at all), and so is the reference-counted pointer to an array.
+ *  Only engine types and script states live on the heap. Variables of
+ *  any other type can be created, copied and destroyed without touching
+ *  the allocator.
+ */
 class Variable {
 public:
 	typedef std::vector< boost::shared_ptr<Variable> > Array;
@@ -71,6 +77,9 @@ public:
 
 	Variable &operator=(const Variable &var);
 
+	/** Exchange the values of two variables, without copying them. */
+	void swap(Variable &var);
+
 	Variable &operator=(int32 value);
 	Variable &operator=(float value);
 	Variable &operator=(const Common::UString &value);
@@ -107,20 +116,38 @@ public:
 	void setReference(Variable *reference);
 
 private:
+	typedef boost::shared_ptr<Array> ArrayPtr;
+
 	Type _type;
 
 	union {
 		int32 _int;
 		float _float;
-		Common::UString *_string;
 		Object *_object;
 		float _vector[3];
 		ScriptState *_scriptState;
 		EngineType *_engineType;
 		Variable *_reference;
+
+		byte _string[sizeof(Common::UString)]; ///< Storage for an in-place string.
+		byte _array[sizeof(ArrayPtr)];         ///< Storage for an in-place array pointer.
+
+		uint64 _alignment;    ///< Align the storage for the in-place objects.
+		void  *_alignmentPtr; ///< Align the storage for the in-place objects.
 	} _value;
 
-	boost::shared_ptr<Array> _array;
+	Common::UString &string();
+	const Common::UString &string() const;
+
+	ArrayPtr &array();
+	const ArrayPtr &array() const;
+
+	/** Destroy the current value, leaving a void variable. */
+	void destroy();
+	/** Copy the value of another variable into this void variable. */
+	void construct(const Variable &var);
+	/** Move the value of another variable into this void variable, leaving the other one void. */
+	void move(Variable &var);
 };
 
 } // End of namespace NWScript
@@ -48,6 +48,8 @@ const Archive::ResourceList &PEFile::getResources() const {
 }
 
 Common::SeekableReadStream *PEFile::getResource(uint32 index, bool UNUSED(tryNoCopy)) const {
+	Common::StackLock lock(_mutex);
+
 	// Convert from the PE cursor group/cursor format to the standalone
 	// cursor format.
 
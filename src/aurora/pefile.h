@@ -30,6 +30,7 @@
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/archive.h"
@@ -61,6 +62,9 @@ private:
 	/** External list of resource names and types. */
 	ResourceList _resources;
 
+	/** Serializes the resource conversions, which all use the exe's stream position. */
+	mutable Common::Mutex _mutex;
+
 	void load(const std::vector<Common::UString> &remap);
 };
 
@@ -23,8 +23,11 @@
  */
 
 #include <cassert>
+#include <algorithm>
 
 #include <boost/scope_exit.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
 
 #include "src/common/util.h"
 #include "src/common/scopedptr.h"
@@ -32,7 +35,10 @@
 #include "src/common/readstream.h"
 #include "src/common/filepath.h"
 #include "src/common/readfile.h"
+#include "src/common/mappedfile.h"
 #include "src/common/writefile.h"
+#include "src/common/threadpool.h"
+#include "src/common/ptrvector.h"
 
 #include "src/aurora/resman.h"
 #include "src/aurora/util.h"
@@ -51,10 +57,17 @@
 // Check for hash collisions (if possible)
 #define CHECK_HASH_COLLISION 1
 
+/** The default maximum number of bytes of resource data kept in the cache. */
+static const size_t kDefaultCacheSize = 64 * 1024 * 1024;
+
 DECLARE_SINGLETON(Aurora::ResourceManager)
 
 namespace Aurora {
 
+static bool compareResourceIDs(const ResourceManager::ResourceID &a, const ResourceManager::ResourceID &b) {
+	return a.hash < b.hash;
+}
+
 ResourceManager::KnownArchive::KnownArchive() :
 	type(kArchiveMAX), resource(0), opened(0) {
 
@@ -69,8 +82,8 @@ ResourceManager::KnownArchive::KnownArchive(ArchiveType t, const Common::UString
 ResourceManager::OpenedArchive::OpenedArchive() : archive(0), known(0), parent(0) {
 }
 
-void ResourceManager::OpenedArchive::set(KnownArchive &kA, Archive &a) {
-	archive = &a;
+void ResourceManager::OpenedArchive::set(KnownArchive &kA, Archive *a) {
+	archive = a;
 	known   = &kA;
 
 	if (known->opened)
@@ -93,8 +106,8 @@ void ResourceManager::OpenedArchive::set(KnownArchive &kA, Archive &a) {
 }
 
 
-ResourceManager::Resource::Resource() : type(kFileTypeNone), isSmall(false), priority(0),
-		source(kSourceNone), archive(0), archiveIndex(0xFFFFFFFF) {
+ResourceManager::Resource::Resource() : name(""), type(kFileTypeNone), hash(0), isSmall(false), priority(0),
+		source(kSourceNone), path(""), archive(0), archiveIndex(0xFFFFFFFF) {
 
 	selfArchive.first = 0;
 }
@@ -105,7 +118,7 @@ bool ResourceManager::Resource::operator<(const Resource &right) const {
 
 
 ResourceManager::ResourceManager() : _hasSmall(false),
-	_hashAlgo(Common::kHashFNV64) {
+	_hashAlgo(Common::kHashFNV64), _generation(0), _cache(kDefaultCacheSize) {
 
 	// These file types are archives
 
@@ -179,9 +192,13 @@ void ResourceManager::clear() {
 
 	setRIMsAreERFs(false);
 	clearResources();
+
+	_index.clear();
 }
 
 void ResourceManager::clearResources() {
+	waitForAsyncResources();
+
 	_cursorRemap.clear();
 
 	_baseDir.clear();
@@ -195,8 +212,13 @@ void ResourceManager::clearResources() {
 	_openedArchives.clear();
 
 	_resources.clear();
+	_names.clear();
+
+	_generation++;
 
 	_changes.clear();
+
+	_cache.clear();
 }
 
 void ResourceManager::setRIMsAreERFs(bool rimsAreERFs) {
@@ -288,7 +310,66 @@ Common::SeekableReadStream *ResourceManager::openArchiveStream(const KnownArchiv
 	if (!archive.resource)
 		throw Common::Exception("Archive without resource reference");
 
-	return getResource(*archive.resource, true);
+	/* Archives that are plain files are mapped into memory, if possible. That way,
+	 * resources within them can be read without any system calls, and nested
+	 * archives as well as tryNoCopy resources are handed out without copying. */
+	const Resource &res = *archive.resource;
+	if ((res.source == kSourceFile) && !res.isSmall) {
+		Common::SeekableReadStream *mappedFile = Common::MappedFile::open(res.path);
+		if (mappedFile)
+			return mappedFile;
+	}
+
+	return getResource(res, true);
+}
+
+Archive *ResourceManager::openArchive(const KnownArchive &knownArchive, const std::vector<byte> &password) const {
+	Common::SeekableReadStream *archiveStream = openArchiveStream(knownArchive);
+
+	switch (knownArchive.type) {
+		case kArchiveBIF:
+			return new BIFFile(archiveStream);
+
+		case kArchiveNDS:
+			return new NDSFile(archiveStream);
+
+		case kArchiveHERF:
+			return new HERFFile(archiveStream);
+
+		case kArchiveERF:
+			return new ERFFile(archiveStream, password);
+
+		case kArchiveRIM:
+			return new RIMFile(archiveStream);
+
+		case kArchiveZIP:
+			return new ZIPFile(archiveStream);
+
+		case kArchiveEXE:
+			return new PEFile(archiveStream, _cursorRemap);
+
+		case kArchiveNSBTX:
+			return new NSBTXFile(archiveStream);
+
+		default:
+			break;
+	}
+
+	delete archiveStream;
+	throw Common::Exception("Invalid archive type %d", knownArchive.type);
+}
+
+Archive &ResourceManager::getArchive(OpenedArchive &archive) const {
+	// Archives indexed out of the resource index are only opened on first use
+	Common::StackLock lock(_archiveMutex);
+
+	if (!archive.archive) {
+		assert(archive.known);
+
+		archive.archive = openArchive(*archive.known, std::vector<byte>());
+	}
+
+	return *archive.archive;
 }
 
 void ResourceManager::indexArchive(const Common::UString &file, uint32 priority,
@@ -301,72 +382,201 @@ void ResourceManager::indexArchive(const Common::UString &file, uint32 priority,
 	if (knownArchive->type == kArchiveBIF)
 		throw Common::Exception("Attempted to index a lone BIF");
 
+	// A KEY references lots of BIFs, which are best opened in parallel
+	if ((knownArchive->type == kArchiveKEY) && isArchiveFile(*knownArchive)) {
+		indexArchives(std::vector<ArchiveRequest>(1, ArchiveRequest(file, priority, password, changeID)));
+		return;
+	}
+
 	Change *change = 0;
 	if (changeID)
 		change = newChangeSet(*changeID);
 
-	Common::SeekableReadStream *archiveStream = openArchiveStream(*knownArchive);
+	indexArchive(*knownArchive, priority, password, change);
+}
 
-	Common::ScopedPtr<Archive> archive;
-	switch (knownArchive->type) {
-		case kArchiveKEY:
-			indexKEY(archiveStream, priority, change);
-			break;
+void ResourceManager::indexArchive(const Common::UString &file, uint32 priority, Common::ChangeID *changeID) {
+	std::vector<byte> password;
 
-		case kArchiveNDS:
-			archive.reset(new NDSFile(archiveStream));
-			break;
+	indexArchive(file, priority, password, changeID);
+}
 
-		case kArchiveHERF:
-			archive.reset(new HERFFile(archiveStream));
-			break;
+void ResourceManager::indexArchive(KnownArchive &knownArchive, uint32 priority,
+                                   const std::vector<byte> &password, Change *change) {
 
-		case kArchiveERF:
-			archive.reset(new ERFFile(archiveStream, password));
-			break;
+	// If the archive hasn't changed since we last saw it, use our index of its contents
+	if (password.empty() && indexArchiveFromIndex(knownArchive, priority, change))
+		return;
 
-		case kArchiveRIM:
-			archive.reset(new RIMFile(archiveStream));
-			break;
+	if (knownArchive.type == kArchiveKEY) {
+		indexKEY(knownArchive, priority, change);
+		return;
+	}
 
-		case kArchiveZIP:
-			archive.reset(new ZIPFile(archiveStream));
-			break;
+	indexArchive(knownArchive, openArchive(knownArchive, password), priority, change);
+}
 
-		case kArchiveEXE:
-			archive.reset(new PEFile(archiveStream, _cursorRemap));
-			break;
+ResourceManager::ArchiveRequest::ArchiveRequest(const Common::UString &f, uint32 p, Common::ChangeID *c) :
+	file(f), priority(p), changeID(c) {
 
-		case kArchiveNSBTX:
-			archive.reset(new NSBTXFile(archiveStream));
-			break;
+}
 
-		default:
-			throw Common::Exception("Invalid archive type %d", knownArchive->type);
+ResourceManager::ArchiveRequest::ArchiveRequest(const Common::UString &f, uint32 p,
+                                                const std::vector<byte> &pw, Common::ChangeID *c) :
+	file(f), priority(p), password(pw), changeID(c) {
+
+}
+
+ResourceManager::ParsedArchive::ParsedArchive(KnownArchive &k, const ArchiveRequest &r) :
+	known(&k), request(&r), parsed(false), failed(false) {
+
+}
+
+ResourceManager::ParsedArchive::~ParsedArchive() {
+}
+
+void ResourceManager::ParsedArchive::fail(const Common::Exception &e) {
+	Common::StackLock lock(mutex);
+
+	// Only remember the first error
+	if (failed)
+		return;
+
+	failed = true;
+	error  = e;
+}
+
+void ResourceManager::indexArchives(const std::vector<ArchiveRequest> &archives) {
+	Common::PtrVector<ParsedArchive> parsed;
+	parsed.reserve(archives.size());
+
+	// Find all the archives first
+	for (std::vector<ArchiveRequest>::const_iterator a = archives.begin(); a != archives.end(); ++a) {
+		KnownArchive *knownArchive = findArchive(a->file);
+		if (!knownArchive)
+			throw Common::Exception("No such archive file \"%s\"", a->file.c_str());
+
+		if (knownArchive->type == kArchiveBIF)
+			throw Common::Exception("Attempted to index a lone BIF");
+
+		parsed.push_back(new ParsedArchive(*knownArchive, *a));
 	}
 
-	if (archive)
-		indexArchive(*knownArchive, archive.release(), priority, change);
+	/* Parse the archives in parallel. We only need to do that for plain archive
+	 * files not already found in our persistent index. Archives within other
+	 * archives need to be read through their parent archives, which is not
+	 * safe to do from several threads, so they are left for the serial pass. */
+	if (Common::ThreadPool::getCPUCount() > 1) {
+		Common::ThreadPool &pool = getThreadPool();
+
+		for (Common::PtrVector<ParsedArchive>::iterator p = parsed.begin(); p != parsed.end(); ++p) {
+			if (!isArchiveFile(*(*p)->known))
+				continue;
+
+			if ((*p)->request->password.empty() && hasIndexEntries(*(*p)->known))
+				continue;
+
+			(*p)->parsed = true;
+			pool.addJob(boost::bind(&ResourceManager::parseArchive, this, boost::ref(**p), boost::ref(pool)));
+		}
+
+		pool.wait();
+	}
+
+	// Add the resources of all archives, in the order given
+	for (Common::PtrVector<ParsedArchive>::iterator p = parsed.begin(); p != parsed.end(); ++p) {
+		const ArchiveRequest &request = *(*p)->request;
+
+		Change *change = 0;
+		if (request.changeID)
+			change = newChangeSet(*request.changeID);
+
+		try {
+			if ((*p)->failed)
+				throw (*p)->error;
+
+			if (!(*p)->parsed)
+				indexArchive(*(*p)->known, request.priority, request.password, change);
+			else if ((*p)->known->type == kArchiveKEY)
+				indexKEYBIFs(*(*p)->known, (*p)->bifNames, (*p)->bifArchives, (*p)->bifs, request.priority, change);
+			else
+				indexArchive(*(*p)->known, (*p)->archive.release(), request.priority, change);
+
+		} catch (Common::Exception &e) {
+			e.add("Failed to index archive \"%s\"", request.file.c_str());
+			throw;
+		}
+	}
 }
 
-void ResourceManager::indexArchive(const Common::UString &file, uint32 priority, Common::ChangeID *changeID) {
-	std::vector<byte> password;
+void ResourceManager::parseArchive(ParsedArchive &archive, Common::ThreadPool &pool) {
+	try {
+		if (archive.known->type != kArchiveKEY) {
+			archive.archive.reset(openArchive(*archive.known, archive.request->password));
+			return;
+		}
 
-	indexArchive(file, priority, password, changeID);
+		// Read the KEY and find its BIFs, then open the BIFs in parallel as well
+		{
+			Common::ScopedPtr<Common::SeekableReadStream> keyStream(openArchiveStream(*archive.known));
+			archive.key.reset(new KEYFile(*keyStream));
+		}
+
+		archive.bifNames = archive.key->getBIFs();
+		archive.bifArchives.resize(archive.bifNames.size(), 0);
+		archive.bifs.resize(archive.bifNames.size(), 0);
+
+		for (size_t i = 0; i < archive.bifNames.size(); i++) {
+			archive.bifArchives[i] = findArchive(archive.bifNames[i], _knownArchives[kArchiveBIF]);
+			if (!archive.bifArchives[i])
+				throw Common::Exception("BIF \"%s\" not found", archive.bifNames[i].c_str());
+
+			if (!isArchiveFile(*archive.bifArchives[i]))
+				throw Common::Exception("BIF \"%s\" is not a plain file", archive.bifNames[i].c_str());
+		}
+
+		for (size_t i = 0; i < archive.bifNames.size(); i++)
+			pool.addJob(boost::bind(&ResourceManager::parseKEYBIF, this, boost::ref(archive), i));
+
+	} catch (Common::Exception &e) {
+		archive.fail(e);
+	} catch (std::exception &e) {
+		archive.fail(Common::Exception(e));
+	} catch (...) {
+		archive.fail(Common::Exception("Unknown exception"));
+	}
+}
+
+void ResourceManager::parseKEYBIF(ParsedArchive &archive, size_t bif) {
+	try {
+		Common::ScopedPtr<BIFFile> bifFile(new BIFFile(openArchiveStream(*archive.bifArchives[bif])));
+		bifFile->mergeKEY(*archive.key, bif);
+
+		archive.bifs[bif] = bifFile.release();
+
+	} catch (Common::Exception &e) {
+		archive.fail(e);
+	} catch (std::exception &e) {
+		archive.fail(Common::Exception(e));
+	} catch (...) {
+		archive.fail(Common::Exception("Unknown exception"));
+	}
 }
 
 uint32 ResourceManager::openKEYBIFs(Common::SeekableReadStream *keyStream,
+                                    std::vector<Common::UString> &names,
                                     std::vector<KnownArchive *> &archives,
                                     std::vector<BIFFile *> &bifs) {
 
 	bool success = false;
-	BOOST_SCOPE_EXIT( (&success) (&archives) (&bifs) ) {
+	BOOST_SCOPE_EXIT( (&success) (&names) (&archives) (&bifs) ) {
 		if (!success) {
 			for (std::vector<BIFFile *>::iterator b = bifs.begin(); b != bifs.end(); ++b)
 				delete *b;
 
 			bifs.clear();
 			archives.clear();
+			names.clear();
 		}
 	} BOOST_SCOPE_EXIT_END
 
@@ -374,6 +584,7 @@ uint32 ResourceManager::openKEYBIFs(Common::SeekableReadStream *keyStream,
 	KEYFile key(*keyStream);
 
 	const KEYFile::BIFList &keyBIFs = key.getBIFs();
+	names = keyBIFs;
 	archives.resize(keyBIFs.size(), 0);
 	bifs.resize(keyBIFs.size(), 0);
 
@@ -390,20 +601,124 @@ uint32 ResourceManager::openKEYBIFs(Common::SeekableReadStream *keyStream,
 	return archives.size();
 }
 
-void ResourceManager::indexKEY(Common::SeekableReadStream *stream, uint32 priority, Change *change) {
+void ResourceManager::indexKEY(KnownArchive &knownArchive, uint32 priority, Change *change) {
+	std::vector<Common::UString> names;
+	std::vector<KnownArchive *> archives;
+	Common::PtrVector<BIFFile> bifs;
+
+	openKEYBIFs(openArchiveStream(knownArchive), names, archives, bifs);
+
+	indexKEYBIFs(knownArchive, names, archives, bifs, priority, change);
+}
+
+void ResourceManager::indexKEYBIFs(KnownArchive &knownArchive, const std::vector<Common::UString> &names,
+                                   const std::vector<KnownArchive *> &archives, std::vector<BIFFile *> &bifs,
+                                   uint32 priority, Change *change) {
+
+	assert((names.size() == archives.size()) && (names.size() == bifs.size()));
+
+	bool indexable = canIndex(knownArchive);
+	for (size_t i = 0; i < bifs.size(); i++) {
+		indexable = indexable && canIndex(*archives[i]);
+
+		// Hand over the BIF
+		BIFFile *bif = bifs[i];
+		bifs[i] = 0;
+
+		indexArchive(*archives[i], bif, priority, change);
+	}
+
+	// The KEY itself only remembers its BIFs, which in turn remember their resources
+	if (indexable)
+		_index.add(knownArchive.resource->path, Common::kHashNone, Archive::ResourceList(), names);
+}
+
+bool ResourceManager::indexArchiveFromIndex(KnownArchive &knownArchive, uint32 priority, Change *change) {
 	std::vector<KnownArchive *> archives;
-	std::vector<BIFFile *> bifs;
+	std::vector<const ResourceIndex::Entry *> entries;
 
-	const uint32 count = openKEYBIFs(stream, archives, bifs);
+	if (!findIndexEntries(knownArchive, archives, entries))
+		return false;
+
+	for (size_t i = 0; i < archives.size(); i++)
+		indexArchive(*archives[i], 0, entries[i]->resources, entries[i]->hashAlgo, priority, change);
 
-	for (uint32 i = 0; i < count; i++)
-		indexArchive(*archives[i], bifs[i], priority, change);
+	return true;
+}
+
+bool ResourceManager::hasIndexEntries(KnownArchive &knownArchive) {
+	std::vector<KnownArchive *> archives;
+	std::vector<const ResourceIndex::Entry *> entries;
+
+	return findIndexEntries(knownArchive, archives, entries);
+}
+
+bool ResourceManager::findIndexEntries(KnownArchive &knownArchive, std::vector<KnownArchive *> &archives,
+                                       std::vector<const ResourceIndex::Entry *> &entries) {
+
+	if (!canIndex(knownArchive))
+		return false;
+
+	const ResourceIndex::Entry *entry = _index.find(knownArchive.resource->path);
+	if (!entry)
+		return false;
+
+	if (knownArchive.type != kArchiveKEY) {
+		archives.push_back(&knownArchive);
+		entries.push_back(entry);
+
+		return true;
+	}
+
+	// For a KEY, all the BIFs it references need to be unchanged as well
+	archives.reserve(entry->archives.size());
+	entries.reserve(entry->archives.size());
+
+	for (std::vector<Common::UString>::const_iterator bif = entry->archives.begin();
+	     bif != entry->archives.end(); ++bif) {
+
+		KnownArchive *bifArchive = findArchive(*bif, _knownArchives[kArchiveBIF]);
+		if (!bifArchive || !canIndex(*bifArchive))
+			return false;
+
+		const ResourceIndex::Entry *bifEntry = _index.find(bifArchive->resource->path);
+		if (!bifEntry)
+			return false;
+
+		archives.push_back(bifArchive);
+		entries.push_back(bifEntry);
+	}
+
+	return true;
+}
+
+bool ResourceManager::isArchiveFile(const KnownArchive &knownArchive) const {
+	const Resource *res = knownArchive.resource;
+
+	return res && (res->source == kSourceFile) && !res->isSmall;
+}
+
+bool ResourceManager::canIndex(const KnownArchive &knownArchive) const {
+	/* Only plain archive files can be found in the index. EXE files are left out,
+	 * because their resource list depends on the cursor remapping. */
+	return isArchiveFile(knownArchive) && (knownArchive.type != kArchiveEXE);
 }
 
 void ResourceManager::indexArchive(KnownArchive &knownArchive, Archive *archive,
                                    uint32 priority, Change *change) {
 
 	const Common::HashAlgo hashAlgo = archive->getNameHashAlgo();
+
+	if (canIndex(knownArchive))
+		_index.add(knownArchive.resource->path, hashAlgo, archive->getResources());
+
+	indexArchive(knownArchive, archive, archive->getResources(), hashAlgo, priority, change);
+}
+
+void ResourceManager::indexArchive(KnownArchive &knownArchive, Archive *archive,
+                                   const Archive::ResourceList &resources, Common::HashAlgo hashAlgo,
+                                   uint32 priority, Change *change) {
+
 	if ((hashAlgo != Common::kHashNone) && (hashAlgo != _hashAlgo))
 		throw Common::Exception("ResourceManager::indexArchive(): Archive uses a different name hashing "
 		                        "algorithm than we do (%d vs. %d)", (int) hashAlgo, (int) _hashAlgo);
@@ -418,14 +733,13 @@ void ResourceManager::indexArchive(KnownArchive &knownArchive, Archive *archive,
 		}
 	} BOOST_SCOPE_EXIT_END
 
-	_openedArchives.back().set(knownArchive, *archive);
+	_openedArchives.back().set(knownArchive, archive);
 	couldSet = true;
 
 	// Add the information of the new archive to the change set
 	if (change)
 		change->_change->openedArchives.push_back(--_openedArchives.end());
 
-	const Archive::ResourceList &resources = archive->getResources();
 	for (Archive::ResourceList::const_iterator resource = resources.begin(); resource != resources.end(); ++resource) {
 		// Build the resource record
 		Resource res;
@@ -433,22 +747,22 @@ void ResourceManager::indexArchive(KnownArchive &knownArchive, Archive *archive,
 		res.source       = kSourceArchive;
 		res.archive      = &_openedArchives.back();
 		res.archiveIndex = resource->index;
-		res.name         = resource->name;
+		res.name         = _names.intern(resource->name);
 		res.type         = resource->type;
 
 		// Get the hash or calculate if we have to
-		uint64 hash = (hashAlgo == Common::kHashNone) ? getHash(res.name, res.type) : resource->hash;
+		uint64 hash = (hashAlgo == Common::kHashNone) ? getHash(resource->name, res.type) : resource->hash;
 
 		// Normalize the file types if we can and recalculate the hash
-		if ((res.name != "") && (res.type != kFileTypeNone))
+		if (!resource->name.empty() && (res.type != kFileTypeNone))
 			if (normalizeType(res))
-				hash = getHash(res.name, res.type);
+				hash = getHash(resource->name, res.type);
 
 		// Handle "small" files
 		if (_hasSmall && (res.type == kFileTypeSMALL)) {
 			res.isSmall = true;
 
-			res.name = Common::FilePath::getStem(resource->name);
+			res.name = _names.intern(Common::FilePath::getStem(resource->name));
 			res.type = TypeMan.getFileType(resource->name);
 		}
 
@@ -518,6 +832,9 @@ void ResourceManager::undo(Common::ChangeID &changeID) {
 	if (!change || (change->_change == _changes.end()))
 		return;
 
+	// Background reads might still access the resources we're about to remove
+	waitForAsyncResources();
+
 	// Removing all changes in the opened archives list
 	for (OpenedArchiveChanges::iterator oaChange = change->_change->openedArchives.begin();
 	     oaChange != change->_change->openedArchives.end(); ++oaChange) {
@@ -569,47 +886,61 @@ void ResourceManager::undo(Common::ChangeID &changeID) {
 	for (ResourceChanges::iterator resChange = change->_change->resources.begin();
 	     resChange != change->_change->resources.end(); ++resChange) {
 
+		Resource &res = *resChange->resource;
+
 		// If the resource still has an archive attached, it was added by a
 		// declareResources() call and needs to be removed manually
-		if (resChange->resIt->selfArchive.first) {
-			if (resChange->resIt->selfArchive.second->opened)
+		if (res.selfArchive.first) {
+			if (res.selfArchive.second->opened)
 				throw Common::Exception("Attempted to deindex an archive resource that's still opened");
 
-			resChange->resIt->selfArchive.first->erase(resChange->resIt->selfArchive.second);
+			res.selfArchive.first->erase(res.selfArchive.second);
 		}
 
-		// Remove the resource, and the name list too if it's empty
-		resChange->hashIt->second.erase(resChange->resIt);
-
-		if (resChange->hashIt->second.empty())
-			_resources.erase(resChange->hashIt);
+		// Remove the resource, and the hash entry too if it's empty
+		_resources.remove(resChange->hash, res);
+		_generation++;
 	}
 
 	// Now we can remove the change set from our list of change sets
 	_changes.erase(change->_change);
 
+	// Cached data might belong to resources that don't exist anymore
+	_cache.clear();
+
 	// And finally set the change ID to a defined empty state
 	changeID.clear();
 }
 
 void ResourceManager::addTypeAlias(FileType alias, FileType realType) {
 	_typeAliases[alias] = realType;
+
+	_generation++;
 }
 
 void ResourceManager::blacklist(const Common::UString &name, FileType type) {
-	ResourceMap::iterator resList = _resources.find(getHash(name, type));
-	if (resList == _resources.end())
+	// Don't change resources while they're read in the background
+	waitForAsyncResources();
+
+	const ResourceMap::Entry *resList = _resources.find(getHash(name, type));
+	if (!resList)
 		return;
 
-	for (ResourceList::iterator res = resList->second.begin(); res != resList->second.end(); ++res)
-		res->priority = 0;
+	// Since all resources are set to the same priority, the list stays sorted
+	for (size_t i = 0; i < resList->size(); i++)
+		(*resList)[i].priority = 0;
+
+	_generation++;
 }
 
 void ResourceManager::declareResource(const Common::UString &name, FileType type) {
+	// Don't change resources while they're read in the background
+	waitForAsyncResources();
+
 	bool isSmall = false;
 
-	ResourceMap::iterator resList = _resources.find(getHash(name, type));
-	if (resList == _resources.end()) {
+	const ResourceMap::Entry *resList = _resources.find(getHash(name, type));
+	if (!resList) {
 		if (_hasSmall) {
 			Common::UString smallName = TypeMan.addFileType(TypeMan.setFileType(name, type), kFileTypeSMALL);
 
@@ -617,17 +948,23 @@ void ResourceManager::declareResource(const Common::UString &name, FileType type
 			isSmall = true;
 		}
 
-		if (resList == _resources.end())
+		if (!resList)
 			return;
 	}
 
-	for (ResourceList::iterator r = resList->second.begin(); r != resList->second.end(); ++r) {
-		r->name    = name;
-		r->type    = type;
-		r->isSmall = isSmall;
+	const char *internedName = _names.intern(name);
 
-		checkResourceIsArchive(*r, 0);
+	for (size_t i = 0; i < resList->size(); i++) {
+		Resource &r = (*resList)[i];
+
+		r.name    = internedName;
+		r.type    = type;
+		r.isSmall = isSmall;
+
+		checkResourceIsArchive(r, 0);
 	}
+
+	_generation++;
 }
 
 void ResourceManager::declareResource(const Common::UString &name) {
@@ -656,6 +993,10 @@ bool ResourceManager::hasResource(const Common::UString &name, const std::vector
 	return getRes(name, types) != 0;
 }
 
+uint32 ResourceManager::getGeneration() const {
+	return _generation;
+}
+
 bool ResourceManager::hasResource(uint64 hash) const {
 	return getRes(hash) != 0;
 }
@@ -689,10 +1030,10 @@ Common::UString ResourceManager::findResourceFile(const Common::UString &name,
 
 uint32 ResourceManager::getResourceSize(const Resource &res) const {
 	if (res.source == kSourceArchive) {
-		if ((res.archive == 0) || (res.archive->archive == 0) || (res.archiveIndex == 0xFFFFFFFF))
+		if ((res.archive == 0) || (res.archiveIndex == 0xFFFFFFFF))
 			return 0xFFFFFFFF;
 
-		return res.archive->archive->getResourceSize(res.archiveIndex);
+		return getArchive(*res.archive).getResourceSize(res.archiveIndex);
 	}
 
 	if (res.source == kSourceFile)
@@ -701,11 +1042,17 @@ uint32 ResourceManager::getResourceSize(const Resource &res) const {
 	return 0xFFFFFFFF;
 }
 
+bool ResourceManager::isCacheable(const Resource &res) {
+	/* Only resources within archives and "small" files are cached. Plain files can
+	 * be huge (music, videos), and are better streamed from disk directly. */
+	return (res.source == kSourceArchive) || res.isSmall;
+}
+
 Common::SeekableReadStream *ResourceManager::getArchiveResource(const Resource &res, bool tryNoCopy) const {
-	if ((res.archive == 0) || (res.archive->archive == 0) || (res.archiveIndex == 0xFFFFFFFF))
+	if ((res.archive == 0) || (res.archiveIndex == 0xFFFFFFFF))
 		throw Common::Exception("Archive resource has no archive");
 
-	return res.archive->archive->getResource(res.archiveIndex, tryNoCopy);
+	return getArchive(*res.archive).getResource(res.archiveIndex, tryNoCopy);
 }
 
 Common::SeekableReadStream *ResourceManager::getResource(const Common::UString &name, FileType type) const {
@@ -747,6 +1094,13 @@ Common::SeekableReadStream *ResourceManager::getResource(uint64 hash, FileType *
 }
 
 Common::SeekableReadStream *ResourceManager::getResource(const Resource &res, bool tryNoCopy) const {
+	const bool cacheable = !tryNoCopy && isCacheable(res);
+	if (cacheable) {
+		Common::SeekableReadStream *cached = _cache.get(res.hash, &res);
+		if (cached)
+			return cached;
+	}
+
 	Common::SeekableReadStream *stream = 0;
 
 	switch (res.source) {
@@ -767,6 +1121,9 @@ Common::SeekableReadStream *ResourceManager::getResource(const Resource &res, bo
 	if (res.isSmall)
 		stream = Small::decompress(stream);
 
+	if (cacheable)
+		stream = _cache.add(res.hash, &res, stream);
+
 	return stream;
 }
 
@@ -787,32 +1144,44 @@ Common::SeekableReadStream *ResourceManager::getResource(ResourceType resType,
 void ResourceManager::getAvailableResources(FileType type,
 		std::list<ResourceID> &list) const {
 
+	std::list<ResourceID> found;
+
 	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
-		if (!r->second.empty() && (r->second.front().type == type)) {
-			list.push_back(ResourceID());
+		if (r->front().type == type) {
+			found.push_back(ResourceID());
 
-			list.back().name = r->second.front().name;
-			list.back().type = r->second.front().type;
-			list.back().hash = r->first;
+			found.back().name = r->front().name;
+			found.back().type = r->front().type;
+			found.back().hash = r->getHash();
 		}
 	}
+
+	// Keep a stable order, independent of the layout of the resource map
+	found.sort(compareResourceIDs);
+	list.splice(list.end(), found);
 }
 
 void ResourceManager::getAvailableResources(const std::vector<FileType> &types,
 		std::list<ResourceID> &list) const {
 
+	std::list<ResourceID> found;
+
 	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
 		for (std::vector<FileType>::const_iterator t = types.begin(); t != types.end(); ++t) {
-			if (!r->second.empty() && (r->second.front().type == *t)) {
-				list.push_back(ResourceID());
+			if (r->front().type == *t) {
+				found.push_back(ResourceID());
 
-				list.back().name = r->second.front().name;
-				list.back().type = r->second.front().type;
-				list.back().hash = r->first;
+				found.back().name = r->front().name;
+				found.back().type = r->front().type;
+				found.back().hash = r->getHash();
 			}
 		}
 
 	}
+
+	// Keep a stable order, independent of the layout of the resource map
+	found.sort(compareResourceIDs);
+	list.splice(list.end(), found);
 }
 
 void ResourceManager::getAvailableResources(ResourceType type,
@@ -887,17 +1256,18 @@ inline uint64 ResourceManager::getHash(const Common::UString &name) const {
 	return Common::hashString(name.toLower(), _hashAlgo);
 }
 
-void ResourceManager::checkHashCollision(const Resource &resource, ResourceMap::const_iterator resList) {
-	if (resource.name.empty() || resList->second.empty())
+void ResourceManager::checkHashCollision(const Resource &resource, const ResourceMap::Entry &resList) {
+	if (!*resource.name)
 		return;
 
 	Common::UString newName = TypeMan.setFileType(resource.name, resource.type).toLower();
 
-	for (ResourceList::const_iterator r = resList->second.begin(); r != resList->second.end(); ++r) {
-		if (r->name.empty())
+	for (size_t i = 0; i < resList.size(); i++) {
+		const Resource &r = resList[i];
+		if (!*r.name)
 			continue;
 
-		Common::UString oldName = TypeMan.setFileType(r->name, r->type).toLower();
+		Common::UString oldName = TypeMan.setFileType(r.name, r.type).toLower();
 		if (oldName != newName) {
 			warning("ResourceManager: Found hash collision: %s (\"%s\" and \"%s\")",
 					Common::formatHash(getHash(oldName)).c_str(), oldName.c_str(), newName.c_str());
@@ -907,7 +1277,7 @@ void ResourceManager::checkHashCollision(const Resource &resource, ResourceMap::
 }
 
 bool ResourceManager::checkResourceIsArchive(Resource &resource, Change *change) {
-	if ((resource.source == kSourceNone) || resource.name.empty())
+	if ((resource.source == kSourceNone) || !*resource.name)
 		return false;
 
 	ArchiveType type = getArchiveType(resource.type);
@@ -938,59 +1308,47 @@ bool ResourceManager::checkResourceIsArchive(Resource &resource, Change *change)
 }
 
 void ResourceManager::addResource(Resource &resource, uint64 hash, Change *change) {
-	ResourceMap::iterator resList = _resources.find(hash);
-	if (resList == _resources.end()) {
-		// We don't have a resource with this name yet, create a new resource list for it
-
-		std::pair<ResourceMap::iterator, bool> result;
-
-		result = _resources.insert(std::make_pair(hash, ResourceList()));
-
-		resList = result.first;
-	}
-
 #ifdef CHECK_HASH_COLLISION
-	checkHashCollision(resource, resList);
+	const ResourceMap::Entry *resList = _resources.find(hash);
+	if (resList)
+		checkHashCollision(resource, *resList);
 #endif
 
-	// Add the resource to the list
-	resList->second.push_back(resource);
-	Resource *res = &resList->second.back();
+	// Add the resource, sorted by priority, to the list of resources with this hash
+	resource.hash = hash;
 
-	checkResourceIsArchive(*res, change);
+	Resource &res = _resources.add(hash, resource);
+	_generation++;
 
-	// Remember the resource in the change set
-	if (change) {
-		change->_change->resources.push_back(ResourceChange());
-		change->_change->resources.back().hashIt = resList;
-		change->_change->resources.back().resIt  = --resList->second.end();
-	}
+	checkResourceIsArchive(res, change);
 
-	// Resort the list by priority
-	resList->second.sort();
+	// Remember the resource in the change set
+	if (change)
+		change->_change->resources.push_back(ResourceChange(hash, res));
 }
 
 void ResourceManager::addResource(const Common::UString &path, Change *change, uint32 priority) {
 	Resource res;
 	res.priority = priority;
 	res.source   = kSourceFile;
-	res.path     = path;
-	res.name     = Common::FilePath::getStem(path);
+	res.path     = _names.intern(path);
 	res.type     = TypeMan.getFileType(path);
 
+	Common::UString name = Common::FilePath::getStem(path);
+
 	// Handle "small" files
 	if (_hasSmall && (res.type == kFileTypeSMALL)) {
-		const Common::UString name = res.name;
-
 		res.isSmall = true;
 
-		res.name = Common::FilePath::getStem(name);
 		res.type = TypeMan.getFileType(name);
+		name     = Common::FilePath::getStem(name);
 	}
 
-	uint64 hash = getHash(res.name, res.type);
+	res.name = _names.intern(name);
+
+	uint64 hash = getHash(name, res.type);
 	if (normalizeType(res))
-		hash = getHash(res.name, res.type);
+		hash = getHash(name, res.type);
 
 	addResource(res, hash, change);
 }
@@ -1001,11 +1359,11 @@ void ResourceManager::addResources(const Common::FileList &files, Change *change
 }
 
 const ResourceManager::Resource *ResourceManager::getRes(uint64 hash) const {
-	ResourceMap::const_iterator r = _resources.find(hash);
-	if ((r == _resources.end()) || r->second.empty() || (r->second.back().priority == 0))
+	const ResourceMap::Entry *r = _resources.find(hash);
+	if (!r || (r->back().priority == 0))
 		return 0;
 
-	return &r->second.back();
+	return &r->back();
 }
 
 const ResourceManager::Resource *ResourceManager::getRes(const Common::UString &name,
@@ -1045,13 +1403,21 @@ void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
 	file.writeString("                Name                 |        Hash        |     Size    \n");
 	file.writeString("-------------------------------------|--------------------|-------------\n");
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
-		if (r->second.empty())
-			continue;
+	// Sort by hash, independent of the layout of the resource map
+	std::vector< std::pair<uint64, const Resource *> > resources;
+	resources.reserve(_resources.size());
+
+	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r)
+		resources.push_back(std::make_pair(r->getHash(), &r->back()));
 
-		const Resource &res = r->second.back();
+	std::sort(resources.begin(), resources.end());
 
-		const Common::UString &name = res.name;
+	for (std::vector< std::pair<uint64, const Resource *> >::const_iterator r = resources.begin();
+	     r != resources.end(); ++r) {
+
+		const Resource &res = *r->second;
+
+		const Common::UString  name = res.name;
 		const Common::UString   ext = TypeMan.setFileType("", res.type);
 		const uint64           hash = r->first;
 		const uint32           size = getResourceSize(res);
@@ -1067,6 +1433,115 @@ void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
 	file.close();
 }
 
+AsyncResourcePtr ResourceManager::getResourceAsync(const Common::UString &name, FileType type) const {
+	std::vector<FileType> types;
+
+	types.push_back(type);
+
+	return getResourceAsync(name, types);
+}
+
+AsyncResourcePtr ResourceManager::getResourceAsync(const Common::UString &name,
+		const std::vector<FileType> &types) const {
+
+	// Look up the resource right away, only the actual reading is done in the background
+	const Resource *res = getRes(name, types);
+	if (!res)
+		return AsyncResourcePtr(new AsyncResource);
+
+	AsyncResourcePtr resource(new AsyncResource(boost::bind(&ResourceManager::readAsyncResource, this, res),
+	                                            res->type));
+
+	getThreadPool().addJob(boost::bind(&AsyncResource::read, resource));
+
+	return resource;
+}
+
+void ResourceManager::prefetch(const Common::UString &name, FileType type) const {
+	std::vector<FileType> types;
+
+	types.push_back(type);
+
+	prefetch(name, types);
+}
+
+void ResourceManager::prefetch(const Common::UString &name, const std::vector<FileType> &types) const {
+	if (_cache.getCapacity() == 0)
+		return;
+
+	const Resource *res = getRes(name, types);
+	if (!res || !isCacheable(*res))
+		return;
+
+	getThreadPool().addJob(boost::bind(&ResourceManager::prefetchResource, this, res));
+}
+
+void ResourceManager::waitForAsyncResources() const {
+	Common::ThreadPool *pool = 0;
+	{
+		Common::StackLock lock(_threadPoolMutex);
+		pool = _threadPool.get();
+	}
+
+	// Once created, the pool lives as long as we do
+	if (pool)
+		pool->wait();
+}
+
+Common::ThreadPool &ResourceManager::getThreadPool() const {
+	Common::StackLock lock(_threadPoolMutex);
+
+	if (!_threadPool)
+		_threadPool.reset(new Common::ThreadPool);
+
+	return *_threadPool;
+}
+
+Common::SeekableReadStream *ResourceManager::readAsyncResource(const Resource *res) const {
+	assert(res);
+
+	return getResource(*res);
+}
+
+void ResourceManager::prefetchResource(const Resource *res) const {
+	assert(res);
+
+	/* All we want is the side effect of getResource() putting the resource into
+	 * the cache. Errors are ignored here, they resurface once the resource is
+	 * actually requested. */
+	try {
+		delete getResource(*res);
+	} catch (...) {
+	}
+}
+
+void ResourceManager::setCacheSize(size_t size) {
+	_cache.setCapacity(size);
+}
+
+size_t ResourceManager::getCacheSize() const {
+	return _cache.getCapacity();
+}
+
+void ResourceManager::clearCache() {
+	_cache.clear();
+}
+
+void ResourceManager::getCacheStatistics(ResourceCache::Statistics &stats) const {
+	_cache.getStatistics(stats);
+}
+
+bool ResourceManager::loadIndex(const Common::UString &fileName) {
+	return _index.load(fileName);
+}
+
+void ResourceManager::saveIndex(const Common::UString &fileName) {
+	if (!_index.isModified())
+		return;
+
+	_index.save(fileName);
+}
+
 ResourceManager::Change *ResourceManager::newChangeSet(Common::ChangeID &changeID) {
 	// Does this change ID already have a change set attached? If so, use that
 	Change *change = dynamic_cast<Change *>(changeID.getContent());
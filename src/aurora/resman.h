@@ -30,17 +30,29 @@
 #include <map>
 #include <set>
 
+#include <boost/noncopyable.hpp>
+
 #include "src/common/types.h"
 #include "src/common/ustring.h"
 #include "src/common/singleton.h"
 #include "src/common/filelist.h"
 #include "src/common/hash.h"
 #include "src/common/changeid.h"
+#include "src/common/error.h"
+#include "src/common/mutex.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ptrvector.h"
+#include "src/common/stringarena.h"
 
 #include "src/aurora/types.h"
+#include "src/aurora/resourcecache.h"
+#include "src/aurora/resourceindex.h"
+#include "src/aurora/resourcetable.h"
+#include "src/aurora/asyncresource.h"
 
 namespace Common {
 	class SeekableReadStream;
+	class ThreadPool;
 }
 
 namespace Aurora {
@@ -51,6 +63,11 @@ class BIFFile;
 
 /** A resource manager holding information about and handling all request for all
  *  resources usable by the game.
+ *
+ *  The methods in the "Resources" section (hasResource(), getResource(),
+ *  findResourceFile(), ...) and the resource cache may be called from several
+ *  threads at once. All other methods, which add or remove resources, need to
+ *  be called from one thread only, while no other thread accesses resources.
  */
 class ResourceManager : public Common::Singleton<ResourceManager> {
 public:
@@ -60,6 +77,19 @@ public:
 		uint64 hash;
 	};
 
+	/** An archive to be indexed by indexArchives(). */
+	struct ArchiveRequest {
+		Common::UString file; ///< The name of the archive file to index.
+		uint32 priority;      ///< The priority of the archive's resources.
+
+		std::vector<byte> password; ///< The password to decrypt the archive file, if necessary.
+
+		Common::ChangeID *changeID; ///< If given, record the changes done for this archive here.
+
+		ArchiveRequest(const Common::UString &f, uint32 p, Common::ChangeID *c = 0);
+		ArchiveRequest(const Common::UString &f, uint32 p, const std::vector<byte> &pw, Common::ChangeID *c = 0);
+	};
+
 	ResourceManager();
 	~ResourceManager();
 
@@ -135,6 +165,17 @@ public:
 	 */
 	void indexArchive(const Common::UString &file, uint32 priority, const std::vector<byte> &password,
 	                  Common::ChangeID *changeID = 0);
+
+	/** Add all the resources of several archives to the resource manager.
+	 *
+	 *  The archives are opened and parsed in parallel, and then added in the order
+	 *  given, with the same result as calling indexArchive() for each of them in
+	 *  turn. All the archives need to be known beforehand, i.e. an archive can't
+	 *  be found within another archive indexed in the same batch.
+	 *
+	 *  @param archives The archives to index.
+	 */
+	void indexArchives(const std::vector<ArchiveRequest> &archives);
 	// '---
 
 	// .--- Directories and files
@@ -204,6 +245,15 @@ public:
 	// '---
 
 	// .--- Resources
+	/** Return the current generation of the known resources.
+	 *
+	 *  The generation changes whenever resources are added, removed or
+	 *  modified in any way. Caches holding data derived from resources can
+	 *  compare it against the generation they were filled in to find out
+	 *  whether their contents might be stale.
+	 */
+	uint32 getGeneration() const;
+
 	/** Does a specific resource exist?
 	 *
 	 *  @param  hash The hash of the name and extension of the resource.
@@ -338,6 +388,92 @@ public:
 	/** Dump a list of all resources into a file. */
 	void dumpResourcesList(const Common::UString &fileName) const;
 
+	// .--- Asynchronous resources
+	/** Start reading a resource in the background.
+	 *
+	 *  The resource is looked up right away, but it is read, decrypted and
+	 *  decompressed by a worker thread. AsyncResource::take() returns the stream.
+	 *
+	 *  @param  name The name (ResRef) of the resource.
+	 *  @param  type The resource's type.
+	 *  @return A handle to the resource being read.
+	 */
+	AsyncResourcePtr getResourceAsync(const Common::UString &name, FileType type) const;
+
+	/** Start reading a resource in the background.
+	 *
+	 *  Like getResource(), this only reads one resource, even if more than one
+	 *  of the specified file types exist for the given name.
+	 *
+	 *  @param  name The name (ResRef) of the resource.
+	 *  @param  types A list of file types to look for.
+	 *  @return A handle to the resource being read.
+	 */
+	AsyncResourcePtr getResourceAsync(const Common::UString &name, const std::vector<FileType> &types) const;
+
+	/** Read a resource into the resource cache in the background.
+	 *
+	 *  A later getResource() of this resource will then find it in the cache,
+	 *  unless it has been evicted again in the meantime. Resources that aren't
+	 *  cached (plain files that aren't "small") are ignored.
+	 *
+	 *  @param  name The name (ResRef) of the resource.
+	 *  @param  type The resource's type.
+	 */
+	void prefetch(const Common::UString &name, FileType type) const;
+
+	/** Read a resource into the resource cache in the background.
+	 *
+	 *  @param  name The name (ResRef) of the resource.
+	 *  @param  types A list of file types to look for.
+	 */
+	void prefetch(const Common::UString &name, const std::vector<FileType> &types) const;
+
+	/** Wait until all resources requested so far have been read. */
+	void waitForAsyncResources() const;
+	// '---
+
+	// .--- Resource cache
+	/** Set the maximum number of bytes of resource data kept in the cache.
+	 *
+	 *  Resources read from archives and compressed "small" files are kept in
+	 *  memory, so that repeatedly requesting them does not need to read,
+	 *  decrypt and decompress them again. 0 disables the cache.
+	 */
+	void setCacheSize(size_t size);
+
+	/** Return the maximum number of bytes of resource data kept in the cache. */
+	size_t getCacheSize() const;
+
+	/** Drop all resource data from the cache. */
+	void clearCache();
+
+	/** Return statistics about the resource cache usage. */
+	void getCacheStatistics(ResourceCache::Statistics &stats) const;
+	// '---
+
+	// .--- Resource index
+	/** Load a persistent index of archive contents from a file.
+	 *
+	 *  When indexing an archive file that's found in this index, and that hasn't
+	 *  changed since, the resource list is taken from the index instead of being
+	 *  read out of the archive. The archive itself is then only opened once one
+	 *  of its resources is requested.
+	 *
+	 *  @param  fileName The index file to load.
+	 *  @return true if the index was loaded, false otherwise.
+	 */
+	bool loadIndex(const Common::UString &fileName);
+
+	/** Save the persistent index of archive contents into a file.
+	 *
+	 *  The index contains all archive files indexed so far, plus all still valid
+	 *  entries of a previously loaded index. If nothing has changed since the
+	 *  index was loaded, the file is not written.
+	 */
+	void saveIndex(const Common::UString &fileName);
+	// '---
+
 
 private:
 	typedef std::vector<FileType> FileTypeList;
@@ -362,7 +498,7 @@ private:
 	};
 
 	struct OpenedArchive {
-		/** The actual archive. */
+		/** The actual archive, or 0 if it still needs to be opened. */
 		Archive *archive;
 
 		/** The information we know about this archive. */
@@ -375,13 +511,39 @@ private:
 
 		OpenedArchive();
 
-		void set(KnownArchive &kA, Archive &a);
+		void set(KnownArchive &kA, Archive *a);
 	};
 
 	/** List of all known archive files. */
 	typedef std::list<KnownArchive> KnownArchives;
 	/** List of all opened archive files. */
 	typedef std::list<OpenedArchive> OpenedArchives;
+
+	/** An archive of a batch, opened and parsed by a worker thread. */
+	struct ParsedArchive : boost::noncopyable {
+		KnownArchive *known;            ///< The archive to parse.
+		const ArchiveRequest *request;  ///< How the archive should be indexed.
+
+		bool parsed; ///< Was the archive parsed by a worker thread?
+		bool failed; ///< Did parsing the archive fail?
+
+		Common::Exception error; ///< The reason parsing the archive failed.
+		Common::Mutex mutex;     ///< Mutex protecting the error.
+
+		/** The parsed archive, unless this is a KEY. */
+		Common::ScopedPtr<Archive> archive;
+
+		// For KEY archives
+		Common::ScopedPtr<KEYFile>    key;         ///< The parsed KEY.
+		std::vector<Common::UString>  bifNames;    ///< The names of the KEY's BIFs.
+		std::vector<KnownArchive *>   bifArchives; ///< The KEY's BIFs.
+		Common::PtrVector<BIFFile>    bifs;        ///< The parsed BIFs.
+
+		ParsedArchive(KnownArchive &k, const ArchiveRequest &r);
+		~ParsedArchive();
+
+		void fail(const Common::Exception &e);
+	};
 	// '---
 
 	// .--- Resources
@@ -394,8 +556,9 @@ private:
 
 	/** A resource. */
 	struct Resource {
-		Common::UString name; ///< The resource's name.
+		const char     *name; ///< The resource's name, interned in the name arena.
 		FileType        type; ///< The resource's type.
+		uint64          hash; ///< The resource's hashed name and type.
 
 		/** Is this a "small" (compressed Nintendo DS) file? */
 		bool isSmall;
@@ -410,7 +573,7 @@ private:
 		Source source;
 
 		// For kSourceFile
-		Common::UString path; ///< The file's path.
+		const char *path; ///< The file's path, interned in the name arena.
 
 		// For kSourceArchive
 		OpenedArchive *archive;      ///< Pointer to the opened archive.
@@ -421,10 +584,8 @@ private:
 		bool operator<(const Resource &right) const;
 	};
 
-	/** List of resources, sorted by priority. */
-	typedef std::list<Resource> ResourceList;
-	/** Map over resources, indexed by their hashed name. */
-	typedef std::map<uint64, ResourceList> ResourceMap;
+	/** Map over resources, indexed by their hashed name, sorted by priority. */
+	typedef ResourceTable<Resource> ResourceMap;
 	// '---
 
 	// .--- Changes
@@ -434,13 +595,15 @@ private:
 	typedef OpenedArchives::iterator OpenedArchiveChange;
 	/** A change produced by indexing archive resources. */
 	struct ResourceChange {
-		ResourceMap::iterator  hashIt;
-		ResourceList::iterator resIt;
+		uint64    hash;     ///< The hash the resource was added under.
+		Resource *resource; ///< The added resource.
+
+		ResourceChange(uint64 h, Resource &r) : hash(h), resource(&r) { }
 	};
 
 	typedef std::list<KnownArchiveChange>  KnownArchiveChanges;
 	typedef std::list<OpenedArchiveChange> OpenedArchiveChanges;
-	typedef std::list<ResourceChange>      ResourceChanges;
+	typedef std::vector<ResourceChange>    ResourceChanges;
 
 	/** A set of changes produced by a manager operation. */
 	struct ChangeSet {
@@ -484,15 +647,35 @@ private:
 	KnownArchives  _knownArchives[kArchiveMAX]; ///< List of all known archives.
 	OpenedArchives _openedArchives;             ///< List of currently used archives.
 
+	/** Protects lazily opening indexed archives on first use. */
+	mutable Common::Mutex _archiveMutex;
+
 	/** The current type aliases, changing one type to another. */
 	std::map<FileType, FileType> _typeAliases;
 
 	ResourceMap   _resources; ///< All currently known resources.
 	ChangeSetList _changes;   ///< Changes produced by indexing the currently known resources.
 
+	uint32 _generation; ///< The generation of the known resources.
+
+	/** The interned names and paths of all known resources. */
+	Common::StringArena _names;
+
+	/** Recently used resource data. */
+	mutable ResourceCache _cache;
+
+	/** The persistent index of archive contents. */
+	ResourceIndex _index;
+
 	FileTypeSet  _archiveTypeTypes [kArchiveMAX];  ///< All valid archive types file types.
 	FileTypeList _resourceTypeTypes[kResourceMAX]; ///< All valid resource type file types.
 
+	/** Protects creating the worker threads. */
+	mutable Common::Mutex _threadPoolMutex;
+	/** The worker threads indexing archives and reading asynchronous resources.
+	 *  Destroyed before all other members. */
+	mutable Common::ScopedPtr<Common::ThreadPool> _threadPool;
+
 
 	void clearResources();
 
@@ -502,14 +685,36 @@ private:
 	// '---
 
 	// .--- Indexing archives
-	void indexKEY(Common::SeekableReadStream *stream, uint32 priority, Change *change);
-	uint32 openKEYBIFs(Common::SeekableReadStream *keyStream,
+	void indexArchive(KnownArchive &knownArchive, uint32 priority,
+	                  const std::vector<byte> &password, Change *change);
+
+	void indexKEY(KnownArchive &knownArchive, uint32 priority, Change *change);
+	uint32 openKEYBIFs(Common::SeekableReadStream *keyStream, std::vector<Common::UString> &names,
 	                   std::vector<KnownArchive *> &archives, std::vector<BIFFile *> &bifs);
+	void indexKEYBIFs(KnownArchive &knownArchive, const std::vector<Common::UString> &names,
+	                  const std::vector<KnownArchive *> &archives, std::vector<BIFFile *> &bifs,
+	                  uint32 priority, Change *change);
 
 	void indexArchive(KnownArchive &knownArchive, Archive *archive,
 	                  uint32 priority, Change *change);
+	void indexArchive(KnownArchive &knownArchive, Archive *archive,
+	                  const Archive::ResourceList &resources, Common::HashAlgo hashAlgo,
+	                  uint32 priority, Change *change);
+
+	bool indexArchiveFromIndex(KnownArchive &knownArchive, uint32 priority, Change *change);
+	bool hasIndexEntries(KnownArchive &knownArchive);
+	bool findIndexEntries(KnownArchive &knownArchive, std::vector<KnownArchive *> &archives,
+	                      std::vector<const ResourceIndex::Entry *> &entries);
+
+	bool isArchiveFile(const KnownArchive &knownArchive) const;
+	bool canIndex(const KnownArchive &knownArchive) const;
+
+	void parseArchive(ParsedArchive &archive, Common::ThreadPool &pool);
+	void parseKEYBIF(ParsedArchive &archive, size_t bif);
 
 	Common::SeekableReadStream *openArchiveStream(const KnownArchive &archive) const;
+	Archive *openArchive(const KnownArchive &knownArchive, const std::vector<byte> &password) const;
+	Archive &getArchive(OpenedArchive &archive) const;
 	// '---
 
 	// .--- Adding resources
@@ -532,6 +737,16 @@ private:
 	Common::SeekableReadStream *getArchiveResource(const Resource &res, bool tryNoCopy = false) const;
 
 	uint32 getResourceSize(const Resource &res) const;
+
+	static bool isCacheable(const Resource &res);
+	// '---
+
+	// .--- Asynchronous resources
+	/** Return the worker threads, creating them if necessary. */
+	Common::ThreadPool &getThreadPool() const;
+
+	Common::SeekableReadStream *readAsyncResource(const Resource *res) const;
+	void prefetchResource(const Resource *res) const;
 	// '---
 
 	// .--- Resource utility methods
@@ -544,7 +759,7 @@ private:
 	inline uint64 getHash(const Common::UString &name, FileType type) const;
 	inline uint64 getHash(const Common::UString &name) const;
 
-	void checkHashCollision(const Resource &resource, ResourceMap::const_iterator resList);
+	void checkHashCollision(const Resource &resource, const ResourceMap::Entry &resList);
 
 	Change *newChangeSet(Common::ChangeID &changeID);
 	// '---
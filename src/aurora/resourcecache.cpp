@@ -0,0 +1,208 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A memory-bounded cache of resource data.
+ */
+
+#include <cassert>
+
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/resourcecache.h"
+
+namespace Aurora {
+
+/** Resources bigger than this fraction of the cache capacity are never cached. */
+static const size_t kMaxEntryFraction = 4;
+
+/** A MemoryReadStream sharing a cached data buffer. */
+class CachedResourceStream : public Common::MemoryReadStream {
+public:
+	CachedResourceStream(const boost::shared_ptr<Common::MemoryReadStream> &data) :
+		Common::MemoryReadStream(data->getData(), data->size(), false), _data(data) {
+
+	}
+
+	~CachedResourceStream() {
+	}
+
+private:
+	boost::shared_ptr<Common::MemoryReadStream> _data;
+};
+
+
+ResourceCache::Statistics::Statistics() : hits(0), misses(0), evictions(0),
+	count(0), size(0), capacity(0) {
+
+}
+
+
+ResourceCache::ResourceCache(size_t capacity) {
+	_stats.capacity = capacity;
+}
+
+ResourceCache::~ResourceCache() {
+}
+
+size_t ResourceCache::getCapacity() const {
+	Common::StackLock lock(_mutex);
+
+	return _stats.capacity;
+}
+
+void ResourceCache::setCapacity(size_t capacity) {
+	Common::StackLock lock(_mutex);
+
+	_stats.capacity = capacity;
+
+	evict(0);
+}
+
+void ResourceCache::clear() {
+	Common::StackLock lock(_mutex);
+
+	_entryMap.clear();
+	_entries.clear();
+
+	_stats.count = 0;
+	_stats.size  = 0;
+}
+
+void ResourceCache::getStatistics(Statistics &stats) const {
+	Common::StackLock lock(_mutex);
+
+	stats = _stats;
+}
+
+void ResourceCache::resetStatistics() {
+	Common::StackLock lock(_mutex);
+
+	_stats.hits      = 0;
+	_stats.misses    = 0;
+	_stats.evictions = 0;
+}
+
+Common::SeekableReadStream *ResourceCache::get(uint64 hash, const void *tag) {
+	Common::StackLock lock(_mutex);
+
+	if (_stats.capacity == 0)
+		return 0;
+
+	EntryMap::iterator entry = _entryMap.find(hash);
+	if (entry == _entryMap.end()) {
+		_stats.misses++;
+		return 0;
+	}
+
+	// The name now refers to a different resource, the cached data is stale
+	if (entry->second->tag != tag) {
+		remove(entry);
+
+		_stats.misses++;
+		return 0;
+	}
+
+	// Move the entry to the front, marking it as the most recently used
+	_entries.splice(_entries.begin(), _entries, entry->second);
+
+	_stats.hits++;
+	return createStream(*entry->second);
+}
+
+Common::SeekableReadStream *ResourceCache::add(uint64 hash, const void *tag,
+                                               Common::SeekableReadStream *stream) {
+
+	assert(stream);
+
+	const size_t size = stream->size();
+	if ((size == 0) || (size == Common::SeekableReadStream::kSizeInvalid) ||
+	    (size > (getCapacity() / kMaxEntryFraction)))
+		return stream;
+
+	Entry newEntry;
+	newEntry.hash = hash;
+	newEntry.tag  = tag;
+	newEntry.size = size;
+
+	Common::MemoryReadStream *memStream = dynamic_cast<Common::MemoryReadStream *>(stream);
+	if (memStream) {
+		// Already in memory, just take the stream over
+		newEntry.data.reset(memStream);
+
+	} else {
+		Common::ScopedPtr<Common::SeekableReadStream> data(stream);
+		Common::ScopedArray<byte> buffer(new byte[size]);
+
+		if (data->readAt(0, buffer.get(), size) != size)
+			throw Common::Exception(Common::kReadError);
+
+		newEntry.data.reset(new Common::MemoryReadStream(buffer.release(), size, true));
+	}
+
+	// Only lock after reading, so that other threads can use the cache in the meantime
+	Common::StackLock lock(_mutex);
+
+	EntryMap::iterator oldEntry = _entryMap.find(hash);
+	if (oldEntry != _entryMap.end())
+		remove(oldEntry);
+
+	evict(size);
+
+	_entries.push_front(newEntry);
+	_entryMap.insert(std::make_pair(hash, _entries.begin()));
+
+	_stats.count++;
+	_stats.size += size;
+
+	return createStream(newEntry);
+}
+
+void ResourceCache::remove(EntryMap::iterator entry) {
+	assert(_stats.count > 0);
+	assert(_stats.size >= entry->second->size);
+
+	_stats.count--;
+	_stats.size -= entry->second->size;
+
+	_entries.erase(entry->second);
+	_entryMap.erase(entry);
+}
+
+void ResourceCache::evict(size_t size) {
+	// Remove the least recently used entries until we have enough room
+	while (!_entries.empty() && ((_stats.size + size) > _stats.capacity)) {
+		EntryMap::iterator entry = _entryMap.find(_entries.back().hash);
+		assert(entry != _entryMap.end());
+
+		remove(entry);
+
+		_stats.evictions++;
+	}
+}
+
+Common::SeekableReadStream *ResourceCache::createStream(const Entry &entry) {
+	return new CachedResourceStream(entry.data);
+}
+
+} // End of namespace Aurora
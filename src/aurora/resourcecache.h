@@ -0,0 +1,144 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A memory-bounded cache of resource data.
+ */
+
+#ifndef AURORA_RESOURCECACHE_H
+#define AURORA_RESOURCECACHE_H
+
+#include <list>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "src/common/types.h"
+#include "src/common/mutex.h"
+
+namespace Common {
+	class SeekableReadStream;
+	class MemoryReadStream;
+}
+
+namespace Aurora {
+
+/** A cache of fully read (and decompressed, and decrypted) resource data.
+ *
+ *  The cache holds at most capacity bytes of data. When adding a new resource
+ *  would exceed that budget, the least recently used resources are evicted.
+ *
+ *  Entries are identified by the hash of the resource name, together with an
+ *  opaque tag identifying the actual resource instance behind the name. That
+ *  way, a resource that is shadowed by another resource of higher priority
+ *  does not produce stale hits.
+ *
+ *  All streams handed out by the cache share the same, read-only data buffer.
+ *  A resource that has already been read into memory is kept as it is, any
+ *  other resource is read into memory once.
+ *  The buffer is kept alive for as long as any stream still references it,
+ *  even if the entry has been evicted in the meantime.
+ *
+ *  All methods may be called from several threads at once.
+ */
+class ResourceCache : boost::noncopyable {
+public:
+	/** Statistics about the cache's usage. */
+	struct Statistics {
+		uint64 hits;      ///< Number of successful lookups.
+		uint64 misses;    ///< Number of failed lookups.
+		uint64 evictions; ///< Number of entries evicted to make room.
+
+		size_t count;    ///< Number of entries currently in the cache.
+		size_t size;     ///< Number of bytes currently in the cache.
+		size_t capacity; ///< Maximum number of bytes in the cache.
+
+		Statistics();
+	};
+
+	/** Create a cache with this capacity, in bytes. 0 disables the cache. */
+	ResourceCache(size_t capacity = 0);
+	~ResourceCache();
+
+	/** Return the capacity of the cache, in bytes. */
+	size_t getCapacity() const;
+	/** Set the capacity of the cache, in bytes, evicting entries as necessary. 0 disables the cache. */
+	void setCapacity(size_t capacity);
+
+	/** Remove all entries from the cache. */
+	void clear();
+
+	/** Look up a resource.
+	 *
+	 *  @param  hash The hash of the name of the resource.
+	 *  @param  tag The resource instance behind the hash.
+	 *  @return A new stream of the resource's data, or 0 if the resource is not cached.
+	 */
+	Common::SeekableReadStream *get(uint64 hash, const void *tag);
+
+	/** Add a resource to the cache.
+	 *
+	 *  Takes over the stream and reads all of its data. If the resource is too
+	 *  big to be cached at all, the stream is returned unchanged instead.
+	 *
+	 *  @param  hash The hash of the name of the resource.
+	 *  @param  tag The resource instance behind the hash.
+	 *  @param  stream The stream of the resource.
+	 *  @return A new stream of the resource's data.
+	 */
+	Common::SeekableReadStream *add(uint64 hash, const void *tag, Common::SeekableReadStream *stream);
+
+	/** Return the statistics about the cache's usage. */
+	void getStatistics(Statistics &stats) const;
+	/** Reset the hit, miss and eviction counters. */
+	void resetStatistics();
+
+private:
+	struct Entry {
+		uint64      hash;
+		const void *tag;
+
+		/** The stream holding the resource data in memory, shared with all streams handed out. */
+		boost::shared_ptr<Common::MemoryReadStream> data;
+		size_t size;
+	};
+
+	/** All entries, the least recently used at the end. */
+	typedef std::list<Entry> EntryList;
+	/** Index into the entry list, by hash. */
+	typedef std::map<uint64, EntryList::iterator> EntryMap;
+
+	EntryList _entries;
+	EntryMap  _entryMap;
+
+	Statistics _stats;
+
+	mutable Common::Mutex _mutex;
+
+	void remove(EntryMap::iterator entry);
+	void evict(size_t size);
+
+	static Common::SeekableReadStream *createStream(const Entry &entry);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_RESOURCECACHE_H
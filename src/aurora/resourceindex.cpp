@@ -0,0 +1,234 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A persistent index of the contents of archive files.
+ */
+
+#include <cstring>
+
+#include "src/common/scopedptr.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/endianness.h"
+#include "src/common/filepath.h"
+#include "src/common/readfile.h"
+#include "src/common/writefile.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/resourceindex.h"
+
+static const uint32 kIndexID      = MKTAG('X', 'R', 'I', 'X');
+static const uint32 kIndexVersion = 1;
+
+namespace Aurora {
+
+static Common::UString readIndexString(Common::MemoryReadStream &stream) {
+	const uint32 length = stream.readUint32LE();
+	if (length > (stream.size() - stream.pos()))
+		throw Common::Exception(Common::kReadError);
+
+	const char *data = reinterpret_cast<const char *>(stream.getData() + stream.pos());
+	stream.skip(length);
+
+	return Common::UString(data, length);
+}
+
+static void writeIndexString(Common::WriteStream &stream, const Common::UString &str) {
+	const uint32 length = std::strlen(str.c_str());
+
+	stream.writeUint32LE(length);
+	stream.write(str.c_str(), length);
+}
+
+/** Make sure the stream holds at least count records of (at least) size bytes. */
+static uint32 checkIndexCount(Common::MemoryReadStream &stream, uint32 count, size_t size) {
+	if (count > ((stream.size() - stream.pos()) / size))
+		throw Common::Exception(Common::kReadError);
+
+	return count;
+}
+
+
+ResourceIndex::Entry::Entry() : size(0), time(0), hashAlgo(Common::kHashNone) {
+}
+
+
+ResourceIndex::ResourceIndex() : _modified(false) {
+}
+
+ResourceIndex::~ResourceIndex() {
+}
+
+void ResourceIndex::clear() {
+	_entries.clear();
+
+	_modified = false;
+}
+
+bool ResourceIndex::isModified() const {
+	return _modified;
+}
+
+bool ResourceIndex::load(const Common::UString &fileName) {
+	clear();
+
+	if (!Common::FilePath::isRegularFile(fileName))
+		return false;
+
+	try {
+		// Read the whole index in one go
+		Common::ScopedPtr<Common::MemoryReadStream> stream;
+		{
+			Common::ReadFile file(fileName);
+			stream.reset(file.readStream(file.size()));
+		}
+
+		if ((stream->readUint32BE() != kIndexID) || (stream->readUint32LE() != kIndexVersion))
+			throw Common::Exception("Not a resource index file");
+
+		const uint32 entryCount = checkIndexCount(*stream, stream->readUint32LE(), 32);
+		for (uint32 i = 0; i < entryCount; i++) {
+			const Common::UString path = readIndexString(*stream);
+
+			Entry &entry = _entries[path];
+
+			entry.size     = stream->readUint64LE();
+			entry.time     = (std::time_t) stream->readSint64LE();
+			entry.hashAlgo = (Common::HashAlgo) stream->readSint32LE();
+
+			if ((entry.hashAlgo < Common::kHashNone) || (entry.hashAlgo >= Common::kHashMAX))
+				throw Common::Exception("Invalid hash algorithm %d", (int) entry.hashAlgo);
+
+			const uint32 archiveCount = checkIndexCount(*stream, stream->readUint32LE(), 4);
+			entry.archives.resize(archiveCount);
+
+			for (uint32 j = 0; j < archiveCount; j++)
+				entry.archives[j] = readIndexString(*stream);
+
+			const uint32 resourceCount = checkIndexCount(*stream, stream->readUint32LE(), 20);
+			for (uint32 j = 0; j < resourceCount; j++) {
+				entry.resources.push_back(Archive::Resource());
+				Archive::Resource &res = entry.resources.back();
+
+				res.name  = readIndexString(*stream);
+				res.hash  = stream->readUint64LE();
+				res.type  = (FileType) stream->readUint32LE();
+				res.index = stream->readUint32LE();
+			}
+		}
+
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed to load resource index \"%s\"", fileName.c_str());
+
+		clear();
+		return false;
+	}
+
+	_modified = false;
+	return true;
+}
+
+void ResourceIndex::save(const Common::UString &fileName) {
+	// Drop stale entries
+	for (EntryMap::iterator e = _entries.begin(); e != _entries.end(); ) {
+		if (!isValid(e->first, e->second))
+			_entries.erase(e++);
+		else
+			++e;
+	}
+
+	Common::WriteFile file;
+	if (!file.open(fileName))
+		throw Common::Exception(Common::kOpenError);
+
+	file.writeUint32BE(kIndexID);
+	file.writeUint32LE(kIndexVersion);
+
+	file.writeUint32LE(_entries.size());
+	for (EntryMap::const_iterator e = _entries.begin(); e != _entries.end(); ++e) {
+		writeIndexString(file, e->first);
+
+		file.writeUint64LE(e->second.size);
+		file.writeSint64LE((int64) e->second.time);
+		file.writeSint32LE((int32) e->second.hashAlgo);
+
+		file.writeUint32LE(e->second.archives.size());
+		for (std::vector<Common::UString>::const_iterator a = e->second.archives.begin();
+		     a != e->second.archives.end(); ++a)
+			writeIndexString(file, *a);
+
+		file.writeUint32LE(e->second.resources.size());
+		for (Archive::ResourceList::const_iterator r = e->second.resources.begin();
+		     r != e->second.resources.end(); ++r) {
+
+			writeIndexString(file, r->name);
+			file.writeUint64LE(r->hash);
+			file.writeUint32LE((uint32) r->type);
+			file.writeUint32LE(r->index);
+		}
+	}
+
+	file.flush();
+	file.close();
+
+	_modified = false;
+}
+
+const ResourceIndex::Entry *ResourceIndex::find(const Common::UString &path) const {
+	EntryMap::const_iterator e = _entries.find(path);
+	if ((e == _entries.end()) || !isValid(e->first, e->second))
+		return 0;
+
+	return &e->second;
+}
+
+void ResourceIndex::add(const Common::UString &path, Common::HashAlgo hashAlgo,
+                        const Archive::ResourceList &resources,
+                        const std::vector<Common::UString> &archives) {
+
+	if (!Common::FilePath::isRegularFile(path))
+		return;
+
+	const size_t      size = Common::FilePath::getFileSize(path);
+	const std::time_t time = Common::FilePath::getModificationTime(path);
+	if ((size == Common::kFileInvalid) || (time == ((std::time_t) -1)))
+		return;
+
+	Entry &entry = _entries[path];
+
+	entry.size      = size;
+	entry.time      = time;
+	entry.hashAlgo  = hashAlgo;
+	entry.resources = resources;
+	entry.archives  = archives;
+
+	_modified = true;
+}
+
+bool ResourceIndex::isValid(const Common::UString &path, const Entry &entry) {
+	if (!Common::FilePath::isRegularFile(path))
+		return false;
+
+	return (Common::FilePath::getFileSize(path)         == entry.size) &&
+	       (Common::FilePath::getModificationTime(path) == entry.time);
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,128 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A persistent index of the contents of archive files.
+ */
+
+#ifndef AURORA_RESOURCEINDEX_H
+#define AURORA_RESOURCEINDEX_H
+
+#include <vector>
+#include <map>
+#include <ctime>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/hash.h"
+
+#include "src/aurora/archive.h"
+
+namespace Aurora {
+
+/** An index of the resource lists of archive files, that can be saved to and
+ *  loaded from disk.
+ *
+ *  Reading the resource lists of all archives of a game means parsing the
+ *  headers of hundreds of files, which is a substantial part of the startup
+ *  time. The index remembers these lists, so that the next time an archive
+ *  is indexed, its resource list can be taken from the index instead.
+ *
+ *  Each entry is keyed by the path of the archive file and is only valid
+ *  while the size and modification time of the file stay the same. Entries
+ *  of files that changed are ignored and will be replaced once the archive
+ *  has been indexed again.
+ */
+class ResourceIndex : boost::noncopyable {
+public:
+	/** The index information of one archive file. */
+	struct Entry {
+		uint64      size; ///< The size of the archive file.
+		std::time_t time; ///< The modification time of the archive file.
+
+		/** The algorithm with which the resource names are hashed. */
+		Common::HashAlgo hashAlgo;
+
+		/** The resources within the archive. */
+		Archive::ResourceList resources;
+
+		/** Names of other archive files this archive depends on, as it references them (the BIFs of a KEY). */
+		std::vector<Common::UString> archives;
+
+		Entry();
+	};
+
+	ResourceIndex();
+	~ResourceIndex();
+
+	/** Remove all entries from the index. */
+	void clear();
+
+	/** Does the index contain entries that haven't been saved yet? */
+	bool isModified() const;
+
+	/** Load the index from a file, replacing all current entries.
+	 *
+	 *  @param  fileName The file to read.
+	 *  @return true if the index was loaded, false if the file
+	 *          doesn't exist or was not a valid index file.
+	 */
+	bool load(const Common::UString &fileName);
+
+	/** Save the index into a file.
+	 *
+	 *  Entries of archive files that don't exist anymore or have changed
+	 *  are dropped.
+	 */
+	void save(const Common::UString &fileName);
+
+	/** Find the entry of an archive file.
+	 *
+	 *  @param  path The path of the archive file.
+	 *  @return The entry, or 0 if there is none or the file has changed since.
+	 */
+	const Entry *find(const Common::UString &path) const;
+
+	/** Add the entry of an archive file, replacing an existing one.
+	 *
+	 *  @param path The path of the archive file.
+	 *  @param hashAlgo The algorithm with which the resource names are hashed.
+	 *  @param resources The resources within the archive.
+	 *  @param archives Names of other archive files this archive depends on, as it references them.
+	 */
+	void add(const Common::UString &path, Common::HashAlgo hashAlgo,
+	         const Archive::ResourceList &resources,
+	         const std::vector<Common::UString> &archives = std::vector<Common::UString>());
+
+private:
+	typedef std::map<Common::UString, Entry> EntryMap;
+
+	EntryMap _entries;
+
+	bool _modified;
+
+	static bool isValid(const Common::UString &path, const Entry &entry);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_RESOURCEINDEX_H
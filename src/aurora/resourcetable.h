@@ -0,0 +1,406 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A hash table of resources, with candidates ordered by priority.
+ */
+
+#ifndef AURORA_RESOURCETABLE_H
+#define AURORA_RESOURCETABLE_H
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+
+namespace Aurora {
+
+/** A hash table of resources, indexed by the hash of their names.
+ *
+ *  The table uses open addressing with linear probing over a single flat
+ *  array of slots. Each slot holds all resources sharing the same hash,
+ *  sorted by ascending priority. The first two of those candidates are
+ *  stored inline, within the slot; only hashes with more candidates need
+ *  an extra candidate array.
+ *
+ *  The resources themselves are allocated from memory pools owned by the
+ *  table. A resource keeps its address until it is removed from the table,
+ *  no matter how many other resources are added or removed.
+ *
+ *  T needs to have a uint32 member called priority.
+ */
+template<typename T>
+class ResourceTable : boost::noncopyable {
+public:
+	/** All resources sharing the same hash. */
+	class Entry {
+	public:
+		/** Return the hash all these resources share. */
+		uint64 getHash() const {
+			return _hash;
+		}
+
+		/** Return the number of resources with this hash. */
+		size_t size() const {
+			return _count;
+		}
+
+		/** Return a resource, with 0 being the lowest priority. */
+		T &operator[](size_t i) const {
+			assert(i < _count);
+			return *getCandidates()[i];
+		}
+
+		/** Return the resource with the lowest priority. */
+		T &front() const {
+			return (*this)[0];
+		}
+
+		/** Return the resource with the highest priority. */
+		T &back() const {
+			return (*this)[_count - 1];
+		}
+
+	private:
+		static const size_t kInlineCount = 2;
+
+		uint64 _hash;     ///< The hash all these resources share.
+		uint32 _count;    ///< The number of resources. 0 if this slot is empty.
+		uint32 _capacity; ///< Capacity of the candidates array, if not inline.
+
+		union {
+			T  *_inline[kInlineCount]; ///< The candidates, if there are few enough.
+			T **_candidates;           ///< The candidates, if there are too many to keep inline.
+		};
+
+		T * const *getCandidates() const {
+			return (_count <= kInlineCount) ? _inline : _candidates;
+		}
+
+		friend class ResourceTable;
+	};
+
+	/** Iterator over all entries in the table, in no particular order. */
+	class const_iterator {
+	public:
+		const Entry &operator*() const {
+			return _table->_slots[_slot];
+		}
+
+		const Entry *operator->() const {
+			return &_table->_slots[_slot];
+		}
+
+		const_iterator &operator++() {
+			_slot++;
+			skipEmpty();
+
+			return *this;
+		}
+
+		bool operator==(const const_iterator &it) const {
+			return (_table == it._table) && (_slot == it._slot);
+		}
+
+		bool operator!=(const const_iterator &it) const {
+			return !(*this == it);
+		}
+
+	private:
+		const ResourceTable *_table;
+		size_t _slot;
+
+		const_iterator(const ResourceTable &table, size_t slot) : _table(&table), _slot(slot) {
+			skipEmpty();
+		}
+
+		void skipEmpty() {
+			while ((_slot < _table->_slots.size()) && (_table->_slots[_slot]._count == 0))
+				_slot++;
+		}
+
+		friend class ResourceTable;
+	};
+
+
+	ResourceTable() : _entryCount(0), _resourceCount(0), _chunkFree(0) {
+	}
+
+	~ResourceTable() {
+		clear();
+	}
+
+	/** Remove all resources. */
+	void clear() {
+		for (typename std::vector<Entry>::iterator e = _slots.begin(); e != _slots.end(); ++e) {
+			for (size_t i = 0; i < e->_count; i++)
+				(*e)[i].~T();
+
+			if (e->_count > Entry::kInlineCount)
+				delete[] e->_candidates;
+		}
+
+		for (typename std::vector<void *>::iterator c = _chunks.begin(); c != _chunks.end(); ++c)
+			::operator delete(*c);
+
+		_slots.clear();
+		_chunks.clear();
+		_free.clear();
+
+		_entryCount    = 0;
+		_resourceCount = 0;
+		_chunkFree     = 0;
+	}
+
+	/** Are there no resources in the table? */
+	bool empty() const {
+		return _entryCount == 0;
+	}
+
+	/** Return the number of distinct hashes in the table. */
+	size_t size() const {
+		return _entryCount;
+	}
+
+	/** Return the number of resources in the table. */
+	size_t getResourceCount() const {
+		return _resourceCount;
+	}
+
+	const_iterator begin() const {
+		return const_iterator(*this, 0);
+	}
+
+	const_iterator end() const {
+		return const_iterator(*this, _slots.size());
+	}
+
+	/** Return all resources with this hash, or 0 if there are none. */
+	const Entry *find(uint64 hash) const {
+		if (_slots.empty())
+			return 0;
+
+		const Entry &entry = _slots[findSlot(hash)];
+
+		return (entry._count != 0) ? &entry : 0;
+	}
+
+	/** Add a copy of this resource with this hash.
+	 *
+	 *  The new resource is placed after all resources of the same hash with
+	 *  a lower or equal priority.
+	 *
+	 *  @return The table's copy of the resource.
+	 */
+	T &add(uint64 hash, const T &resource) {
+		// Keep the table at most half full
+		if (((_entryCount + 1) * 2) > _slots.size())
+			grow();
+
+		Entry &entry = _slots[findSlot(hash)];
+		if (entry._count == 0) {
+			entry._hash = hash;
+			_entryCount++;
+		}
+
+		T *res = new (allocate()) T(resource);
+		_resourceCount++;
+
+		insertCandidate(entry, res);
+
+		return *res;
+	}
+
+	/** Remove this resource, previously added with this hash, from the table. */
+	void remove(uint64 hash, T &resource) {
+		if (_slots.empty())
+			return;
+
+		const size_t slot = findSlot(hash);
+
+		Entry &entry = _slots[slot];
+		if (!removeCandidate(entry, &resource))
+			return;
+
+		resource.~T();
+		_free.push_back(&resource);
+		_resourceCount--;
+
+		if (entry._count == 0) {
+			eraseSlot(slot);
+			_entryCount--;
+		}
+	}
+
+private:
+	/** Number of resources in one memory pool chunk. */
+	static const size_t kChunkSize = 1024;
+
+	std::vector<Entry> _slots; ///< The hash table slots.
+
+	size_t _entryCount;    ///< Number of used slots.
+	size_t _resourceCount; ///< Number of resources in all slots.
+
+	std::vector<void *> _chunks; ///< Memory pool chunks holding the resources.
+	std::vector<T *>    _free;   ///< Memory of removed resources, ready for reuse.
+
+	size_t _chunkFree; ///< Number of unused resources in the last chunk.
+
+	friend class const_iterator;
+
+	static size_t getHome(uint64 hash, size_t mask) {
+		// Mix the upper bits into the lower ones, in case the hash is weak there
+		hash ^= hash >> 33;
+		hash *= UINT64_C(0xFF51AFD7ED558CCD);
+		hash ^= hash >> 33;
+
+		return (size_t) hash & mask;
+	}
+
+	/** Find the slot holding this hash, or the empty slot where it would go. */
+	size_t findSlot(uint64 hash) const {
+		const size_t mask = _slots.size() - 1;
+
+		size_t slot = getHome(hash, mask);
+		while ((_slots[slot]._count != 0) && (_slots[slot]._hash != hash))
+			slot = (slot + 1) & mask;
+
+		return slot;
+	}
+
+	void grow() {
+		Entry empty;
+		std::memset(&empty, 0, sizeof(empty));
+
+		std::vector<Entry> slots(MAX<size_t>(_slots.size() * 2, 1024), empty);
+		_slots.swap(slots);
+
+		for (typename std::vector<Entry>::const_iterator e = slots.begin(); e != slots.end(); ++e)
+			if (e->_count != 0)
+				_slots[findSlot(e->_hash)] = *e;
+	}
+
+	/** Empty this slot, shifting back later slots of the same probe sequence. */
+	void eraseSlot(size_t slot) {
+		const size_t mask = _slots.size() - 1;
+
+		for (size_t next = (slot + 1) & mask; _slots[next]._count != 0; next = (next + 1) & mask) {
+			const size_t home = getHome(_slots[next]._hash, mask);
+
+			// Does the entry in next still need to be found when probing from its home?
+			const bool reachable = (slot <= next) ? ((home > slot) && (home <= next))
+			                                      : ((home > slot) || (home <= next));
+			if (reachable)
+				continue;
+
+			_slots[slot] = _slots[next];
+			slot = next;
+		}
+
+		_slots[slot]._count = 0;
+	}
+
+	T *allocate() {
+		if (!_free.empty()) {
+			T *res = _free.back();
+			_free.pop_back();
+
+			return res;
+		}
+
+		if (_chunkFree == 0) {
+			_chunks.push_back(::operator new(kChunkSize * sizeof(T)));
+			_chunkFree = kChunkSize;
+		}
+
+		return reinterpret_cast<T *>(_chunks.back()) + (kChunkSize - _chunkFree--);
+	}
+
+	static void insertCandidate(Entry &entry, T *res) {
+		// Find the position after all candidates of lower or equal priority
+		size_t pos = entry._count;
+		while ((pos > 0) && (entry[pos - 1].priority > res->priority))
+			pos--;
+
+		if (entry._count < Entry::kInlineCount) {
+			std::memmove(entry._inline + pos + 1, entry._inline + pos, (entry._count - pos) * sizeof(T *));
+
+			entry._inline[pos] = res;
+			entry._count++;
+			return;
+		}
+
+		if (entry._count == Entry::kInlineCount) {
+			// Move the candidates out of the slot
+
+			T **candidates = new T *[2 * Entry::kInlineCount];
+			std::memcpy(candidates, entry._inline, Entry::kInlineCount * sizeof(T *));
+
+			entry._candidates = candidates;
+			entry._capacity   = 2 * Entry::kInlineCount;
+
+		} else if (entry._count == entry._capacity) {
+			T **candidates = new T *[2 * entry._capacity];
+			std::memcpy(candidates, entry._candidates, entry._count * sizeof(T *));
+
+			delete[] entry._candidates;
+
+			entry._candidates = candidates;
+			entry._capacity  *= 2;
+		}
+
+		std::memmove(entry._candidates + pos + 1, entry._candidates + pos, (entry._count - pos) * sizeof(T *));
+
+		entry._candidates[pos] = res;
+		entry._count++;
+	}
+
+	static bool removeCandidate(Entry &entry, T *res) {
+		T **candidates = (entry._count <= Entry::kInlineCount) ? entry._inline : entry._candidates;
+
+		size_t pos = 0;
+		while ((pos < entry._count) && (candidates[pos] != res))
+			pos++;
+
+		if (pos == entry._count)
+			return false;
+
+		std::memmove(candidates + pos, candidates + pos + 1, (entry._count - pos - 1) * sizeof(T *));
+		entry._count--;
+
+		if (entry._count == Entry::kInlineCount) {
+			// Move the remaining candidates back into the slot
+
+			std::memcpy(entry._inline, candidates, Entry::kInlineCount * sizeof(T *));
+			delete[] candidates;
+		}
+
+		return true;
+	}
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_RESOURCETABLE_H
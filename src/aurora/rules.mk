@@ -37,6 +37,10 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/ndsrom.h \
     src/aurora/zipfile.h \
     src/aurora/resman.h \
+    src/aurora/resourcecache.h \
+    src/aurora/resourceindex.h \
+    src/aurora/resourcetable.h \
+    src/aurora/asyncresource.h \
     src/aurora/talktable.h \
     src/aurora/talktable_tlk.h \
     src/aurora/talktable_gff.h \
@@ -45,6 +49,8 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/2dafile.h \
     src/aurora/gdafile.h \
     src/aurora/gdaheaders.h \
+    src/aurora/columnindex.h \
+    src/aurora/2dasnapshot.h \
     src/aurora/2dareg.h \
     src/aurora/locstring.h \
     src/aurora/gff3file.h \
@@ -75,6 +81,9 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/ndsrom.cpp \
     src/aurora/zipfile.cpp \
     src/aurora/resman.cpp \
+    src/aurora/resourcecache.cpp \
+    src/aurora/resourceindex.cpp \
+    src/aurora/asyncresource.cpp \
     src/aurora/talktable.cpp \
     src/aurora/talktable_tlk.cpp \
     src/aurora/talktable_gff.cpp \
@@ -83,6 +92,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/2dafile.cpp \
     src/aurora/gdafile.cpp \
     src/aurora/gdaheaders.cpp \
+    src/aurora/2dasnapshot.cpp \
     src/aurora/2dareg.cpp \
     src/aurora/locstring.cpp \
     src/aurora/gff3file.cpp \
@@ -22,6 +22,8 @@
  *  The global talk manager for Aurora strings.
  */
 
+#include <map>
+
 #include "src/common/scopedptr.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
@@ -127,7 +129,7 @@ void TalkManager::removeTable(Common::ChangeID &changeID) {
 }
 
 static const Common::UString kEmptyString = "";
-const Common::UString &TalkManager::getString(uint32 strRef, LanguageGender gender) {
+Common::UString TalkManager::getString(uint32 strRef, LanguageGender gender) {
 	if (gender == kLanguageGenderCurrent)
 		gender = LangMan.getCurrentGender();
 
@@ -155,6 +157,28 @@ const Common::UString &TalkManager::getSoundResRef(uint32 strRef, LanguageGender
 	return table->getSoundResRef(strRef);
 }
 
+void TalkManager::prefetch(const std::vector<uint32> &strRefs, LanguageGender gender) {
+	if (gender == kLanguageGenderCurrent)
+		gender = LangMan.getCurrentGender();
+
+	// Sort the StrRefs by the talk table that holds them
+
+	typedef std::map<const TalkTable *, std::vector<uint32> > TableStrRefs;
+	TableStrRefs tableStrRefs;
+
+	for (std::vector<uint32>::const_iterator s = strRefs.begin(); s != strRefs.end(); ++s) {
+		if (*s == kStrRefInvalid)
+			continue;
+
+		const TalkTable *table = find(*s, gender);
+		if (table)
+			tableStrRefs[table].push_back(*s);
+	}
+
+	for (TableStrRefs::const_iterator t = tableStrRefs.begin(); t != tableStrRefs.end(); ++t)
+		t->first->prefetch(t->second);
+}
+
 const TalkTable *TalkManager::find(const Tables &tables, uint32 strRef, LanguageGender gender) const {
 	/* Look for the strRef in decreasing priority.
 	 *
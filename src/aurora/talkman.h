@@ -26,6 +26,7 @@
 #define AURORA_TALKMAN_H
 
 #include <list>
+#include <vector>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
@@ -60,9 +61,16 @@ public:
 	/** Remove a talk table from the talk manager again. */
 	void removeTable(Common::ChangeID &changeID);
 
-	const Common::UString &getString     (uint32 strRef, LanguageGender gender = kLanguageGenderCurrent);
+	Common::UString        getString     (uint32 strRef, LanguageGender gender = kLanguageGenderCurrent);
 	const Common::UString &getSoundResRef(uint32 strRef, LanguageGender gender = kLanguageGenderCurrent);
 
+	/** Decode these strings in advance, for example all lines of a dialog.
+	 *
+	 *  This can be done in a different thread than the one later getting
+	 *  the strings, to take the cost of decoding off that thread.
+	 */
+	void prefetch(const std::vector<uint32> &strRefs, LanguageGender gender = kLanguageGenderCurrent);
+
 private:
 	struct Table {
 		uint32 id;
@@ -42,6 +42,9 @@ TalkTable::TalkTable(Common::Encoding encoding) : _encoding(encoding) {
 TalkTable::~TalkTable() {
 }
 
+void TalkTable::prefetch(const std::vector<uint32> &UNUSED(strRefs)) const {
+}
+
 TalkTable *TalkTable::load(Common::SeekableReadStream *tlk, Common::Encoding encoding) {
 	Common::ScopedPtr<Common::SeekableReadStream> tlkStream(tlk);
 	if (!tlkStream)
@@ -25,13 +25,15 @@
 #ifndef AURORA_TALKTABLE_H
 #define AURORA_TALKTABLE_H
 
+#include <vector>
+
 #include <boost/noncopyable.hpp>
 
 #include "src/common/types.h"
+#include "src/common/ustring.h"
 #include "src/common/encoding.h"
 
 namespace Common {
-	class UString;
 	class SeekableReadStream;
 }
 
@@ -46,6 +48,9 @@ namespace Aurora {
  *  (and for a single gender of the PC), and commonly all strings for
  *  a given context (module, campaign, ...).
  *
+ *  Strings are returned by value, and talk tables are safe to be read
+ *  from several threads at once.
+ *
  *  See classes TalkTable_TLK and TalkTable_GFF for the two main
  *  formats a talk table can be found in.
  */
@@ -55,9 +60,12 @@ public:
 
 	virtual bool hasEntry(uint32 strRef) const = 0;
 
-	virtual const Common::UString &getString     (uint32 strRef) const = 0;
+	virtual Common::UString        getString     (uint32 strRef) const = 0;
 	virtual const Common::UString &getSoundResRef(uint32 strRef) const = 0;
 
+	/** Decode these strings in advance, so that later getString() calls for them are cheap. */
+	virtual void prefetch(const std::vector<uint32> &strRefs) const;
+
 	virtual uint32 getSoundID(uint32 strRef) const = 0;
 
 	/** Take over this stream and read a talk table (of either format) out of it. */
@@ -55,11 +55,13 @@ bool TalkTable_GFF::hasEntry(uint32 strRef) const {
 }
 
 static const Common::UString kEmptyString = "";
-const Common::UString &TalkTable_GFF::getString(uint32 strRef) const {
+Common::UString TalkTable_GFF::getString(uint32 strRef) const {
 	Entries::iterator e = _entries.find(strRef);
 	if (e == _entries.end())
 		return kEmptyString;
 
+	Common::StackLock lock(_mutex);
+
 	readString(*e->second);
 
 	return e->second->text;
@@ -31,6 +31,7 @@
 #include "src/common/scopedptr.h"
 #include "src/common/ptrmap.h"
 #include "src/common/ustring.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/talktable.h"
@@ -59,7 +60,7 @@ public:
 
 	bool hasEntry(uint32 strRef) const;
 
-	const Common::UString &getString     (uint32 strRef) const;
+	Common::UString        getString     (uint32 strRef) const;
 	const Common::UString &getSoundResRef(uint32 strRef) const;
 
 	uint32 getSoundID(uint32 strRef) const;
@@ -81,6 +82,9 @@ private:
 
 	mutable Entries _entries;
 
+	/** Guarding the lazy decoding of the strings, which reads from the GFF4. */
+	mutable Common::Mutex _mutex;
+
 	void load(Common::SeekableReadStream *tlk);
 	void load02(const GFF4Struct &top);
 	void load05(const GFF4Struct &top);
@@ -27,6 +27,7 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include "src/common/util.h"
 #include "src/common/strutil.h"
@@ -44,7 +45,7 @@ static const uint32 kVersion4 = MKTAG('V', '4', '.', '0');
 namespace Aurora {
 
 TalkTable_TLK::TalkTable_TLK(Common::SeekableReadStream *tlk, Common::Encoding encoding) :
-	TalkTable(encoding), _tlk(tlk) {
+	TalkTable(encoding), _tlk(tlk), _data(0), _size(0) {
 
 	assert(_tlk);
 
@@ -85,6 +86,20 @@ void TalkTable_TLK::load() {
 		else
 			readEntryTableV4();
 
+		// Keep the whole file in memory, so that we can decode the strings directly out of it
+		Common::MemoryReadStream *memory = dynamic_cast<Common::MemoryReadStream *>(_tlk.get());
+		if (!memory) {
+			_tlk->seek(0);
+			_tlk.reset(_tlk->readStream(_tlk->size()));
+
+			memory = dynamic_cast<Common::MemoryReadStream *>(_tlk.get());
+		}
+
+		assert(memory);
+
+		_data = memory->getData();
+		_size = memory->size();
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading TLK file");
 		throw;
@@ -113,26 +128,63 @@ void TalkTable_TLK::readEntryTableV4() {
 	}
 }
 
-void TalkTable_TLK::readString(Entry &entry) const {
-	if (!entry.text.empty() || (entry.length == 0) || !(entry.flags & kFlagTextPresent))
-		// We already have the string
-		return;
+Common::UString TalkTable_TLK::readString(const Entry &entry) const {
+	/* This only reads from the raw TLK data, which never changes after
+	 * loading, so this is safe to be called from several threads at once. */
 
-	assert(_tlk);
+	if ((entry.length == 0) || !(entry.flags & kFlagTextPresent) || (entry.offset >= _size))
+		return "";
+
+	const byte  *data   = _data + entry.offset;
+	const size_t length = MIN<size_t>(entry.length, _size - entry.offset);
+
+	if (_encoding == Common::kEncodingInvalid)
+		return "[???]";
+
+	/* Most strings don't contain any color codes. If the encoding also
+	 * uses single bytes as code units, we can then directly decode the
+	 * string up to its terminator, without copying it into streams first. */
 
-	_tlk->seek(entry.offset);
+	const bool isUTF16 = (_encoding == Common::kEncodingUTF16LE) || (_encoding == Common::kEncodingUTF16BE);
+	if (!isUTF16 && !std::memchr(data, '<', length)) {
+		const byte *end = reinterpret_cast<const byte *>(std::memchr(data, '\0', length));
+
+		return Common::readString(data, end ? (end - data) : length, _encoding);
+	}
+
+	Common::MemoryReadStream raw(data, length);
+	Common::ScopedPtr<Common::MemoryReadStream> parsed(LangMan.preParseColorCodes(raw));
+
+	return Common::readString(*parsed, _encoding);
+}
+
+const Common::UString *TalkTable_TLK::findCached(uint32 strRef) const {
+	Cache::iterator cached = _cache.find(strRef);
+	if (cached == _cache.end())
+		return 0;
+
+	_cacheOrder.splice(_cacheOrder.begin(), _cacheOrder, cached->second.order);
+
+	return &cached->second.text;
+}
 
-	uint32 length = MIN<size_t>(entry.length, _tlk->size() - _tlk->pos());
-	if (length == 0)
+void TalkTable_TLK::addCached(uint32 strRef, const Common::UString &text) const {
+	std::pair<Cache::iterator, bool> result = _cache.insert(std::make_pair(strRef, CachedString()));
+	if (!result.second) {
+		// Another thread was faster in decoding this string
+		_cacheOrder.splice(_cacheOrder.begin(), _cacheOrder, result.first->second.order);
 		return;
+	}
+
+	_cacheOrder.push_front(strRef);
 
-	Common::ScopedPtr<Common::MemoryReadStream> data(_tlk->readStream(length));
-	Common::ScopedPtr<Common::MemoryReadStream> parsed(LangMan.preParseColorCodes(*data));
+	result.first->second.text  = text;
+	result.first->second.order = _cacheOrder.begin();
 
-	if (_encoding != Common::kEncodingInvalid)
-		entry.text = Common::readString(*parsed, _encoding);
-	else
-		entry.text = "[???]";
+	if (_cache.size() > kMaxCachedStrings) {
+		_cache.erase(_cacheOrder.back());
+		_cacheOrder.pop_back();
+	}
 }
 
 uint32 TalkTable_TLK::getLanguageID() const {
@@ -144,13 +196,52 @@ bool TalkTable_TLK::hasEntry(uint32 strRef) const {
 }
 
 static const Common::UString kEmptyString = "";
-const Common::UString &TalkTable_TLK::getString(uint32 strRef) const {
+Common::UString TalkTable_TLK::getString(uint32 strRef) const {
 	if (strRef >= _entries.size())
 		return kEmptyString;
 
-	readString(_entries[strRef]);
+	const Entry &entry = _entries[strRef];
+	if ((entry.length == 0) || !(entry.flags & kFlagTextPresent))
+		return kEmptyString;
+
+	{
+		Common::StackLock lock(_mutex);
+
+		const Common::UString *cached = findCached(strRef);
+		if (cached)
+			return *cached;
+	}
+
+	// Decode the string without holding the lock, so we don't block other threads
+	const Common::UString text = readString(entry);
+
+	Common::StackLock lock(_mutex);
+	addCached(strRef, text);
 
-	return _entries[strRef].text;
+	return text;
+}
+
+void TalkTable_TLK::prefetch(const std::vector<uint32> &strRefs) const {
+	for (std::vector<uint32>::const_iterator s = strRefs.begin(); s != strRefs.end(); ++s) {
+		if (*s >= _entries.size())
+			continue;
+
+		const Entry &entry = _entries[*s];
+		if ((entry.length == 0) || !(entry.flags & kFlagTextPresent))
+			continue;
+
+		{
+			Common::StackLock lock(_mutex);
+
+			if (findCached(*s))
+				continue;
+		}
+
+		const Common::UString text = readString(entry);
+
+		Common::StackLock lock(_mutex);
+		addCached(*s, text);
+	}
 }
 
 const Common::UString &TalkTable_TLK::getSoundResRef(uint32 strRef) const {
@@ -26,10 +26,13 @@
 #define AURORA_TALKTABLE_TLK_H
 
 #include <vector>
+#include <list>
+#include <map>
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/aurorafile.h"
 #include "src/aurora/talktable.h"
@@ -49,6 +52,13 @@ namespace Aurora {
  *  - V3.0, used by Neverwinter Nights, Neverwinter Nights 2, Knight of
  *    the Old Republic, Knight of the Old Republic II and The Witcher
  *  - V4.0, used by Jade Empire
+ *
+ *  The whole TLK file is kept in memory, and strings are decoded directly
+ *  out of that memory when requested. To keep repeated requests cheap, the
+ *  most recently decoded strings are cached. This cache is bounded, so the
+ *  memory used by decoded strings does not grow with the number of strings
+ *  requested over the lifetime of the table (the Neverwinter Nights
+ *  dialog.tlk alone contains more than 100,000 strings).
  */
 class TalkTable_TLK : public AuroraFile, public TalkTable {
 public:
@@ -61,11 +71,13 @@ public:
 
 	bool hasEntry(uint32 strRef) const;
 
-	const Common::UString &getString     (uint32 strRef) const;
+	Common::UString        getString     (uint32 strRef) const;
 	const Common::UString &getSoundResRef(uint32 strRef) const;
 
 	uint32 getSoundID(uint32 strRef) const;
 
+	void prefetch(const std::vector<uint32> &strRefs) const;
+
 	static uint32 getLanguageID(Common::SeekableReadStream &tlk);
 	static uint32 getLanguageID(const Common::UString &file);
 
@@ -80,7 +92,6 @@ private:
 
 	/** A talk resource entry. */
 	struct Entry {
-		Common::UString text;
 		uint32 offset;
 		uint32 length;
 
@@ -97,19 +108,48 @@ private:
 
 	typedef std::vector<Entry> Entries;
 
+	/** The maximum number of decoded strings we keep around. */
+	static const size_t kMaxCachedStrings = 4096;
+
+	/** StrRefs of the cached strings, the most recently used first. */
+	typedef std::list<uint32> CacheOrder;
+
+	/** A decoded string in the cache. */
+	struct CachedString {
+		Common::UString text;
+		CacheOrder::iterator order; ///< The position of the string in the cache order.
+	};
+
+	typedef std::map<uint32, CachedString> Cache;
+
 
 	Common::ScopedPtr<Common::SeekableReadStream> _tlk;
 
+	const byte *_data; ///< The raw data of the whole TLK file.
+	size_t      _size; ///< The size of the whole TLK file.
+
 	uint32 _languageID;
 
-	mutable Entries _entries;
+	Entries _entries;
+
+	mutable Cache      _cache;      ///< The recently decoded strings.
+	mutable CacheOrder _cacheOrder; ///< The order in which the cached strings were used.
+
+	/** Guarding the cache. */
+	mutable Common::Mutex _mutex;
 
 	void load();
 
 	void readEntryTableV3(uint32 stringsOffset);
 	void readEntryTableV4();
 
-	void readString(Entry &entry) const;
+	/** Decode the string of this entry out of the raw TLK data. */
+	Common::UString readString(const Entry &entry) const;
+
+	/** Find a string in the cache, marking it as the most recently used. The cache must be locked. */
+	const Common::UString *findCached(uint32 strRef) const;
+	/** Add a string to the cache, evicting the least recently used one if necessary. The cache must be locked. */
+	void addCached(uint32 strRef, const Common::UString &text) const;
 };
 
 } // End of namespace Aurora
@@ -339,6 +339,13 @@ const FileTypeManager::Type FileTypeManager::types[] = {
 
 
 FileTypeManager::FileTypeManager() {
+	/* Build all lookup tables up-front. That way, the manager is only ever read
+	 * afterwards, and can safely be used by several threads at once. */
+	buildExtensionLookup();
+	buildTypeLookup();
+
+	for (int i = 0; i < Common::kHashMAX; i++)
+		buildHashLookup((Common::HashAlgo) i);
 }
 
 FileTypeManager::~FileTypeManager() {
@@ -30,120 +30,181 @@
 #include <boost/noncopyable.hpp>
 
 #include "src/common/types.h"
+#include "src/common/endianness.h"
 #include "src/common/disposableptr.h"
+#include "src/common/scopedptr.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
 
 namespace Common {
 
-/** A bit stream. */
-class BitStream {
-public:
-	virtual ~BitStream() {
-	}
+/**
+ * A template implementing a bit stream for different data memory layouts.
+ *
+ * Such a bit stream reads a valueBits-wide values from the data and
+ * gives access to their bits.
+ *
+ * For example, a bit stream with the layout parameters 32, true, false
+ * for valueBits, isLE and isMSB2LSB, reads 32bit little-endian values
+ * from the data and hands out the bits in the order of LSB to MSB.
+ *
+ * The bit stream works directly on a memory buffer. When created from a
+ * MemoryReadStream, it uses the stream's data. Any other stream is read
+ * into memory as a whole first. The bit stream covers the complete
+ * stream and starts at the stream's current position, which has to be
+ * aligned to the values. The position of the stream itself is not
+ * changed by reading from the bit stream.
+ *
+ * The upcoming bits are held in a 64-bit cache, which is refilled with
+ * as many values at once as fit. For all reads of up to 32 bits, this
+ * leaves at most a shift and a mask.
+ *
+ * The memory layout is fixed at compile time, and none of the methods
+ * are virtual. Code that works on any layout is templated on the bit
+ * stream type instead (see Huffman::getSymbol()).
+ */
+template<int valueBits, bool isLE, bool isMSB2LSB>
+class BitStreamImpl : boost::noncopyable {
+private:
+	/** Size of the units, in bits, that are put into the cache. 64-bit values are split in two. */
+	static const int kUnitBits  = (valueBits > 32) ? 32 : valueBits;
+	static const int kUnitBytes = kUnitBits / 8;
 
-	/** Return the stream position in bits. */
-	virtual size_t pos() const = 0;
+	DisposablePtr<SeekableReadStream> _stream; ///< The input stream, if any.
+	ScopedArray<byte> _buffer; ///< Our copy of the input stream's data, if necessary.
 
-	/** Return the stream size in bits. */
-	virtual size_t size() const = 0;
+	const byte *_data; ///< The data.
+	size_t      _size; ///< Size of the data in bytes, in full values.
 
-	/** Has the end of the stream been reached? */
-	virtual bool eos() const = 0;
+	size_t _dataPos; ///< Byte position of the next unit to be put into the cache.
 
-	/** Rewind the bit stream back to the start. */
-	virtual void rewind() = 0;
+	/** The cache of upcoming bits.
+	 *
+	 *  For MSB2LSB, the next bit is the MSB of the cache, otherwise the LSB.
+	 *  All bits beyond the valid ones are always 0.
+	 */
+	uint64 _cache;
+	int    _cacheBits; ///< Number of valid bits in the cache.
 
-	/** Skip the specified amount of bits. */
-	virtual void skip(size_t n) = 0;
+	/** Read the next unit from the data. */
+	inline uint32 readUnit() const {
+		const byte *data = _data + _dataPos;
 
-	/** Read a bit from the bit stream. */
-	virtual uint32 getBit() = 0;
+		if (valueBits == 8)
+			return *data;
 
-	/** Read a multi-bit value from the bit stream. */
-	virtual uint32 getBits(size_t n) = 0;
+		if (valueBits == 16)
+			return isLE ? READ_LE_UINT16(data) : READ_BE_UINT16(data);
 
-	/** Add a bit to the n-bit value x, making it an (n+1)-bit value. */
-	virtual void addBit(uint32 &x, size_t n) = 0;
+		if (valueBits == 32)
+			return isLE ? READ_LE_UINT32(data) : READ_BE_UINT32(data);
 
-protected:
-	BitStream() {
+		/* A 64-bit value is read as two 32-bit halves. The half with the first
+		 * bits comes first, which is the high half for MSB2LSB. The high half
+		 * is stored first in big endian data. */
+		const bool firstHalf = (_dataPos % 8) == 0;
+		const bool highHalf  = firstHalf == isMSB2LSB;
+
+		data = _data + (_dataPos & ~((size_t) 7)) + ((highHalf != isLE) ? 0 : 4);
+
+		return isLE ? READ_LE_UINT32(data) : READ_BE_UINT32(data);
 	}
-};
 
-/**
- * A template implementing a bit stream for different data memory layouts.
- *
- * Such a bit stream reads a valueBits-wide values from the data stream and
- * gives * access to their bits, one at a time.
- *
- * For example, a bit stream with the layout parameters 32, true, false
- * for valueBits, isLE and isMSB2LSB, reads 32bit little-endian values
- * from the data stream and hands out the bits in the order of LSB to MSB.
- */
-template<int valueBits, bool isLE, bool isMSB2LSB>
-class BitStreamImpl : boost::noncopyable, public BitStream {
-private:
-	DisposablePtr<SeekableReadStream> _stream; ///< The input stream.
-
-	uint64 _value;   ///< Current value.
-	uint8  _inValue; ///< Position within the current value.
-
-	/** Read a data value. */
-	inline uint64 readData() {
-		if (isLE) {
-			if (valueBits ==  8)
-				return _stream->readByte();
-			if (valueBits == 16)
-				return _stream->readUint16LE();
-			if (valueBits == 32)
-				return _stream->readUint32LE();
-			if (valueBits == 64)
-				return _stream->readUint64LE();
-		} else {
-			if (valueBits ==  8)
-				return _stream->readByte();
-			if (valueBits == 16)
-				return _stream->readUint16BE();
-			if (valueBits == 32)
-				return _stream->readUint32BE();
-			if (valueBits == 64)
-				return _stream->readUint64BE();
+	/** Fill the cache with as many units as fit. */
+	inline void refill() {
+		while ((_cacheBits <= (64 - kUnitBits)) && ((_size - _dataPos) >= (size_t) kUnitBytes)) {
+			const uint64 unit = readUnit();
+
+			if (isMSB2LSB)
+				_cache |= unit << (64 - kUnitBits - _cacheBits);
+			else
+				_cache |= unit << _cacheBits;
+
+			_cacheBits += kUnitBits;
+			_dataPos   += kUnitBytes;
 		}
+	}
 
-		assert(false);
-		return 0;
+	/** Return the next n bits in the cache, 0 < n <= 32. */
+	inline uint32 peekCache(int n) const {
+		if (isMSB2LSB)
+			return (uint32) (_cache >> (64 - n));
+
+		return (uint32) (_cache & (0xFFFFFFFFFFFFFFFFULL >> (64 - n)));
 	}
 
-	/** Read the next data value. */
-	inline void readValue() {
-		if ((size() - pos()) < valueBits)
-			throw Exception("BitStream::readValue(): End of bit stream reached");
+	/** Drop the next n bits from the cache, 0 < n <= _cacheBits. */
+	inline void dropCache(int n) {
+		if (n >= 64)
+			_cache = 0;
+		else if (isMSB2LSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+
+		_cacheBits -= n;
+	}
 
-		_value = readData();
+	/** Make sure there are at least n bits in the cache, 0 < n <= 32. */
+	inline void fill(int n) {
+		if (_cacheBits >= n)
+			return;
 
-		// If we're reading the bits MSB first, we need to shift the value to that position
-		if (isMSB2LSB)
-			_value <<= 64 - valueBits;
+		refill();
+		if (_cacheBits < n)
+			throw Exception("BitStream: End of bit stream reached");
+	}
+
+	void setData(const byte *data, size_t size, size_t pos) {
+		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32) && (valueBits != 64))
+			throw Exception("BitStream: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
+
+		if ((pos % (valueBits / 8)) != 0)
+			throw Exception("BitStream: Position %u not aligned to %d-bit values", (uint) pos, valueBits);
+
+		_data = data;
+		_size = size & ~((size_t) ((valueBits / 8) - 1));
+
+		_dataPos   = MIN(pos, _size);
+		_cache     = 0;
+		_cacheBits = 0;
+	}
+
+	void setStream() {
+		assert(_stream);
+
+		MemoryReadStream *memStream = dynamic_cast<MemoryReadStream *>(_stream.get());
+		if (memStream) {
+			setData(memStream->getData(), memStream->size(), memStream->pos());
+			return;
 		}
 
+		const size_t size = _stream->size();
+
+		_buffer.reset(new byte[size]);
+		if (_stream->readAt(0, _buffer.get(), size) != size)
+			throw Exception(kReadError);
+
+		setData(_buffer.get(), size, _stream->pos());
+	}
+
 public:
 	/** Create a bit stream using this input data stream and optionally delete it on destruction. */
 	BitStreamImpl(SeekableReadStream *stream, bool disposeAfterUse = false) :
-		_stream(stream, disposeAfterUse), _value(0), _inValue(0) {
-
-		assert(_stream);
+		_stream(stream, disposeAfterUse) {
 
-		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32) && (valueBits != 64))
-			throw Exception("BitStream: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
+		setStream();
 	}
 
 	/** Create a bit stream using this input data stream. */
-	BitStreamImpl(SeekableReadStream &stream) :
-		_stream(&stream, false), _value(0), _inValue(0) {
+	BitStreamImpl(SeekableReadStream &stream) : _stream(&stream, false) {
+		setStream();
+	}
 
-		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32) && (valueBits != 64))
-			throw Exception("BitStream: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
+	/** Create a bit stream directly on this data, which has to outlive the bit stream. */
+	BitStreamImpl(const byte *data, size_t size) : _stream(0, false) {
+		setData(data, size, 0);
 	}
 
 	~BitStreamImpl() {
@@ -151,25 +212,10 @@ public:
 
 	/** Read a bit from the bit stream. */
 	uint32 getBit() {
-		// Check if we need the next value
-		if (_inValue == 0)
-			readValue();
-
-		// Get the current bit
-		int b = 0;
-		if (isMSB2LSB)
-			b = ((_value & 0x8000000000000000ULL) == 0) ? 0 : 1;
-		else
-			b = ((_value & 1) == 0) ? 0 : 1;
-
-		// Shift to the next bit
-		if (isMSB2LSB)
-			_value <<= 1;
-		else
-			_value >>= 1;
+		fill(1);
 
-		// Increase the position within the current value
-		_inValue = (_inValue + 1) % valueBits;
+		const uint32 b = peekCache(1);
+		dropCache(1);
 
 		return b;
 	}
@@ -182,22 +228,31 @@ public:
 		if (n > 32)
 			throw Exception("Too many bits requested to be read");
 
-		// Read the number of bits
-		uint32 v = 0;
+		fill(n);
 
-		if (isMSB2LSB) {
-			while (n-- > 0)
-				v = (v << 1) | getBit();
-		} else {
-			for (uint32 i = 0; i < n; i++)
-				v = (v >> 1) | (((uint32) getBit()) << 31);
-
-			v >>= (32 - n);
-		}
+		const uint32 v = peekCache(n);
+		dropCache(n);
 
 		return v;
 	}
 
+	/** Read a multi-bit value from the bit stream, without consuming the bits.
+	 *
+	 *  Bits beyond the end of the stream are read as 0.
+	 */
+	uint32 peekBits(size_t n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			throw Exception("Too many bits requested to be read");
+
+		if (_cacheBits < (int) n)
+			refill();
+
+		return peekCache(n);
+	}
+
 	/** Add a bit to the n-bit value x, making it an (n+1)-bit value. */
 	void addBit(uint32 &x, size_t n) {
 		if (n >= 32)
@@ -209,36 +264,56 @@ public:
 			x = (x & ~(1 << n)) | (getBit() << n);
 	}
 
+	/** Are the bits handed out MSB first? */
+	bool isMSBFirst() const {
+		return isMSB2LSB;
+	}
+
 	/** Rewind the bit stream back to the start. */
 	void rewind() {
-		_stream->seek(0);
-
-		_value   = 0;
-		_inValue = 0;
+		_dataPos   = 0;
+		_cache     = 0;
+		_cacheBits = 0;
 	}
 
 	/** Skip the specified amount of bits. */
 	void skip(size_t n) {
-		while (n-- > 0)
-			getBit();
+		if (n <= (size_t) _cacheBits) {
+			if (n > 0)
+				dropCache(n);
+			return;
+		}
+
+		if (n > (size() - pos()))
+			throw Exception("BitStream: End of bit stream reached");
+
+		n -= _cacheBits;
+
+		_cache     = 0;
+		_cacheBits = 0;
+
+		// Skip whole units directly, then the remaining bits within the cache
+		_dataPos += (n / kUnitBits) * kUnitBytes;
+		n        %= kUnitBits;
+
+		if (n > 0) {
+			refill();
+			dropCache(n);
+		}
 	}
 
 	/** Return the stream position in bits. */
 	size_t pos() const {
-		if (_stream->pos() == 0)
-			return 0;
-
-		size_t p = (_inValue == 0) ? _stream->pos() : ((_stream->pos() - 1) & ~((size_t) ((valueBits >> 3) - 1)));
-		return p * 8 + _inValue;
+		return _dataPos * 8 - _cacheBits;
 	}
 
 	/** Return the stream size in bits. */
 	size_t size() const {
-		return (_stream->size() & ~((size_t) ((valueBits >> 3) - 1))) * 8;
+		return _size * 8;
 	}
 
 	bool eos() const {
-		return _stream->eos() || (pos() >= size());
+		return pos() >= size();
 	}
 };
 
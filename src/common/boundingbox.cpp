@@ -270,6 +270,11 @@ void BoundingBox::rotate(float angle, float x, float y, float z) {
 	_absolute = false;
 }
 
+void BoundingBox::rotateQuaternion(float x, float y, float z, float w) {
+	_origin.rotateQuaternion(x, y, z, w);
+	_absolute = false;
+}
+
 void BoundingBox::transform(const Matrix4x4 &m) {
 	_origin *= m;
 	_absolute = false;
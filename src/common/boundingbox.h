@@ -60,6 +60,7 @@ public:
 	void scale    (float x, float y, float z);
 
 	void rotate(float angle, float x, float y, float z);
+	void rotateQuaternion(float x, float y, float z, float w);
 
 	void transform(const Matrix4x4 &m);
 
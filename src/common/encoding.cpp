@@ -33,6 +33,7 @@
 #include "src/common/error.h"
 #include "src/common/scopedptr.h"
 #include "src/common/singleton.h"
+#include "src/common/mutex.h"
 #include "src/common/ustring.h"
 #include "src/common/memreadstream.h"
 #include "src/common/writestream.h"
@@ -101,6 +102,8 @@ public:
 		if (((size_t) encoding) >= kEncodingMAX)
 			throw Exception("Invalid encoding %d", encoding);
 
+		StackLock lock(_mutex);
+
 		return convert(_contextFrom[encoding], data, n, kEncodingGrowthFrom[encoding], 1);
 	}
 
@@ -108,6 +111,8 @@ public:
 		if (((size_t) encoding) >= kEncodingMAX)
 			throw Exception("Invalid encoding %d", encoding);
 
+		StackLock lock(_mutex);
+
 		return convert(_contextTo[encoding], str, kEncodingGrowthTo[encoding],
 		               terminate ? kTerminatorLength[encoding] : 0);
 	}
@@ -116,6 +121,9 @@ private:
 	iconv_t _contextFrom[kEncodingMAX];
 	iconv_t _contextTo  [kEncodingMAX];
 
+	/** iconv contexts must not be used by several threads at once. */
+	Mutex _mutex;
+
 	byte *doConvert(iconv_t &ctx, byte *data, size_t nIn, size_t nOut, size_t &size) {
 		size_t inBytes  = nIn;
 		size_t outBytes = nOut;
@@ -40,6 +40,7 @@ using boost::filesystem::exists;
 using boost::filesystem::is_regular_file;
 using boost::filesystem::is_directory;
 using boost::filesystem::file_size;
+using boost::filesystem::last_write_time;
 using boost::filesystem::directory_iterator;
 using boost::filesystem::create_directories;
 
@@ -78,6 +79,20 @@ size_t FilePath::getFileSize(const UString &p) {
 	return size;
 }
 
+std::time_t FilePath::getModificationTime(const UString &p) {
+	std::time_t t = (std::time_t) -1;
+
+	try {
+		t = last_write_time(p.c_str());
+	} catch (...) {
+	}
+
+	if (t == ((std::time_t) -1))
+		warning("Failed to get modification time of file \"%s\"", p.c_str());
+
+	return t;
+}
+
 UString FilePath::getFile(const UString &p) {
 	path file(p.c_str());
 
@@ -26,6 +26,7 @@
 #define COMMON_FILEPATH_H
 
 #include <list>
+#include <ctime>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
@@ -58,6 +59,14 @@ public:
 	 */
 	static size_t getFileSize(const UString &p);
 
+	/** Return the time a file was last modified.
+	 *
+	 *  @param  p The file to look up.
+	 *  @return The modification time of the file, in seconds since the
+	 *          epoch, or -1 if not a valid file.
+	 */
+	static std::time_t getModificationTime(const UString &p);
+
 	/** Return a file name without its path.
 	 *
 	 *  Example: "/path/to/file.ext" > "file.ext"
@@ -24,14 +24,62 @@
 
 #include <cassert>
 
+#include <algorithm>
+
 #include "src/common/huffman.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
-#include "src/common/bitstream.h"
 
 namespace Common {
 
-Huffman::Symbol::Symbol(uint32 c, uint32 s) : code(c), symbol(s) {
+/** Reverse the order of the lowest n bits in a value. */
+static uint32 reverseBits(uint32 value, uint8 n) {
+	uint32 reversed = 0;
+	for (uint8 i = 0; i < n; i++, value >>= 1)
+		reversed = (reversed << 1) | (value & 1);
+
+	return reversed;
+}
+
+/** Return a mask of the lowest n bits. */
+static uint32 lowBits(uint8 n) {
+	return (n >= 32) ? 0xFFFFFFFF : ((1U << n) - 1);
+}
+
+/** Order codes by length, then by index. */
+struct CompareCodeLength {
+	template<typename T>
+	bool operator()(const T &a, const T &b) const {
+		if (a.length != b.length)
+			return a.length < b.length;
+
+		return a.index < b.index;
+	}
+};
+
+/** Order codes by their bits directly following the ones already consumed. */
+struct CompareCodePrefix {
+	uint8 consumed, bits;
+
+	CompareCodePrefix(uint8 c, uint8 b) : consumed(c), bits(b) {
+	}
+
+	template<typename T>
+	uint32 prefix(const T &code) const {
+		return (code.bits >> (code.length - consumed - bits)) & lowBits(bits);
+	}
+
+	template<typename T>
+	bool operator()(const T &a, const T &b) const {
+		return prefix(a) < prefix(b);
+	}
+};
+
+
+Huffman::Code::Code(uint32 b, uint8 l, uint32 i) : bits(b), length(l), index(i) {
+}
+
+Huffman::TableEntry::TableEntry() : value(0), length(0), subBits(0) {
 }
 
 
@@ -59,41 +107,115 @@ void Huffman::init(uint8 maxLength, size_t codeCount, const uint32 *codes,
 
 	assert(maxLength <= 32);
 
-	_codes.resize(maxLength);
 	_symbols.resize(codeCount);
+	setSymbols(symbols);
+
+	/* For a bitstream handing out its bits MSB-to-LSB, the first bit of a code
+	 * is its MSB. For a bitstream going LSB-to-MSB, the first bit is its LSB. */
+	CodeList codesMSB, codesLSB;
+	codesMSB.reserve(codeCount);
+	codesLSB.reserve(codeCount);
 
 	for (size_t i = 0; i < codeCount; i++) {
-		// The symbol. If none were specified, just assume it's identical to the code index
-		uint32 symbol = symbols ? symbols[i] : i;
+		assert((lengths[i] > 0) && (lengths[i] <= maxLength));
 
-		// Put the code and symbol into the correct list
-		_codes[lengths[i] - 1].push_back(Symbol(codes[i], symbol));
+		// A code with bits beyond its length can never be matched
+		if ((codes[i] & ~lowBits(lengths[i])) != 0)
+			continue;
 
-		// And put the pointer to the symbol/code struct into the symbol list.
-		_symbols[i] = &_codes[lengths[i] - 1].back();
+		codesMSB.push_back(Code(codes[i], lengths[i], i));
+		codesLSB.push_back(Code(reverseBits(codes[i], lengths[i]), lengths[i], i));
 	}
-}
 
-Huffman::~Huffman() {
-}
+	/* If codes overlap, the shortest one wins. With equal lengths, the one
+	 * that comes first wins. */
+	std::sort(codesMSB.begin(), codesMSB.end(), CompareCodeLength());
+	std::sort(codesLSB.begin(), codesLSB.end(), CompareCodeLength());
 
-void Huffman::setSymbols(const uint32 *symbols) {
-	for (size_t i = 0; i < _symbols.size(); i++)
-		_symbols[i]->symbol = symbols ? *symbols++ : i;
+	_tableBits = MIN(maxLength, kTableBits);
+
+	_tables[0].resize(1 << _tableBits);
+	_tables[1].resize(1 << _tableBits);
+
+	buildTable(_tables[0], 0, _tableBits, 0, codesMSB, true);
+	buildTable(_tables[1], 0, _tableBits, 0, codesLSB, false);
 }
 
-uint32 Huffman::getSymbol(BitStream &bits) const {
-	uint32 code = 0;
+void Huffman::buildTable(Table &table, size_t offset, uint8 tableBits, uint8 consumed,
+                         const CodeList &codes, bool msb2lsb) {
+
+	/* The table is indexed by the next tableBits bits peeked from the bitstream.
+	 * We calculate the index as if the bits were handed out MSB-to-LSB and then,
+	 * for LSB-to-MSB bitstreams, reverse it. */
+
+	CodeList longCodes;
 
-	for (size_t i = 0; i < _codes.size(); i++) {
-		bits.addBit(code, i);
+	// Codes that end within this table fill all the entries starting with them
+	for (CodeList::const_iterator c = codes.begin(); c != codes.end(); ++c) {
+		const uint8 length = c->length - consumed;
+		if (length > tableBits) {
+			longCodes.push_back(*c);
+			continue;
+		}
 
-		for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
-			if (code == cCode->code)
-				return cCode->symbol;
+		const uint32 prefix = (c->bits & lowBits(length)) << (tableBits - length);
+		for (uint32 i = 0; i < (1U << (tableBits - length)); i++) {
+			const uint32 index = msb2lsb ? (prefix | i) : reverseBits(prefix | i, tableBits);
+
+			TableEntry &entry = table[offset + index];
+			if ((entry.length != 0) || (entry.subBits != 0))
+				continue;
+
+			entry.value  = c->index;
+			entry.length = length;
+		}
 	}
 
-	throw Exception("Unknown Huffman code");
+	/* Longer codes are grouped by the bits within this table, and each group
+	 * is put into its own sub table. */
+
+	const CompareCodePrefix comparePrefix(consumed, tableBits);
+	std::stable_sort(longCodes.begin(), longCodes.end(), comparePrefix);
+
+	CodeList::const_iterator group = longCodes.begin();
+	while (group != longCodes.end()) {
+		const uint32 prefix = comparePrefix.prefix(*group);
+
+		CodeList subCodes;
+		uint8 maxLength = 0;
+
+		CodeList::const_iterator c = group;
+		for (; (c != longCodes.end()) && (comparePrefix.prefix(*c) == prefix); ++c) {
+			subCodes.push_back(*c);
+			maxLength = MAX<uint8>(maxLength, c->length - consumed - tableBits);
+		}
+
+		group = c;
+
+		const uint32 index = msb2lsb ? prefix : reverseBits(prefix, tableBits);
+
+		// Already fully covered by a shorter code
+		if (table[offset + index].length != 0)
+			continue;
+
+		const uint8  subBits   = MIN(maxLength, kTableBits);
+		const size_t subOffset = table.size();
+
+		table.resize(subOffset + (1 << subBits));
+
+		table[offset + index].value   = subOffset;
+		table[offset + index].subBits = subBits;
+
+		buildTable(table, subOffset, subBits, consumed + tableBits, subCodes, msb2lsb);
+	}
+}
+
+Huffman::~Huffman() {
+}
+
+void Huffman::setSymbols(const uint32 *symbols) {
+	for (size_t i = 0; i < _symbols.size(); i++)
+		_symbols[i] = symbols ? *symbols++ : i;
 }
 
 } // End of namespace Common
@@ -26,14 +26,12 @@
 #define COMMON_HUFFMAN_H
 
 #include <vector>
-#include <list>
 
 #include "src/common/types.h"
+#include "src/common/error.h"
 
 namespace Common {
 
-class BitStream;
-
 struct HuffmanTable {
 	uint8  maxLength; ///< Maximal code length. If 0, it's searched for.
 	size_t codeCount; ///< Number of codes.
@@ -43,7 +41,17 @@ struct HuffmanTable {
 	const uint32 *symbols; ///< The symbols, 0 if identical to the codes.
 };
 
-/** Decode a Huffman'd bitstream. */
+/** Decode a Huffman'd bitstream.
+ *
+ *  The codes are decoded with multi-level lookup tables: the next few bits
+ *  of the bitstream are peeked and used as an index into the first table,
+ *  which directly resolves all short codes. Longer codes continue into
+ *  a sub table indexed by the bits following.
+ *
+ *  Since the order in which a bitstream hands out its bits changes which
+ *  sequence of bits a code stands for, there's a set of tables for both
+ *  MSB-to-LSB and LSB-to-MSB bitstreams.
+ */
 class Huffman {
 public:
 	/** Construct a Huffman decoder.
@@ -62,29 +70,82 @@ public:
 	/** Modify the codes' symbols. */
 	void setSymbols(const uint32 *symbols = 0);
 
-	/** Return the next symbol in the bitstream. */
-	uint32 getSymbol(BitStream &bits) const;
+	/** Return the next symbol in the bitstream.
+	 *
+	 *  This is a template over the bitstream type, so that the bitstream
+	 *  methods can be inlined into the decoding loop.
+	 */
+	template<typename BitStreamType>
+	uint32 getSymbol(BitStreamType &bits) const {
+		const Table &table = _tables[bits.isMSBFirst() ? 0 : 1];
+
+		size_t offset    = 0;
+		uint8  tableBits = _tableBits;
+
+		while (true) {
+			const TableEntry &entry = table[offset + bits.peekBits(tableBits)];
+
+			if (entry.length != 0) {
+				bits.skip(entry.length);
+				return _symbols[entry.value];
+			}
+
+			if (entry.subBits == 0)
+				break;
+
+			bits.skip(tableBits);
+
+			offset    = entry.value;
+			tableBits = entry.subBits;
+		}
+
+		throw Exception("Unknown Huffman code");
+	}
 
 private:
-	struct Symbol {
-		uint32 code;
-		uint32 symbol;
+	/** Maximum number of bits used to index one lookup table. */
+	static const uint8 kTableBits = 9;
+
+	/** A code, as a sequence of bits in the order they appear in the bitstream. */
+	struct Code {
+		uint32 bits;   ///< The bits, first one in the MSB.
+		uint8  length; ///< Number of bits.
+		uint32 index;  ///< Index of the code.
+
+		Code(uint32 b, uint8 l, uint32 i);
+	};
+
+	typedef std::vector<Code> CodeList;
+
+	/** An entry in a lookup table. */
+	struct TableEntry {
+		/** Index of the code, or the offset of the sub table. */
+		uint32 value;
+		/** Number of bits the code has left at this table level, or 0 if the code continues. */
+		uint8 length;
+		/** Number of bits indexing the sub table, or 0 for an invalid code. */
+		uint8 subBits;
 
-		Symbol(uint32 c, uint32 s);
+		TableEntry();
 	};
 
-	typedef std::list<Symbol>     CodeList;
-	typedef std::vector<CodeList> CodeLists;
-	typedef std::vector<Symbol *> SymbolList;
+	typedef std::vector<TableEntry> Table;
 
-	/** Lists of codes and their symbols, sorted by code length. */
-	CodeLists _codes;
+	/** Number of bits indexing the first table. */
+	uint8 _tableBits;
 
-	/** Sorted list of pointers to the symbols. */
-	SymbolList _symbols;
+	/** Lookup tables, for MSB-to-LSB and LSB-to-MSB bitstreams. */
+	Table _tables[2];
+
+	/** The symbols of all codes, by code index. */
+	std::vector<uint32> _symbols;
 
 	void init(uint8 maxLength, size_t codeCount, const uint32 *codes,
 	          const uint8 *lengths, const uint32 *symbols);
+
+	/** Fill a (sub) table with all codes that have the first consumed bits in common. */
+	static void buildTable(Table &table, size_t offset, uint8 tableBits, uint8 consumed,
+	                       const CodeList &codes, bool msb2lsb);
 };
 
 } // End of namespace Common
@@ -0,0 +1,48 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Implementing the stream reading interfaces for memory-mapped files.
+ */
+
+#include "src/common/mappedfile.h"
+#include "src/common/ustring.h"
+#include "src/common/platform.h"
+
+namespace Common {
+
+MappedFile::MappedFile(const byte *data, size_t size) : MemoryReadStream(data, size, false) {
+}
+
+MappedFile::~MappedFile() {
+	Platform::unmapFile(getData(), size());
+}
+
+MappedFile *MappedFile::open(const UString &fileName) {
+	size_t size = 0;
+
+	const byte *data = Platform::mapFile(fileName, size);
+	if (!data)
+		return 0;
+
+	return new MappedFile(data, size);
+}
+
+} // End of namespace Common
@@ -0,0 +1,59 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Implementing the stream reading interfaces for memory-mapped files.
+ */
+
+#ifndef COMMON_MAPPEDFILE_H
+#define COMMON_MAPPEDFILE_H
+
+#include "src/common/types.h"
+#include "src/common/memreadstream.h"
+
+namespace Common {
+
+class UString;
+
+/** A read-only file that is mapped into memory.
+ *
+ *  Since the whole file is directly addressable, all reads are simple
+ *  memory copies without any system call, and views of parts of the
+ *  file can be handed out without copying anything at all. See
+ *  createSubReadStream().
+ */
+class MappedFile : public MemoryReadStream {
+public:
+	~MappedFile();
+
+	/** Try to map the file with the given fileName into memory.
+	 *
+	 *  @param  fileName the name of the file to map.
+	 *  @return the mapped file, or 0 if the file couldn't be mapped.
+	 */
+	static MappedFile *open(const UString &fileName);
+
+private:
+	MappedFile(const byte *data, size_t size);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MAPPEDFILE_H
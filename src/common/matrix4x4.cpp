@@ -288,6 +288,43 @@ void Matrix4x4::rotate(float angle, float x, float y, float z, bool normalise) {
 	std::memcpy(_elements, result, 16 * sizeof(float));  // Copy the rotation into the matrix.
 }
 
+void Matrix4x4::rotateQuaternion(float x, float y, float z, float w, bool normalise) {
+	// Normalize the quaternion
+	if (normalise) {
+		float length = x * x + y * y + z * z + w * w;
+		if ((length != 1.0f) && (length != 0.0f)) {
+			length = 1.0f / sqrtf(length);
+
+			x *= length;
+			y *= length;
+			z *= length;
+			w *= length;
+		}
+	}
+
+	float result[16];
+
+	float m0  = 1.0f - 2.0f * (y * y + z * z);
+	float m1  =        2.0f * (x * y + z * w);
+	float m2  =        2.0f * (x * z - y * w);
+
+	float m4  =        2.0f * (x * y - z * w);
+	float m5  = 1.0f - 2.0f * (x * x + z * z);
+	float m6  =        2.0f * (y * z + x * w);
+
+	float m8  =        2.0f * (x * z + y * w);
+	float m9  =        2.0f * (y * z - x * w);
+	float m10 = 1.0f - 2.0f * (x * x + y * y);
+
+	for (int i = 0; i < 4; i++) {
+		result[0  + i] = (_elements[i] * m0) + (_elements[i + 4] * m1) + (_elements[i + 8] * m2);
+		result[4  + i] = (_elements[i] * m4) + (_elements[i + 4] * m5) + (_elements[i + 8] * m6);
+		result[8  + i] = (_elements[i] * m8) + (_elements[i + 4] * m9) + (_elements[i + 8] * m10);
+		result[12 + i] = (_elements[i + 12]);
+	}
+	std::memcpy(_elements, result, 16 * sizeof(float));  // Copy the rotation into the matrix.
+}
+
 void Matrix4x4::rotateAxisLocal(const Vector3 &vin, float angle, bool normalise) {
 	angle = deg2rad(angle);
 
@@ -64,6 +64,8 @@ public:
 	void scale    (const Vector3 &v);
 
 	void rotate(float angle, float x, float y, float z, bool normalise = true);
+	/** Rotate by a quaternion. Unlike rotate(), this needs no trigonometric functions. */
+	void rotateQuaternion(float x, float y, float z, float w, bool normalise = true);
 	void rotateAxisLocal(const Vector3 &vin, float angle, bool normalise = true);
 	void rotateXAxisLocal(float angle, bool normalise = true);
 	void rotateYAxisLocal(float angle, bool normalise = true);
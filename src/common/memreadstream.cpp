@@ -60,28 +60,39 @@ size_t MemoryReadStream::read(void *dataPtr, size_t dataSize) {
 	assert(dataPtr);
 
 	// Read at most as many bytes as are still available...
-	if (dataSize > _size - _pos) {
-		dataSize = _size - _pos;
+	const size_t available = _bufferEnd - _bufferPos;
+	if (dataSize > available) {
+		dataSize = available;
 		_eos = true;
 	}
-	std::memcpy(dataPtr, _ptr, dataSize);
+	std::memcpy(dataPtr, _bufferPos, dataSize);
 
-	_ptr += dataSize;
-	_pos += dataSize;
+	_bufferPos += dataSize;
+
+	return dataSize;
+}
+
+size_t MemoryReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) const {
+	assert(dataPtr);
+
+	if (offset >= _size)
+		return 0;
+
+	dataSize = MIN(dataSize, _size - offset);
+	std::memcpy(dataPtr, _ptrOrig.get() + offset, dataSize);
 
 	return dataSize;
 }
 
 size_t MemoryReadStream::seek(ptrdiff_t offset, Origin whence) {
-	assert((size_t)_pos <= _size);
+	assert((_bufferPos >= _ptrOrig.get()) && (_bufferPos <= _bufferEnd));
 
-	const size_t oldPos = _pos;
-	const size_t newPos = evalSeek(offset, whence, _pos, 0, size());
+	const size_t oldPos = pos();
+	const size_t newPos = evalSeek(offset, whence, oldPos, 0, size());
 	if (newPos > _size)
 		throw Exception(kSeekError);
 
-	_pos = newPos;
-	_ptr = _ptrOrig.get() + newPos;
+	_bufferPos = _ptrOrig.get() + newPos;
 
 	// Reset end-of-stream flag on a successful seek
 	_eos = false;
@@ -94,7 +105,7 @@ bool MemoryReadStream::eos() const {
 }
 
 size_t MemoryReadStream::pos() const {
-	return _pos;
+	return _bufferPos - _ptrOrig.get();
 }
 
 size_t MemoryReadStream::size() const {
@@ -115,4 +126,18 @@ MemoryReadStreamEndian::MemoryReadStreamEndian(const byte *dataPtr, size_t dataS
 MemoryReadStreamEndian::~MemoryReadStreamEndian() {
 }
 
+
+SeekableReadStream *createSubReadStream(SeekableReadStream &parentStream, size_t begin, size_t end) {
+	assert(begin <= end);
+
+	MemoryReadStream *memStream = dynamic_cast<MemoryReadStream *>(&parentStream);
+	if (!memStream)
+		return parentStream.readStreamAt(begin, end - begin);
+
+	if (end > memStream->size())
+		throw Exception(kSeekError);
+
+	return new MemoryReadStream(memStream->getData() + begin, end - begin);
+}
+
 } // End of namespace Common
@@ -69,24 +69,27 @@ public:
 	 *  wraps it. If disposeMemory is true, the MemoryReadStream takes ownership
 	 *  of the buffer and hence delete[]'s it when destructed. */
 	MemoryReadStream(const byte *dataPtr, size_t dataSize, bool disposeMemory = false) :
-		_ptrOrig(dataPtr, disposeMemory), _ptr(dataPtr), _size(dataSize), _pos(0), _eos(false) {
+		_ptrOrig(dataPtr, disposeMemory), _size(dataSize), _eos(false) {
 
+		resetBuffer();
 	}
 
 	/** Create a MemoryReadStream around a static string buffer, optionally including the
 	 *  terminating \0. Never disposes its memory. */
 	MemoryReadStream(const char *str, bool useTerminator = false) :
-		_ptrOrig(reinterpret_cast<const byte *>(str), false), _ptr(reinterpret_cast<const byte *>(str)),
-		_size(strlen(str) + (useTerminator ? 1 : 0)), _pos(0), _eos(false) {
+		_ptrOrig(reinterpret_cast<const byte *>(str), false),
+		_size(strlen(str) + (useTerminator ? 1 : 0)), _eos(false) {
 
+		resetBuffer();
 	}
 
 	/** Template constructor to create a MemoryReadStream around a static array buffer.
 	 *  Never disposes its memory. */
 	template<size_t N>
 	MemoryReadStream(const byte (&array)[N]) :
-		_ptrOrig(array, false), _ptr(array), _size(N), _pos(0), _eos(false) {
+		_ptrOrig(array, false), _size(N), _eos(false) {
 
+		resetBuffer();
 	}
 
 	~MemoryReadStream() { }
@@ -100,17 +103,26 @@ public:
 
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize) const;
+
 	const byte *getData() const;
 
 private:
+	/* The current position in the stream is stored in the direct read window,
+	 * see ReadStream::_bufferPos, which always spans from the current position
+	 * to the end of the data. */
+
 	DisposableArray<const byte> _ptrOrig;
-	const byte *_ptr;
 
 	const size_t _size;
 
-	size_t _pos;
-
 	bool _eos;
+
+	/** Set the direct read window to span the whole stream. */
+	void resetBuffer() {
+		_bufferPos = _ptrOrig.get();
+		_bufferEnd = _bufferPos + _size;
+	}
 };
 
 
@@ -159,6 +171,19 @@ public:
 	}
 };
 
+/** Create a stream restricted to the range [begin, end) of a parent stream,
+ *  avoiding copying data where possible.
+ *
+ *  If the parent stream is a MemoryReadStream (which includes memory-mapped
+ *  files), the new stream directly references the parent's memory, and the
+ *  parent stream has to outlive the new stream. Otherwise, the range is read
+ *  into a new MemoryReadStream with readStreamAt().
+ *
+ *  In either case, the new stream is completely independent of the parent's
+ *  stream position, and the parent's position is left unchanged.
+ */
+SeekableReadStream *createSubReadStream(SeekableReadStream &parentStream, size_t begin, size_t end);
+
 } // End of namespace Common
 
 #endif // COMMON_MEMREADSTREAM_H
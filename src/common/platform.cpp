@@ -34,10 +34,15 @@
 #if defined(UNIX)
 	#include <pwd.h>
 	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
 #endif
 
 #include <cassert>
 #include <cstdlib>
+#include <cerrno>
 
 #include <boost/locale.hpp>
 #include <boost/filesystem/path.hpp>
@@ -118,6 +123,129 @@ std::FILE *Platform::openFile(const UString &fileName, FileMode mode) {
 }
 // '--- openFile() ---'
 
+// .--- mapFile() ---.
+#if defined(WIN32)
+
+const byte *Platform::mapFile(const UString &fileName, size_t &size) {
+	HANDLE file = CreateFileW(boost::filesystem::path(fileName.c_str()).c_str(), GENERIC_READ,
+	                          FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return 0;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart <= 0) || (fileSize.QuadPart > 0x7FFFFFFF)) {
+		CloseHandle(file);
+		return 0;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, 0, PAGE_READONLY, 0, 0, 0);
+	CloseHandle(file);
+
+	if (!mapping)
+		return 0;
+
+	// The view keeps the mapping object alive, so we can close our handle right away
+	const byte *data = static_cast<const byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	CloseHandle(mapping);
+
+	if (!data)
+		return 0;
+
+	size = (size_t) fileSize.QuadPart;
+	return data;
+}
+
+void Platform::unmapFile(const byte *data, size_t UNUSED(size)) {
+	if (data)
+		UnmapViewOfFile(data);
+}
+
+#elif defined(UNIX)
+
+const byte *Platform::mapFile(const UString &fileName, size_t &size) {
+	int file = ::open(boost::filesystem::path(fileName.c_str()).c_str(), O_RDONLY);
+	if (file < 0)
+		return 0;
+
+	struct stat fileStat;
+	if ((fstat(file, &fileStat) != 0) || !S_ISREG(fileStat.st_mode) ||
+	    (fileStat.st_size <= 0) || ((uint64) fileStat.st_size > (uint64) 0x7FFFFFFFULL)) {
+
+		::close(file);
+		return 0;
+	}
+
+	// The mapping stays valid after the file descriptor has been closed
+	void *data = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+
+	if (data == MAP_FAILED)
+		return 0;
+
+	size = (size_t) fileStat.st_size;
+	return static_cast<const byte *>(data);
+}
+
+void Platform::unmapFile(const byte *data, size_t size) {
+	if (data)
+		munmap(const_cast<byte *>(data), size);
+}
+
+#else
+
+/* No known way to map files on this platform. Callers fall back to normal file reading. */
+const byte *Platform::mapFile(const UString &UNUSED(fileName), size_t &UNUSED(size)) {
+	return 0;
+}
+
+void Platform::unmapFile(const byte *UNUSED(data), size_t UNUSED(size)) {
+}
+
+#endif
+// '--- mapFile() ---'
+
+// .--- readFileAt() ---.
+#if defined(UNIX)
+
+bool Platform::readFileAt(std::FILE *file, size_t offset, void *data, size_t &size) {
+	const int fd = fileno(file);
+	if (fd < 0)
+		return false;
+
+	byte *dataPtr = static_cast<byte *>(data);
+
+	size_t bytesRead = 0;
+	while (bytesRead < size) {
+		const ssize_t n = pread(fd, dataPtr + bytesRead, size - bytesRead, offset + bytesRead);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+
+			break;
+		}
+
+		if (n == 0)
+			break;
+
+		bytesRead += n;
+	}
+
+	size = bytesRead;
+	return true;
+}
+
+#else
+
+/* Windows' positional reads move the file pointer underneath the C runtime's
+ * buffering, so we let callers fall back to seeking. */
+bool Platform::readFileAt(std::FILE *UNUSED(file), size_t UNUSED(offset),
+                          void *UNUSED(data), size_t &UNUSED(size)) {
+	return false;
+}
+
+#endif
+// '--- readFileAt() ---'
+
 // .--- Windows utility functions ---.
 #if defined(WIN32)
 
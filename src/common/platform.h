@@ -29,6 +29,7 @@
 
 #include <vector>
 
+#include "src/common/types.h"
 #include "src/common/ustring.h"
 
 namespace Common {
@@ -51,6 +52,29 @@ public:
 	/** Open a file with an UTF-8 encoded name. */
 	static std::FILE *openFile(const UString &fileName, FileMode mode);
 
+	/** Map a file with an UTF-8 encoded name into memory, read-only.
+	 *
+	 *  @param  fileName The name of the file to map.
+	 *  @param  size If the mapping succeeded, the size of the file is stored here.
+	 *  @return A pointer to the mapped file contents, or 0 if mapping failed.
+	 */
+	static const byte *mapFile(const UString &fileName, size_t &size);
+
+	/** Unmap a file previously mapped with mapFile(). */
+	static void unmapFile(const byte *data, size_t size);
+
+	/** Read from an absolute position within an opened file, without using or
+	 *  changing the file position, and without interfering with other threads
+	 *  reading from the same file.
+	 *
+	 *  @param  file The file to read from.
+	 *  @param  offset The position to read from.
+	 *  @param  data The buffer to read into.
+	 *  @param  size The number of bytes to read. Set to the number of bytes actually read.
+	 *  @return false if this platform has no way to do such a read.
+	 */
+	static bool readFileAt(std::FILE *file, size_t offset, void *data, size_t &size);
+
 	/** Return the OS-specific path of the user's home directory. */
 	static UString getHomeDirectory();
 	/** Return the OS-specific path of the config directory. */
@@ -24,6 +24,7 @@
 
 #include <cassert>
 
+#include "src/common/util.h"
 #include "src/common/readfile.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
@@ -139,4 +140,17 @@ size_t ReadFile::read(void *dataPtr, size_t dataSize) {
 	return std::fread(dataPtr, 1, dataSize, _handle);
 }
 
+size_t ReadFile::readAt(size_t offset, void *dataPtr, size_t dataSize) const {
+	if (!_handle || (offset >= _size))
+		return 0;
+
+	assert(dataPtr);
+
+	dataSize = MIN(dataSize, _size - offset);
+	if (Platform::readFileAt(_handle, offset, dataPtr, dataSize))
+		return dataSize;
+
+	return SeekableReadStream::readAt(offset, dataPtr, dataSize);
+}
+
 } // End of namespace Common
@@ -67,6 +67,8 @@ public:
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 	size_t read(void *dataPtr, size_t dataSize);
 
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize) const;
+
 protected:
 	std::FILE *_handle; ///< The actual file handle.
 	size_t _size;       ///< The file's size.
@@ -49,16 +49,21 @@
 
 #include <cassert>
 
+#include "src/common/util.h"
 #include "src/common/readstream.h"
 #include "src/common/memreadstream.h"
 #include "src/common/error.h"
 #include "src/common/scopedptr.h"
+#include "src/common/mutex.h"
 
 namespace Common {
 
+/** Serializes positional reads on streams that can only seek and read. */
+static Mutex readAtMutex;
+
 const uint32 ReadStream::kEOF;
 
-ReadStream::ReadStream() {
+ReadStream::ReadStream() : _bufferPos(0), _bufferEnd(0) {
 }
 
 ReadStream::~ReadStream() {
@@ -73,6 +78,41 @@ MemoryReadStream *ReadStream::readStream(size_t dataSize) {
 	return new MemoryReadStream(buf.release(), dataSize, true);
 }
 
+void ReadStream::readArray(void *data, size_t count, size_t size) {
+	assert((size == 1) || (size == 2) || (size == 4) || (size == 8));
+
+	if (count > (SIZE_MAX / size))
+		throw Exception(kReadError);
+
+	const size_t dataSize = count * size;
+	if (dataSize == 0)
+		return;
+
+	assert(data);
+
+	if (read(data, dataSize) != dataSize)
+		throw Exception(kReadError);
+}
+
+void ReadStream::swapArray(void *data, size_t count, size_t size) {
+	/* Simple loops over properly typed and aligned arrays, so that the
+	 * compiler can vectorize the byte swapping. */
+
+	if        (size == 2) {
+		uint16 *d = static_cast<uint16 *>(data);
+		for (size_t i = 0; i < count; i++)
+			d[i] = SWAP_BYTES_16(d[i]);
+	} else if (size == 4) {
+		uint32 *d = static_cast<uint32 *>(data);
+		for (size_t i = 0; i < count; i++)
+			d[i] = SWAP_BYTES_32(d[i]);
+	} else if (size == 8) {
+		uint64 *d = static_cast<uint64 *>(data);
+		for (size_t i = 0; i < count; i++)
+			d[i] = SWAP_BYTES_64(d[i]);
+	}
+}
+
 
 SeekableReadStream::SeekableReadStream() {
 }
@@ -80,6 +120,30 @@ SeekableReadStream::SeekableReadStream() {
 SeekableReadStream::~SeekableReadStream() {
 }
 
+size_t SeekableReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) const {
+	StackLock lock(readAtMutex);
+
+	SeekableReadStream &stream = const_cast<SeekableReadStream &>(*this);
+
+	if (offset > stream.size())
+		return 0;
+
+	const size_t oldPos = stream.seek(offset);
+	const size_t result = stream.read(dataPtr, dataSize);
+	stream.seek(oldPos);
+
+	return result;
+}
+
+MemoryReadStream *SeekableReadStream::readStreamAt(size_t offset, size_t dataSize) const {
+	ScopedArray<byte> buf(new byte[dataSize]);
+
+	if (readAt(offset, buf.get(), dataSize) != dataSize)
+		throw Exception(kReadError);
+
+	return new MemoryReadStream(buf.release(), dataSize, true);
+}
+
 size_t SeekableReadStream::evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size) {
 	switch (whence) {
 		case kOriginEnd:
@@ -162,6 +226,13 @@ size_t SeekableSubReadStream::seek(ptrdiff_t offset, Origin whence) {
 	return oldPos;
 }
 
+size_t SeekableSubReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) const {
+	if (offset > size())
+		return 0;
+
+	return _parentStream->readAt(_begin + offset, dataPtr, MIN(dataSize, size() - offset));
+}
+
 
 SeekableSubReadStreamEndian::SeekableSubReadStreamEndian(SeekableReadStream *parentStream,
 		size_t begin, size_t end, bool bigEndian, bool disposeParentStream) :
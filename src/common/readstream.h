@@ -50,6 +50,8 @@
 #ifndef COMMON_READSTREAM_H
 #define COMMON_READSTREAM_H
 
+#include <cstring>
+
 #include "src/common/types.h"
 #include "src/common/endianness.h"
 #include "src/common/disposableptr.h"
@@ -90,6 +92,9 @@ public:
 
 	/** Read an unsigned byte from the stream and return it. */
 	byte readByte() {
+		if (_bufferPos < _bufferEnd)
+			return *_bufferPos++;
+
 		byte b;
 		if (read(&b, 1) != 1)
 			throw Exception(kReadError);
@@ -121,8 +126,7 @@ public:
 	 */
 	uint16 readUint16LE() {
 		uint16 val;
-		if (read(&val, 2) != 2)
-			throw Exception(kReadError);
+		readFixed(&val, 2);
 
 		return FROM_LE_16(val);
 	}
@@ -132,8 +136,7 @@ public:
 	 */
 	uint32 readUint32LE() {
 		uint32 val;
-		if (read(&val, 4) != 4)
-			throw Exception(kReadError);
+		readFixed(&val, 4);
 
 		return FROM_LE_32(val);
 	}
@@ -143,8 +146,7 @@ public:
 	 */
 	uint64 readUint64LE() {
 		uint64 val;
-		if (read(&val, 8) != 8)
-			throw Exception(kReadError);
+		readFixed(&val, 8);
 
 		return FROM_LE_64(val);
 	}
@@ -154,8 +156,7 @@ public:
 	 */
 	uint16 readUint16BE() {
 		uint16 val;
-		if (read(&val, 2) != 2)
-			throw Exception(kReadError);
+		readFixed(&val, 2);
 
 		return FROM_BE_16(val);
 	}
@@ -165,8 +166,7 @@ public:
 	 */
 	uint32 readUint32BE() {
 		uint32 val;
-		if (read(&val, 4) != 4)
-			throw Exception(kReadError);
+		readFixed(&val, 4);
 
 		return FROM_BE_32(val);
 	}
@@ -176,8 +176,7 @@ public:
 	 */
 	uint64 readUint64BE() {
 		uint64 val;
-		if (read(&val, 8) != 8)
-			throw Exception(kReadError);
+		readFixed(&val, 8);
 
 		return FROM_BE_64(val);
 	}
@@ -258,6 +257,73 @@ public:
 	 *  When reading fails, a kReadError exception is thrown.
 	 */
 	MemoryReadStream *readStream(size_t dataSize);
+
+	/** Read count little endian (LSB first) values of type T into an array.
+	 *
+	 *  T must be an integer or IEEE floating point type of 1, 2, 4 or 8 bytes.
+	 *  The whole array is read with a single read() and then byte-swapped in
+	 *  place, if necessary, which is considerably faster than reading the
+	 *  values one by one.
+	 *
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	template<typename T>
+	void readArrayLE(T *data, size_t count) {
+		readArray(data, count, sizeof(T));
+
+#ifdef XOREOS_BIG_ENDIAN
+		swapArray(data, count, sizeof(T));
+#endif
+	}
+
+	/** Read count big endian (MSB first) values of type T into an array.
+	 *
+	 *  T must be an integer or IEEE floating point type of 1, 2, 4 or 8 bytes.
+	 *  The whole array is read with a single read() and then byte-swapped in
+	 *  place, if necessary.
+	 *
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	template<typename T>
+	void readArrayBE(T *data, size_t count) {
+		readArray(data, count, sizeof(T));
+
+#ifndef XOREOS_BIG_ENDIAN
+		swapArray(data, count, sizeof(T));
+#endif
+	}
+
+protected:
+	/** The direct read window.
+	 *
+	 *  Streams that have their data available in memory can point this window
+	 *  to the bytes between the current position and the end of the stream.
+	 *  The primitive read methods (readByte(), readUint32LE(), ...) then take
+	 *  these bytes directly, without going through the virtual read() at all.
+	 *
+	 *  A stream that uses the window has to use _bufferPos as its current
+	 *  position, since it is advanced by the primitive read methods. For all
+	 *  other streams, the window stays empty.
+	 */
+	const byte *_bufferPos;
+	const byte *_bufferEnd; ///< The end of the direct read window.
+
+private:
+	/** Read a fixed number of bytes, preferably from the direct read window. */
+	FORCEINLINE void readFixed(void *dataPtr, size_t dataSize) {
+		if ((size_t)(_bufferEnd - _bufferPos) >= dataSize) {
+			std::memcpy(dataPtr, _bufferPos, dataSize);
+			_bufferPos += dataSize;
+			return;
+		}
+
+		if (read(dataPtr, dataSize) != dataSize)
+			throw Exception(kReadError);
+	}
+
+	void readArray(void *data, size_t count, size_t size);
+
+	static void swapArray(void *data, size_t count, size_t size);
 };
 
 
@@ -318,6 +384,30 @@ public:
 		return seek(offset, kOriginCurrent);
 	}
 
+	/** Read data from an absolute position within the stream, without using
+	 *  or changing the current stream position.
+	 *
+	 *  Several threads may call readAt() on the same stream at the same time,
+	 *  as long as no thread uses the stream position concurrently. Streams
+	 *  that can't read from a position natively fall back to seeking, with
+	 *  all such fallback reads serialized by a global mutex.
+	 *
+	 *  @param  offset the position to read from, measured from the start of the stream.
+	 *  @param  dataPtr pointer to a buffer into which the data is read.
+	 *  @param  dataSize number of bytes to be read.
+	 *  @return the number of bytes which were actually read.
+	 */
+	virtual size_t readAt(size_t offset, void *dataPtr, size_t dataSize) const;
+
+	/** Read the specified amount of data from an absolute position into a new[]'ed
+	 *  buffer, which then is wrapped into a MemoryReadStream.
+	 *
+	 *  Like readAt(), this does not use or change the current stream position.
+	 *
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	MemoryReadStream *readStreamAt(size_t offset, size_t dataSize) const;
+
 	/** Evaluate the seek offset relative to whence into a position from the beginning. */
 	static size_t evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size);
 };
@@ -367,6 +457,8 @@ public:
 
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize) const;
+
 protected:
 	SeekableReadStream *_parentStream;
 
@@ -45,6 +45,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/threads.h \
     src/common/thread.h \
     src/common/mutex.h \
+    src/common/threadpool.h \
     src/common/ustring.h \
     src/common/hash.h \
     src/common/md5.h \
@@ -54,6 +55,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/error.h \
     src/common/util.h \
     src/common/strutil.h \
+    src/common/stringarena.h \
     src/common/encoding.h \
     src/common/platform.h \
     src/common/debugman.h \
@@ -69,6 +71,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/stringmap.h \
     src/common/readline.h \
     src/common/readfile.h \
+    src/common/mappedfile.h \
     src/common/writefile.h \
     src/common/filepath.h \
     src/common/filelist.h \
@@ -100,6 +103,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/threads.cpp \
     src/common/thread.cpp \
     src/common/mutex.cpp \
+    src/common/threadpool.cpp \
     src/common/ustring.cpp \
     src/common/md5.cpp \
     src/common/blowfish.cpp \
@@ -108,6 +112,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/error.cpp \
     src/common/util.cpp \
     src/common/strutil.cpp \
+    src/common/stringarena.cpp \
     src/common/encoding.cpp \
     src/common/platform.cpp \
     src/common/debugman.cpp \
@@ -122,6 +127,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/stringmap.cpp \
     src/common/readline.cpp \
     src/common/readfile.cpp \
+    src/common/mappedfile.cpp \
     src/common/writefile.cpp \
     src/common/filepath.cpp \
     src/common/filelist.cpp \
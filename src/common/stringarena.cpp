@@ -0,0 +1,146 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  An arena of interned, immutable strings.
+ */
+
+#include <cstring>
+
+#include "src/common/stringarena.h"
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/hash.h"
+
+namespace Common {
+
+StringArena::StringArena() : _blockFree(0), _size(0), _count(0) {
+}
+
+StringArena::~StringArena() {
+	clear();
+}
+
+void StringArena::clear() {
+	for (std::vector<char *>::iterator b = _blocks.begin(); b != _blocks.end(); ++b)
+		delete[] *b;
+
+	_blocks.clear();
+	_strings.clear();
+
+	_blockFree = 0;
+	_size      = 0;
+	_count     = 0;
+}
+
+size_t StringArena::getCount() const {
+	return _count;
+}
+
+size_t StringArena::getSize() const {
+	return _size;
+}
+
+const char *StringArena::intern(const UString &str) {
+	return intern(str.c_str());
+}
+
+const char *StringArena::intern(const char *str) {
+	if (!str || !*str)
+		return "";
+
+	const size_t length = std::strlen(str);
+	const uint32 strHash = hash(str, length);
+
+	if (!_strings.empty()) {
+		const char *existing = _strings[findSlot(str, strHash)];
+		if (existing)
+			return existing;
+	}
+
+	// Keep the set at most half full
+	if (((_count + 1) * 2) > _strings.size())
+		grow();
+
+	char *copy = allocate(length + 1);
+	std::memcpy(copy, str, length + 1);
+
+	_strings[findSlot(str, strHash)] = copy;
+	_count++;
+
+	return copy;
+}
+
+char *StringArena::allocate(size_t size) {
+	if (size > (kBlockSize / 4)) {
+		// Large strings get their own block, keeping the current block at the end
+
+		char *block = new char[size];
+		_blocks.insert(_blocks.empty() ? _blocks.end() : (_blocks.end() - 1), block);
+
+		_size += size;
+		return block;
+	}
+
+	if (size > _blockFree) {
+		_blocks.push_back(new char[kBlockSize]);
+
+		_blockFree = kBlockSize;
+		_size     += kBlockSize;
+	}
+
+	char *str = _blocks.back() + (kBlockSize - _blockFree);
+	_blockFree -= size;
+
+	return str;
+}
+
+void StringArena::grow() {
+	std::vector<const char *> strings(MAX<size_t>(_strings.size() * 2, 1024), 0);
+	_strings.swap(strings);
+
+	for (std::vector<const char *>::const_iterator s = strings.begin(); s != strings.end(); ++s) {
+		if (!*s)
+			continue;
+
+		const size_t length = std::strlen(*s);
+		_strings[findSlot(*s, hash(*s, length))] = *s;
+	}
+}
+
+size_t StringArena::findSlot(const char *str, uint32 strHash) const {
+	const size_t mask = _strings.size() - 1;
+
+	for (size_t slot = strHash & mask; ; slot = (slot + 1) & mask) {
+		const char *s = _strings[slot];
+		if (!s || (std::strcmp(s, str) == 0))
+			return slot;
+	}
+}
+
+uint32 StringArena::hash(const char *str, size_t length) {
+	uint32 h = 0x811C9DC5;
+	for (size_t i = 0; i < length; i++)
+		h = hashFNV32(h, (byte) str[i]);
+
+	return h;
+}
+
+} // End of namespace Common
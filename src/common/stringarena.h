@@ -0,0 +1,89 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  An arena of interned, immutable strings.
+ */
+
+#ifndef COMMON_STRINGARENA_H
+#define COMMON_STRINGARENA_H
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+
+namespace Common {
+
+class UString;
+
+/** An arena of interned, immutable strings.
+ *
+ *  Strings are copied into large, contiguous blocks of memory, and each
+ *  distinct string is only stored once. Interning the same string again
+ *  returns the same pointer, so interned strings can be compared by their
+ *  address.
+ *
+ *  Interned strings stay valid until the arena is cleared or destroyed;
+ *  they can't be removed individually.
+ */
+class StringArena : boost::noncopyable {
+public:
+	StringArena();
+	~StringArena();
+
+	/** Remove all strings from the arena, invalidating all interned strings. */
+	void clear();
+
+	/** Return the number of distinct strings in the arena. */
+	size_t getCount() const;
+	/** Return the number of bytes allocated by the arena. */
+	size_t getSize() const;
+
+	/** Intern this string, returning the arena's copy of it. */
+	const char *intern(const char *str);
+	/** Intern this string, returning the arena's copy of it. */
+	const char *intern(const UString &str);
+
+private:
+	/** The size of a block of string memory. */
+	static const size_t kBlockSize = 64 * 1024;
+
+	std::vector<char *> _blocks; ///< All allocated blocks of string memory.
+
+	size_t _blockFree; ///< Number of bytes still free in the current block.
+	size_t _size;      ///< Number of bytes allocated in all blocks.
+
+	/** Open-addressing set of all interned strings, 0 marking empty slots. */
+	std::vector<const char *> _strings;
+	size_t _count; ///< Number of strings in the set.
+
+	char *allocate(size_t size);
+
+	void grow();
+	size_t findSlot(const char *str, uint32 hash) const;
+
+	static uint32 hash(const char *str, size_t length);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_STRINGARENA_H
@@ -0,0 +1,138 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A pool of worker threads.
+ */
+
+#include <SDL_cpuinfo.h>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/threadpool.h"
+
+namespace Common {
+
+ThreadPool::Worker::Worker(ThreadPool &pool) : _pool(&pool) {
+}
+
+ThreadPool::Worker::~Worker() {
+}
+
+void ThreadPool::Worker::threadMethod() {
+	_pool->runJobs();
+}
+
+
+ThreadPool::ThreadPool(size_t threadCount) : _running(0), _alive(0), _quit(false),
+	_jobAdded(_mutex), _jobsDone(_mutex) {
+
+	if (threadCount == 0)
+		threadCount = getCPUCount();
+
+	_workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++) {
+		_workers.push_back(new Worker(*this));
+
+		if (!_workers.back()->createThread()) {
+			_workers.pop_back();
+			break;
+		}
+
+		_alive++;
+	}
+
+	if (_workers.empty())
+		throw Exception("Failed creating thread pool worker threads");
+}
+
+ThreadPool::~ThreadPool() {
+	_mutex.lock();
+
+	_quit = true;
+	_jobAdded.broadcast();
+
+	/* Wait for the workers to finish their current jobs, so that destroying
+	 * the threads afterwards doesn't run into a timeout. */
+	while (_alive > 0)
+		_jobsDone.wait();
+
+	_mutex.unlock();
+
+	_workers.clear();
+}
+
+size_t ThreadPool::getThreadCount() const {
+	return _workers.size();
+}
+
+size_t ThreadPool::getCPUCount() {
+	return MAX<int>(SDL_GetCPUCount(), 1);
+}
+
+void ThreadPool::addJob(const Job &job) {
+	StackLock lock(_mutex);
+
+	_jobs.push_back(job);
+	_jobAdded.signal();
+}
+
+void ThreadPool::wait() {
+	StackLock lock(_mutex);
+
+	while (!_jobs.empty() || (_running > 0))
+		_jobsDone.wait();
+}
+
+void ThreadPool::runJobs() {
+	_mutex.lock();
+
+	while (!_quit) {
+		if (_jobs.empty()) {
+			_jobAdded.wait();
+			continue;
+		}
+
+		Job job = _jobs.front();
+		_jobs.pop_front();
+		_running++;
+
+		_mutex.unlock();
+
+		try {
+			job();
+		} catch (...) {
+			exceptionDispatcherWarning("Thread pool job failed");
+		}
+
+		_mutex.lock();
+
+		_running--;
+		if (_jobs.empty() && (_running == 0))
+			_jobsDone.broadcast();
+	}
+
+	_alive--;
+	_jobsDone.broadcast();
+
+	_mutex.unlock();
+}
+
+} // End of namespace Common
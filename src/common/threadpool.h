@@ -0,0 +1,107 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A pool of worker threads.
+ */
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include <list>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+
+#include "src/common/types.h"
+#include "src/common/mutex.h"
+#include "src/common/thread.h"
+#include "src/common/ptrvector.h"
+
+namespace Common {
+
+/** A pool of worker threads, running jobs in parallel.
+ *
+ *  Jobs are run in the order they were added, but since several jobs run
+ *  at the same time, they might finish in any order. A job is allowed to
+ *  add further jobs to the pool.
+ *
+ *  Exceptions thrown by a job are caught and printed as a warning. Jobs
+ *  that need to report errors back should catch them on their own.
+ *
+ *  Jobs that haven't been started yet when the pool is destroyed are dropped.
+ */
+class ThreadPool : boost::noncopyable {
+public:
+	typedef boost::function<void ()> Job;
+
+	/** Create a thread pool.
+	 *
+	 *  @param threadCount The number of worker threads. 0 means one
+	 *                     thread for each logical CPU core.
+	 */
+	ThreadPool(size_t threadCount = 0);
+	~ThreadPool();
+
+	/** Return the number of worker threads. */
+	size_t getThreadCount() const;
+
+	/** Add a job to be run by one of the worker threads. */
+	void addJob(const Job &job);
+
+	/** Wait until all jobs added so far have finished. */
+	void wait();
+
+	/** Return the number of logical CPU cores. */
+	static size_t getCPUCount();
+
+private:
+	/** A worker thread, running the jobs of its pool. */
+	class Worker : public Thread {
+	public:
+		Worker(ThreadPool &pool);
+		~Worker();
+
+	private:
+		ThreadPool *_pool;
+
+		void threadMethod();
+	};
+
+	typedef std::list<Job> JobQueue;
+
+	PtrVector<Worker> _workers;
+
+	JobQueue _jobs;    ///< Jobs not yet started.
+	size_t   _running; ///< Number of currently running jobs.
+	size_t   _alive;   ///< Number of worker threads that haven't quit yet.
+	bool     _quit;    ///< Should the worker threads quit?
+
+	Mutex     _mutex;
+	Condition _jobAdded;
+	Condition _jobsDone;
+
+	void runJobs();
+};
+
+} // End of namespace Common
+
+#endif // COMMON_THREADPOOL_H
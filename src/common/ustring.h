@@ -63,6 +63,13 @@ public:
 		}
 	};
 
+	// Case insensitive equality, for use with hashUStringCaseInsensitive
+	struct iequal : std::binary_function<UString, UString, bool> {
+		bool operator() (const UString &str1, const UString &str2) const {
+			return str1.equalsIgnoreCase(str2);
+		}
+	};
+
 	/** Construct an empty string. */
 	UString();
 	/** Copy constructor. */
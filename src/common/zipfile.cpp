@@ -126,29 +126,26 @@ const ZipFile::IFile &ZipFile::getIFile(uint32 index) const {
 	return _iFiles[index];
 }
 
-void ZipFile::getFileProperties(SeekableReadStream &zip, const IFile &file,
-		uint16 &compMethod, uint32 &compSize, uint32 &realSize) const {
+void ZipFile::getFileProperties(const SeekableReadStream &zip, const IFile &file, uint16 &compMethod,
+		uint32 &compSize, uint32 &realSize, uint32 &dataOffset) const {
 
-	zip.seek(file.offset);
+	// Read the local file header without touching the stream position
+	byte header[30];
+	if (zip.readAt(file.offset, header, sizeof(header)) != sizeof(header))
+		throw Exception(kReadError);
 
-	uint32 tag = zip.readUint32LE();
+	uint32 tag = READ_LE_UINT32(header);
 	if (tag != 0x04034B50)
 		throw Exception("Unknown ZIP record %08X", tag);
 
-	zip.skip(4);
-
-	compMethod = zip.readUint16LE();
-
-	zip.skip(8);
+	compMethod = READ_LE_UINT16(header +  8);
+	compSize   = READ_LE_UINT32(header + 18);
+	realSize   = READ_LE_UINT32(header + 22);
 
-	compSize = zip.readUint32LE();
-	realSize = zip.readUint32LE();
+	uint16 nameLength  = READ_LE_UINT16(header + 26);
+	uint16 extraLength = READ_LE_UINT16(header + 28);
 
-	uint16 nameLength  = zip.readUint16LE();
-	uint16 extraLength = zip.readUint16LE();
-
-	zip.skip(nameLength);
-	zip.skip(extraLength);
+	dataOffset = file.offset + sizeof(header) + nameLength + extraLength;
 }
 
 size_t ZipFile::getFileSize(uint32 index) const {
@@ -161,28 +158,33 @@ SeekableReadStream *ZipFile::getFile(uint32 index, bool tryNoCopy) const {
 	uint16 compMethod;
 	uint32 compSize;
 	uint32 realSize;
+	uint32 dataOffset;
 
-	getFileProperties(*_zip, file, compMethod, compSize, realSize);
+	getFileProperties(*_zip, file, compMethod, compSize, realSize, dataOffset);
 
 	if (tryNoCopy && (compMethod == 0))
-		return new SeekableSubReadStream(_zip.get(), _zip->pos(), _zip->pos() + compSize);
+		return createSubReadStream(*_zip, dataOffset, dataOffset + compSize);
 
-	return decompressFile(*_zip, compMethod, compSize, realSize);
+	return decompressFile(_zip->readStreamAt(dataOffset, compSize), compMethod, compSize, realSize);
 }
 
-SeekableReadStream *ZipFile::decompressFile(SeekableReadStream &zip, uint32 method,
+SeekableReadStream *ZipFile::decompressFile(SeekableReadStream *compStream, uint32 method,
 		uint32 compSize, uint32 realSize) {
 
+	assert(compStream);
+
 	if (method == 0) {
 		// Uncompressed
 
-		return zip.readStream(compSize);
+		return compStream;
 	}
 
+	ScopedPtr<SeekableReadStream> stream(compStream);
+
 	if (method != 8)
 		throw Exception("Unhandled Zip compression %d", method);
 
-	return decompressDeflate(zip, compSize, realSize, kWindowBitsMaxRaw);
+	return decompressDeflate(*stream, compSize, realSize, kWindowBitsMaxRaw);
 }
 
 #define BUFREADCOMMENT (0x400)
@@ -58,7 +58,10 @@ public:
 	/** Return the size of a file. */
 	size_t getFileSize(uint32 index) const;
 
-	/** Return a stream of the file's contents. */
+	/** Return a stream of the file's contents.
+	 *
+	 *  This method may be called from several threads at once.
+	 */
 	SeekableReadStream *getFile(uint32 index, bool tryNoCopy = false) const;
 
 private:
@@ -81,12 +84,12 @@ private:
 	void load(SeekableReadStream &zip);
 	size_t findCentralDirectoryEnd(SeekableReadStream &zip);
 
-	static SeekableReadStream *decompressFile(SeekableReadStream &zip, uint32 method,
+	static SeekableReadStream *decompressFile(SeekableReadStream *compStream, uint32 method,
 			uint32 compSize, uint32 realSize);
 
 	const IFile &getIFile(uint32 index) const;
-	void getFileProperties(SeekableReadStream &zip, const IFile &file,
-			uint16 &compMethod, uint32 &compSize, uint32 &realSize) const;
+	void getFileProperties(const SeekableReadStream &zip, const IFile &file, uint16 &compMethod,
+			uint32 &compSize, uint32 &realSize, uint32 &dataOffset) const;
 };
 
 } // End of namespace Common
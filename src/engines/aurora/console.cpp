@@ -37,6 +37,8 @@
 #include "src/aurora/resman.h"
 #include "src/aurora/talkman.h"
 
+#include "src/aurora/nwscript/profiler.h"
+
 #include "src/graphics/graphics.h"
 #include "src/graphics/font.h"
 #include "src/graphics/camera.h"
@@ -728,6 +730,14 @@ Console::Console(Engine &engine, const Common::UString &font, int fontHeight) :
 			"Usage: dump2da <2da>\nDump a 2DA to file");
 	registerCommand("dumpall2da" , boost::bind(&Console::cmdDumpAll2DA , this, _1),
 			"Usage: dumpall2da\nDump all 2DA to file");
+	registerCommand("rescache"   , boost::bind(&Console::cmdResCache   , this, _1),
+			"Usage: rescache [clear|<size in MiB>]\nPrint the resource cache statistics, "
+			"clear the resource cache or change its size");
+	registerCommand("scriptprofile", boost::bind(&Console::cmdScriptProfile, this, _1),
+			"Usage: scriptprofile [on|off|reset]\nPrint the most expensive scripts, subroutines and "
+			"engine functions, or enable, disable or reset the script profiler");
+	registerCommand("dumpscriptprofile", boost::bind(&Console::cmdDumpScriptProfile, this, _1),
+			"Usage: dumpscriptprofile <file>\nDump the complete script profile to file");
 	registerCommand("listvideos" , boost::bind(&Console::cmdListVideos , this, _1),
 			"Usage: listvideos\nList all available videos");
 	registerCommand("playvideo"  , boost::bind(&Console::cmdPlayVideo  , this, _1),
@@ -1254,6 +1264,91 @@ void Console::cmdDumpAll2DA(const CommandLine &UNUSED(cl)) {
 	}
 }
 
+void Console::cmdResCache(const CommandLine &cl) {
+	if (cl.args == "clear") {
+		ResMan.clearCache();
+		printf("Cleared the resource cache");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		uint64 size = 0;
+		try {
+			Common::parseString(cl.args, size);
+		} catch (...) {
+			printCommandHelp(cl.cmd);
+			return;
+		}
+
+		if (size > (SIZE_MAX / (1024 * 1024))) {
+			printf("Invalid resource cache size %s MiB: at most %s MiB are possible",
+			       Common::composeString(size).c_str(),
+			       Common::composeString((uint64) (SIZE_MAX / (1024 * 1024))).c_str());
+			return;
+		}
+
+		ResMan.setCacheSize((size_t) size * 1024 * 1024);
+	}
+
+	Aurora::ResourceCache::Statistics stats;
+	ResMan.getCacheStatistics(stats);
+
+	const uint64 lookups = stats.hits + stats.misses;
+	const double hitRate = (lookups > 0) ? ((100.0 * stats.hits) / lookups) : 0.0;
+
+	printf("Resource cache: %u resources, %.2f of %.2f MiB", (uint)stats.count,
+	       stats.size / (1024.0 * 1024.0), stats.capacity / (1024.0 * 1024.0));
+	printf("Hits: %s, Misses: %s (%.1f%% hit rate), Evictions: %s",
+	       Common::composeString(stats.hits).c_str(), Common::composeString(stats.misses).c_str(),
+	       hitRate, Common::composeString(stats.evictions).c_str());
+}
+
+void Console::cmdScriptProfile(const CommandLine &cl) {
+	if        (cl.args == "on") {
+		ScriptProfiler.setEnabled(true);
+		printf("Enabled the script profiler");
+		return;
+	} else if (cl.args == "off") {
+		ScriptProfiler.setEnabled(false);
+		printf("Disabled the script profiler");
+		return;
+	} else if (cl.args == "reset") {
+		ScriptProfiler.reset();
+		printf("Reset the script profiler");
+		return;
+	} else if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	if (!ScriptProfiler.isEnabled())
+		printf("The script profiler is disabled. Enable it with \"scriptprofile on\"");
+
+	std::vector<Common::UString> report;
+	ScriptProfiler.getReport(report, 10);
+
+	for (std::vector<Common::UString>::const_iterator l = report.begin(); l != report.end(); ++l)
+		print(*l);
+}
+
+void Console::cmdDumpScriptProfile(const CommandLine &cl) {
+	if (cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	Common::UString file = Common::FilePath::getUserDataFile(cl.args);
+
+	try {
+		ScriptProfiler.dump(file);
+	} catch (Common::Exception &e) {
+		printException(e, "Failed dumping the script profile: ");
+		return;
+	}
+
+	printf("Dumped the script profile to file \"%s\"", file.c_str());
+}
+
 void Console::cmdListVideos(const CommandLine &UNUSED(cl)) {
 	updateVideos();
 	printList(_videos, _maxSizeVideos);
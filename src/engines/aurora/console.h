@@ -292,6 +292,9 @@ private:
 	void cmdDumpTGA    (const CommandLine &cl);
 	void cmdDump2DA    (const CommandLine &cl);
 	void cmdDumpAll2DA (const CommandLine &cl);
+	void cmdResCache   (const CommandLine &cl);
+	void cmdScriptProfile    (const CommandLine &cl);
+	void cmdDumpScriptProfile(const CommandLine &cl);
 	void cmdListVideos (const CommandLine &cl);
 	void cmdPlayVideo  (const CommandLine &cl);
 	void cmdListSounds (const CommandLine &cl);
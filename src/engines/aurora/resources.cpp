@@ -172,4 +172,60 @@ void deindexResources(ChangeList &changes) {
 	changes.clear();
 }
 
+
+ArchiveBatch::ArchiveBatch() {
+}
+
+ArchiveBatch::~ArchiveBatch() {
+}
+
+void ArchiveBatch::addMandatory(const Common::UString &file, uint32 priority, Common::ChangeID *changeID) {
+	_archives.push_back(Archive());
+
+	_archives.back().file     = file;
+	_archives.back().priority = priority;
+	_archives.back().changeID = changeID;
+}
+
+void ArchiveBatch::addMandatory(const Common::UString &file, uint32 priority, ChangeList &changes) {
+	changes.push_back(Common::ChangeID());
+	addMandatory(file, priority, &changes.back());
+}
+
+bool ArchiveBatch::addOptional(const Common::UString &file, uint32 priority, Common::ChangeID *changeID) {
+	if (!ResMan.hasArchive(file))
+		return false;
+
+	addMandatory(file, priority, changeID);
+	return true;
+}
+
+bool ArchiveBatch::addOptional(const Common::UString &file, uint32 priority, ChangeList &changes) {
+	if (!ResMan.hasArchive(file))
+		return false;
+
+	addMandatory(file, priority, changes);
+	return true;
+}
+
+void ArchiveBatch::index() {
+	std::vector<Aurora::ResourceManager::ArchiveRequest> archives;
+	archives.reserve(_archives.size());
+
+	for (std::vector<Archive>::const_iterator a = _archives.begin(); a != _archives.end(); ++a)
+		archives.push_back(Aurora::ResourceManager::ArchiveRequest(a->file, a->priority, a->changeID));
+
+	_archives.clear();
+
+	if (EventMan.quitRequested() || archives.empty())
+		return;
+
+	try {
+		ResMan.indexArchives(archives);
+	} catch (Common::Exception &e) {
+		e.add("Failed to index archives");
+		throw;
+	}
+}
+
 } // End of namespace Engines
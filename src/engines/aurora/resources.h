@@ -29,13 +29,10 @@
 #include <vector>
 
 #include "src/common/changeid.h"
+#include "src/common/ustring.h"
 
 #include "src/aurora/types.h"
 
-namespace Common {
-	class UString;
-}
-
 namespace Engines {
 
 typedef std::list<Common::ChangeID> ChangeList;
@@ -72,6 +69,45 @@ bool indexOptionalDirectory(const Common::UString &dir, const char *glob, int de
 void deindexResources(Common::ChangeID &changeID);
 void deindexResources(ChangeList &changes);
 
+/** A batch of archives to be indexed together.
+ *
+ *  The archives are opened and parsed in parallel, but their resources
+ *  are added in the order the archives were added to the batch.
+ */
+class ArchiveBatch {
+public:
+	ArchiveBatch();
+	~ArchiveBatch();
+
+	/** Add an archive that has to exist. */
+	void addMandatory(const Common::UString &file, uint32 priority, Common::ChangeID *changeID = 0);
+	/** Add an archive that has to exist. */
+	void addMandatory(const Common::UString &file, uint32 priority, ChangeList &changes);
+
+	/** Add an archive, if it exists.
+	 *
+	 *  @return true if the archive exists and was added, false otherwise.
+	 */
+	bool addOptional(const Common::UString &file, uint32 priority, Common::ChangeID *changeID = 0);
+	/** Add an archive, if it exists.
+	 *
+	 *  @return true if the archive exists and was added, false otherwise.
+	 */
+	bool addOptional(const Common::UString &file, uint32 priority, ChangeList &changes);
+
+	/** Index all archives added so far, and empty the batch. */
+	void index();
+
+private:
+	struct Archive {
+		Common::UString file;
+		uint32 priority;
+		Common::ChangeID *changeID;
+	};
+
+	std::vector<Archive> _archives;
+};
+
 } // End of namespace Engines
 
 #endif // ENGINES_AURORA_RESOURCES_H
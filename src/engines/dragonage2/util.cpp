@@ -25,6 +25,7 @@
 #include "src/common/ustring.h"
 
 #include "src/aurora/2dareg.h"
+#include "src/aurora/2dafile.h"
 #include "src/aurora/gdafile.h"
 
 #include "src/engines/dragonage2/util.h"
@@ -34,9 +35,9 @@ namespace Engines {
 namespace DragonAge2 {
 
 const Aurora::GDAFile &getMGDA(uint32 id) {
-	const Aurora::GDAFile &m2da  = TwoDAReg.getMGDA("m2da_");
+	const Aurora::TwoDAFile &m2da = TwoDAReg.getM2DA("m2da_");
 
-	const Common::UString sheetName = m2da.getString(m2da.findRow(id), "Worksheet");
+	const Common::UString sheetName = m2da.getRow("ID", Common::UString::format("%d", (int) id)).getString("Worksheet");
 
 	return TwoDAReg.getMGDA(sheetName);
 }
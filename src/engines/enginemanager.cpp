@@ -28,6 +28,7 @@
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
+#include "src/common/hash.h"
 #include "src/common/readfile.h"
 #include "src/common/filelist.h"
 #include "src/common/filepath.h"
@@ -41,6 +42,9 @@
 #include "src/aurora/talkman.h"
 #include "src/aurora/2dareg.h"
 
+#include "src/aurora/nwscript/ncsprogram.h"
+#include "src/aurora/nwscript/profiler.h"
+
 #include "src/graphics/graphics.h"
 
 #include "src/graphics/aurora/cursorman.h"
@@ -98,6 +102,14 @@ private:
 
 	void createEngine();
 	void destroyEngine();
+
+	Common::UString getResourceIndexFile() const;
+	void loadResourceIndex();
+	void saveResourceIndex();
+
+	Common::UString getTwoDASnapshotFile() const;
+	void loadTwoDASnapshot();
+	void saveTwoDASnapshot();
 };
 
 GameInstanceEngine::GameInstanceEngine(const Common::UString &target) : _target(target), _probe(0) {
@@ -219,11 +231,83 @@ void GameInstanceEngine::listLanguages() {
 void GameInstanceEngine::run() {
 	createEngine();
 
+	loadResourceIndex();
+	loadTwoDASnapshot();
+
 	_engine->start(_probe->getGameID(), _target, _probe->getPlatform());
 
+	saveTwoDASnapshot();
+	saveResourceIndex();
+
 	destroyEngine();
 }
 
+Common::UString GameInstanceEngine::getResourceIndexFile() const {
+	if (!ConfigMan.getBool("resourceindex", true))
+		return "";
+
+	// One index file per game, identified by the game's path
+	const uint64 hash = Common::hashString(Common::FilePath::canonicalize(_target), Common::kHashFNV64);
+
+	return Common::FilePath::getUserDataFile("resindex/" + Common::formatHash(hash) + ".xri");
+}
+
+void GameInstanceEngine::loadResourceIndex() {
+	const Common::UString indexFile = getResourceIndexFile();
+	if (indexFile.empty())
+		return;
+
+	if (ResMan.loadIndex(indexFile))
+		status("Loaded resource index \"%s\"", indexFile.c_str());
+}
+
+void GameInstanceEngine::saveResourceIndex() {
+	const Common::UString indexFile = getResourceIndexFile();
+	if (indexFile.empty())
+		return;
+
+	try {
+		Common::FilePath::createDirectories(Common::FilePath::getDirectory(indexFile));
+
+		ResMan.saveIndex(indexFile);
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed to save resource index \"%s\"", indexFile.c_str());
+	}
+}
+
+Common::UString GameInstanceEngine::getTwoDASnapshotFile() const {
+	if (!ConfigMan.getBool("2dasnapshot", true))
+		return "";
+
+	// One snapshot file per game, identified by the game's path
+	const uint64 hash = Common::hashString(Common::FilePath::canonicalize(_target), Common::kHashFNV64);
+
+	return Common::FilePath::getUserDataFile("2dasnapshot/" + Common::formatHash(hash) + ".x2s");
+}
+
+void GameInstanceEngine::loadTwoDASnapshot() {
+	const Common::UString snapshotFile = getTwoDASnapshotFile();
+	if (snapshotFile.empty())
+		return;
+
+	if (TwoDAReg.loadSnapshot(snapshotFile))
+		status("Loaded 2DA snapshot \"%s\"", snapshotFile.c_str());
+}
+
+void GameInstanceEngine::saveTwoDASnapshot() {
+	const Common::UString snapshotFile = getTwoDASnapshotFile();
+	if (snapshotFile.empty())
+		return;
+
+	try {
+		Common::FilePath::createDirectories(Common::FilePath::getDirectory(snapshotFile));
+
+		TwoDAReg.saveSnapshot(snapshotFile);
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed to save 2DA snapshot \"%s\"", snapshotFile.c_str());
+	}
+}
+
 
 GameInstance *EngineManager::probeGame(const Common::UString &target,
                                        const std::list<const EngineProbe *> &probes) const {
@@ -270,6 +354,9 @@ void EngineManager::cleanup() const {
 		LangMan.clear();
 		TalkMan.clear();
 		TwoDAReg.clear();
+		TwoDAReg.clearSnapshot();
+		NCSCache.clear();
+		ScriptProfiler.reset();
 		ResMan.clear();
 
 		ConfigMan.setGame();
@@ -78,8 +78,15 @@ Area::~Area() {
 }
 
 void Area::load() {
-	loadLYT(); // Room layout
-	loadVIS(); // Room visibilities
+	// Read the area files in the background, while we're parsing what we've already got
+	Aurora::AsyncResourcePtr lyt = ResMan.getResourceAsync(_resRef, Aurora::kFileTypeLYT);
+	Aurora::AsyncResourcePtr vis = ResMan.getResourceAsync(_resRef, Aurora::kFileTypeVIS);
+
+	ResMan.prefetch(_resRef, Aurora::kFileTypeARE);
+	ResMan.prefetch(_resRef, Aurora::kFileTypeGIT);
+
+	loadLYT(*lyt); // Room layout
+	loadVIS(*vis); // Room visibilities
 
 	loadRooms();
 
@@ -227,9 +234,9 @@ void Area::hide() {
 	_visible = false;
 }
 
-void Area::loadLYT() {
+void Area::loadLYT(Aurora::AsyncResource &lytResource) {
 	try {
-		Common::ScopedPtr<Common::SeekableReadStream> lyt(ResMan.getResource(_resRef, Aurora::kFileTypeLYT));
+		Common::ScopedPtr<Common::SeekableReadStream> lyt(lytResource.take());
 		if (!lyt)
 			throw Common::Exception("No such LYT");
 
@@ -241,9 +248,9 @@ void Area::loadLYT() {
 	}
 }
 
-void Area::loadVIS() {
+void Area::loadVIS(Aurora::AsyncResource &visResource) {
 	try {
-		Common::ScopedPtr<Common::SeekableReadStream> vis(ResMan.getResource(_resRef, Aurora::kFileTypeVIS));
+		Common::ScopedPtr<Common::SeekableReadStream> vis(visResource.take());
 		if (!vis)
 			throw Common::Exception("No such VIS");
 
@@ -315,6 +322,16 @@ void Area::loadProperties(const Aurora::GFF3Struct &props) {
 
 void Area::loadRooms() {
 	const Aurora::LYTFile::RoomArray &rooms = _lyt.getRooms();
+
+	// Read all room models in the background, while the first ones are already being loaded
+	for (Aurora::LYTFile::RoomArray::const_iterator r = rooms.begin(); r != rooms.end(); ++r) {
+		if (r->model == "****")
+			continue;
+
+		ResMan.prefetch(r->model, Aurora::kFileTypeMDL);
+		ResMan.prefetch(r->model, Aurora::kFileTypeMDX);
+	}
+
 	for (Aurora::LYTFile::RoomArray::const_iterator r = rooms.begin(); r != rooms.end(); ++r)
 		_rooms.push_back(new Room(r->model, r->x, r->y, r->z));
 }
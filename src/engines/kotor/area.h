@@ -36,6 +36,7 @@
 #include "src/aurora/types.h"
 #include "src/aurora/lytfile.h"
 #include "src/aurora/visfile.h"
+#include "src/aurora/asyncresource.h"
 
 #include "src/sound/types.h"
 
@@ -165,8 +166,8 @@ private:
 	void clear();
 	void load();
 
-	void loadLYT();
-	void loadVIS();
+	void loadLYT(Aurora::AsyncResource &lyt);
+	void loadVIS(Aurora::AsyncResource &vis);
 
 	void loadARE(const Aurora::GFF3Struct &are);
 	void loadGIT(const Aurora::GFF3Struct &git);
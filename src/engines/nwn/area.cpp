@@ -23,10 +23,12 @@
  */
 
 #include <cassert>
+#include <set>
 
 #include "src/common/util.h"
 #include "src/common/error.h"
 
+#include "src/aurora/resman.h"
 #include "src/aurora/gff3file.h"
 #include "src/aurora/2dafile.h"
 #include "src/aurora/2dareg.h"
@@ -442,6 +444,15 @@ void Area::unloadTileset() {
 }
 
 void Area::loadTiles() {
+	// Read all tile models in the background, while the first ones are already being loaded
+	std::set<Common::UString> tileModels;
+	for (std::vector<Tile>::const_iterator t = _tiles.begin(); t != _tiles.end(); ++t) {
+		const Common::UString &model = _tileset->getTile(t->tileID).model;
+
+		if (tileModels.insert(model).second)
+			ResMan.prefetch(model, Aurora::kFileTypeMDL);
+	}
+
 	for (uint32 y = 0; y < _height; y++) {
 		for (uint32 x = 0; x < _width; x++) {
 			uint32 n = y * _width + x;
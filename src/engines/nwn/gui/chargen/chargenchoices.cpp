@@ -197,16 +197,21 @@ void CharGenChoices::setClass(uint32 classId) {
 	_classFeats.clear();
 	const Aurora::TwoDAFile &twodaClasses = TwoDAReg.get2DA("classes");
 	const Aurora::TwoDAFile &twodaClsFeat = TwoDAReg.get2DA(twodaClasses.getRow(classId).getString("FeatsTable"));
+
+	const size_t columnList      = twodaClsFeat.headerToColumn("List");
+	const size_t columnGranted   = twodaClsFeat.headerToColumn("GrantedOnLevel");
+	const size_t columnFeatIndex = twodaClsFeat.headerToColumn("FeatIndex");
+
 	for (size_t it = 0; it < twodaClsFeat.getRowCount(); ++it) {
 		const Aurora::TwoDARow &rowFeat = twodaClsFeat.getRow(it);
-		if (rowFeat.getInt("List") != 3)
+		if (rowFeat.getInt(columnList) != 3)
 			continue;
 
-		if (rowFeat.getInt("GrantedOnLevel") != _creature->getHitDice() + 1)
+		if (rowFeat.getInt(columnGranted) != _creature->getHitDice() + 1)
 			continue;
 
-		if (!hasFeat(rowFeat.getInt("FeatIndex")))
-			_classFeats.push_back(rowFeat.getInt("FeatIndex"));
+		if (!hasFeat(rowFeat.getInt(columnFeatIndex)))
+			_classFeats.push_back(rowFeat.getInt(columnFeatIndex));
 	}
 }
 
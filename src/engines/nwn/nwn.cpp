@@ -226,28 +226,34 @@ void NWNEngine::initResources(LoadProgress &progress) {
 
 	progress.step("Loading expansions and patch KEYs");
 
+	ArchiveBatch keys;
+
 	// Base game patch
-	indexOptionalArchive("patch.key", 11);
+	keys.addOptional("patch.key", 11);
 
 	// Expansion 1: Shadows of Undrentide (SoU)
-	_hasXP1 = ResMan.hasArchive("xp1.key");
-	indexOptionalArchive("xp1.key"     , 12);
-	indexOptionalArchive("xp1patch.key", 13);
+	_hasXP1 = keys.addOptional("xp1.key", 12);
+	keys.addOptional("xp1patch.key", 13);
 
 	// Expansion 2: Hordes of the Underdark (HotU)
-	_hasXP2 = ResMan.hasArchive("xp2.key");
-	indexOptionalArchive("xp2.key"     , 14);
-	indexOptionalArchive("xp2patch.key", 15);
+	_hasXP2 = keys.addOptional("xp2.key", 14);
+	keys.addOptional("xp2patch.key", 15);
 
 	// Expansion 3: Kingmaker (resources also included in the final 1.69 patch)
-	_hasXP3 = ResMan.hasArchive("xp3.key");
-	indexOptionalArchive("xp3.key"     , 16);
-	indexOptionalArchive("xp3patch.key", 17);
+	_hasXP3 = keys.addOptional("xp3.key", 16);
+	keys.addOptional("xp3patch.key", 17);
+
+	keys.index();
 
 	progress.step("Loading GUI textures");
-	indexMandatoryArchive("gui_32bit.erf", 50);
-	indexOptionalArchive ("xp1_gui.erf"  , 51);
-	indexOptionalArchive ("xp2_gui.erf"  , 52);
+
+	ArchiveBatch gui;
+
+	gui.addMandatory("gui_32bit.erf", 50);
+	gui.addOptional ("xp1_gui.erf"  , 51);
+	gui.addOptional ("xp2_gui.erf"  , 52);
+
+	gui.index();
 
 	progress.step("Indexing extra sound resources");
 	indexMandatoryDirectory("ambient"   , 0, 0, 100);
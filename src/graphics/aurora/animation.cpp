@@ -22,6 +22,10 @@
  *  An animation to be applied to a model.
  */
 
+#include <cassert>
+
+#include <algorithm>
+
 #include "src/common/readstream.h"
 #include "src/common/debug.h"
 
@@ -39,6 +43,27 @@ namespace Graphics {
 
 namespace Aurora {
 
+Animation::Track::Track(const ModelNode *a, ModelNode *t) : animNode(a), target(t),
+	positionFrame(0), orientationFrame(0) {
+
+}
+
+
+void Animation::PoseBuffer::add(ModelNode *target) {
+	targets.push_back(target);
+
+	factor.push_back(0.0f);
+	for (size_t i = 0; i < 4; i++) {
+		values[i].push_back(0.0f);
+		next  [i].push_back(0.0f);
+	}
+}
+
+
+Animation::Binding::Binding() : animation(0), scale(1.0f) {
+}
+
+
 Animation::Animation() : _length(0.0f), _transtime(0.0f) {
 
 }
@@ -68,24 +93,64 @@ void Animation::setTransTime(float transtime) {
 	_transtime = transtime;
 }
 
-void Animation::update(Model *model, float UNUSED(lastFrame), float nextFrame) {
-	// TODO: Also need to fire off associated events
-	//       for event in _events event->fire()
+void Animation::bind(Model *model, Binding &binding) const {
+	binding.animation = this;
+	binding.scale     = model->getAnimationScale(_name);
 
+	binding.tracks.clear();
+	binding.tracks.reserve(nodeList.size());
+
+	binding.positions    = PoseBuffer();
+	binding.orientations = PoseBuffer();
+
+	for (NodeList::const_iterator n = nodeList.begin(); n != nodeList.end(); ++n) {
+		const ModelNode *animNode = (*n)->_nodedata;
+		if (animNode->_positionFrames.empty() && animNode->_orientationFrames.empty())
+			continue;
 
-	float scale = model->getAnimationScale(_name);
-	for (NodeList::iterator n = nodeList.begin(); n != nodeList.end(); ++n) {
-		ModelNode *animNode = (*n)->_nodedata;
 		ModelNode *target = model->getNode(animNode->getName());
 		if (!target)
 			continue;
 
-		// Update position and orientation based on time
+		binding.tracks.push_back(Track(animNode, target));
+
 		if (!animNode->_positionFrames.empty())
-			interpolatePosition(animNode, target, nextFrame, scale);
+			binding.positions.add(target);
 		if (!animNode->_orientationFrames.empty())
-			interpolateOrientation(animNode, target, nextFrame);
+			binding.orientations.add(target);
+	}
+}
+
+void Animation::update(Binding &binding, float UNUSED(lastFrame), float nextFrame) const {
+	// TODO: Also need to fire off associated events
+	//       for event in _events event->fire()
+
+	/* Animations are only advanced by the GraphicsManager while it renders
+	 * a frame, possibly on a worker thread, so we mustn't lock the frame. */
+
+	assert(binding.animation == this);
+
+	// Find the keyframes surrounding the current time
+	size_t position = 0, orientation = 0;
+	for (std::vector<Track>::iterator t = binding.tracks.begin(); t != binding.tracks.end(); ++t) {
+		if (!t->animNode->_positionFrames.empty())
+			samplePosition(*t, nextFrame, binding.positions, position++);
+		if (!t->animNode->_orientationFrames.empty())
+			sampleOrientation(*t, nextFrame, binding.orientations, orientation++);
 	}
+
+	// Interpolate between them
+	blendPositions(binding.positions, binding.scale);
+	blendOrientations(binding.orientations);
+
+	// And update the nodes
+	const PoseBuffer &p = binding.positions;
+	for (size_t i = 0; i < p.targets.size(); i++)
+		p.targets[i]->doSetPosition(p.values[0][i], p.values[1][i], p.values[2][i]);
+
+	const PoseBuffer &o = binding.orientations;
+	for (size_t i = 0; i < o.targets.size(); i++)
+		o.targets[i]->doSetQuaternion(o.values[0][i], o.values[1][i], o.values[2][i], o.values[3][i]);
 }
 
 void Animation::addAnimNode(AnimNode *node) {
@@ -113,98 +178,155 @@ const ModelNode *Animation::getNode(const Common::UString &node) const {
 	return n->second->_nodedata;
 }
 
-/** Return the dot product of two quaternions. */
-static float dotQuaternion(float x1, float y1, float z1, float q1,
-                           float x2, float y2, float z2, float q2) {
+/** Compare a keyframe's time against a point in time. */
+struct KeyFrameTimeLess {
+	template<typename KeyFrame>
+	bool operator()(const KeyFrame &frame, float time) const {
+		return frame.time < time;
+	}
+};
+
+/** Find the last keyframe before the given point in time, or the first keyframe.
+ *
+ *  The keyframe found the last time is remembered in the cursor. Since the
+ *  time usually only advances a little between updates, the keyframe is
+ *  mostly either the same or the next one. Otherwise, we do a binary search.
+ */
+template<typename KeyFrame>
+static size_t findKeyFrame(const std::vector<KeyFrame> &frames, float time, size_t &cursor) {
+	for (size_t i = cursor; (i < frames.size()) && (i <= (cursor + 1)); i++) {
+		if (((i == 0) || (frames[i].time < time)) &&
+		    (((i + 1) >= frames.size()) || (frames[i + 1].time >= time))) {
+
+			cursor = i;
+			return cursor;
+		}
+	}
+
+	const size_t next = std::lower_bound(frames.begin(), frames.end(), time, KeyFrameTimeLess()) - frames.begin();
 
-	return x1 * x2 + y1 * y2 + z1 * z2 + q1 * q2;
+	cursor = (next > 0) ? (next - 1) : 0;
+	return cursor;
 }
 
-/** Normalize a quaternion. */
-static void normQuaternion(float  xIn , float  yIn , float  zIn , float  qIn,
-                           float &xOut, float &yOut, float &zOut, float &qOut) {
+void Animation::samplePosition(Track &track, float time, PoseBuffer &positions, size_t index) {
+	const std::vector<PositionKeyFrame> &frames = track.animNode->_positionFrames;
 
-	const float magnitude = sqrt(dotQuaternion(xIn, yIn, zIn, qIn, xIn, yIn, zIn, qIn));
+	const size_t lastFrame = findKeyFrame(frames, time, track.positionFrame);
 
-	xOut = xIn / magnitude;
-	yOut = yIn / magnitude;
-	zOut = zIn / magnitude;
-	qOut = qIn / magnitude;
-}
+	const PositionKeyFrame &last = frames[lastFrame];
+
+	positions.values[0][index] = last.x;
+	positions.values[1][index] = last.y;
+	positions.values[2][index] = last.z;
 
-void Animation::interpolatePosition(ModelNode *animNode, ModelNode *target, float time, float scale) const {
-	// If only one keyframe, don't interpolate, just set the only position
-	if (animNode->_positionFrames.size() == 1) {
-		const PositionKeyFrame &pos = animNode->_positionFrames[0];
-		target->setPosition(pos.x * scale, pos.y * scale, pos.z * scale);
+	// If there's no later keyframe, don't interpolate, just use the last one
+	if (lastFrame + 1 >= frames.size() || last.time >= time) {
+		positions.factor[index] = 0.0f;
+
+		positions.next[0][index] = last.x;
+		positions.next[1][index] = last.y;
+		positions.next[2][index] = last.z;
 		return;
 	}
 
-	size_t lastFrame = 0;
-	for (size_t i = 0; i < animNode->_positionFrames.size(); i++) {
-		const PositionKeyFrame &pos = animNode->_positionFrames[i];
-		if (pos.time >= time)
-			break;
+	const PositionKeyFrame &next = frames[lastFrame + 1];
 
-		lastFrame = i;
-	}
+	positions.factor[index] = (time - last.time) / (next.time - last.time);
+
+	positions.next[0][index] = next.x;
+	positions.next[1][index] = next.y;
+	positions.next[2][index] = next.z;
+}
+
+void Animation::sampleOrientation(Track &track, float time, PoseBuffer &orientations, size_t index) {
+	const std::vector<QuaternionKeyFrame> &frames = track.animNode->_orientationFrames;
+
+	const size_t lastFrame = findKeyFrame(frames, time, track.orientationFrame);
+
+	const QuaternionKeyFrame &last = frames[lastFrame];
 
-	const PositionKeyFrame &last = animNode->_positionFrames[lastFrame];
-	if (lastFrame + 1 >= animNode->_positionFrames.size() || last.time >= time) {
-		target->setPosition(last.x * scale, last.y * scale, last.z * scale);
+	orientations.values[0][index] = last.x;
+	orientations.values[1][index] = last.y;
+	orientations.values[2][index] = last.z;
+	orientations.values[3][index] = last.q;
+
+	// If there's no later keyframe, don't interpolate, just use the last one
+	if (lastFrame + 1 >= frames.size() || last.time >= time) {
+		orientations.factor[index] = 0.0f;
+
+		orientations.next[0][index] = last.x;
+		orientations.next[1][index] = last.y;
+		orientations.next[2][index] = last.z;
+		orientations.next[3][index] = last.q;
 		return;
 	}
 
-	const PositionKeyFrame &next = animNode->_positionFrames[lastFrame + 1];
+	const QuaternionKeyFrame &next = frames[lastFrame + 1];
+
+	orientations.factor[index] = (time - last.time) / (next.time - last.time);
 
-	const float f = (time - last.time) / (next.time - last.time);
-	const float x = f * next.x + (1.0f - f) * last.x;
-	const float y = f * next.y + (1.0f - f) * last.y;
-	const float z = f * next.z + (1.0f - f) * last.z;
-	target->setPosition(x * scale, y * scale, z * scale);
+	orientations.next[0][index] = next.x;
+	orientations.next[1][index] = next.y;
+	orientations.next[2][index] = next.z;
+	orientations.next[3][index] = next.q;
 }
 
-void Animation::interpolateOrientation(ModelNode *animNode, ModelNode *target, float time) const {
-	// If only one keyframe, don't interpolate just set the only orientation
-	if (animNode->_orientationFrames.size() == 1) {
-		const QuaternionKeyFrame &ori = animNode->_orientationFrames[0];
-		target->setOrientation(ori.x, ori.y, ori.z, Common::rad2deg(acos(ori.q) * 2.0));
+/* The blending functions work on plain arrays, one per component, with
+ * no dependencies between the nodes. This lets the compiler vectorize
+ * the loops, interpolating several nodes at once. */
+
+void Animation::blendPositions(PoseBuffer &positions, float scale) {
+	const size_t count = positions.targets.size();
+	if (count == 0)
 		return;
-	}
 
-	size_t lastFrame = 0;
-	for (size_t i = 0; i < animNode->_orientationFrames.size(); i++) {
-		const QuaternionKeyFrame &ori = animNode->_orientationFrames[i];
-		if (ori.time >= time)
-			break;
+	const float *f = &positions.factor[0];
 
-		lastFrame = i;
+	float *x = &positions.values[0][0], *nx = &positions.next[0][0];
+	float *y = &positions.values[1][0], *ny = &positions.next[1][0];
+	float *z = &positions.values[2][0], *nz = &positions.next[2][0];
+
+	for (size_t i = 0; i < count; i++) {
+		x[i] = (f[i] * nx[i] + (1.0f - f[i]) * x[i]) * scale;
+		y[i] = (f[i] * ny[i] + (1.0f - f[i]) * y[i]) * scale;
+		z[i] = (f[i] * nz[i] + (1.0f - f[i]) * z[i]) * scale;
 	}
+}
 
-	const QuaternionKeyFrame &last = animNode->_orientationFrames[lastFrame];
-	if (lastFrame + 1 >= animNode->_orientationFrames.size() || last.time >= time) {
-		target->setOrientation(last.x, last.y, last.z, Common::rad2deg(acos(last.q) * 2.0));
+void Animation::blendOrientations(PoseBuffer &orientations) {
+	const size_t count = orientations.targets.size();
+	if (count == 0)
 		return;
-	}
 
-	const QuaternionKeyFrame &next = animNode->_orientationFrames[lastFrame + 1];
+	const float *f = &orientations.factor[0];
+
+	float *x = &orientations.values[0][0], *nx = &orientations.next[0][0];
+	float *y = &orientations.values[1][0], *ny = &orientations.next[1][0];
+	float *z = &orientations.values[2][0], *nz = &orientations.next[2][0];
+	float *q = &orientations.values[3][0], *nq = &orientations.next[3][0];
 
-	const float f = (time - last.time) / (next.time - last.time);
+	for (size_t i = 0; i < count; i++) {
+		/* If the angle is > 90°, we need to flip the direction of one quaternion to
+		   get a smooth transition instead of wild jumps. */
+		const float dot = x[i] * nx[i] + y[i] * ny[i] + z[i] * nz[i] + q[i] * nq[i];
 
-	/* If the angle is > 90°, we need to flip the direction of one quaternion to
-	   get a smooth transition instead of wild jumps. */
-	const float angle = acos(dotQuaternion(last.x, last.y, last.z, last.q, next.x, next.y, next.z, next.q));
-	const float dir   = (angle >= (M_PI / 2)) ? -1.0f : 1.0f;
+		const float fNext = (dot <= 0.0f) ? -f[i] : f[i];
+		const float fLast = 1.0f - f[i];
 
-	float x = f * dir * next.x + (1.0f - f) * last.x;
-	float y = f * dir * next.y + (1.0f - f) * last.y;
-	float z = f * dir * next.z + (1.0f - f) * last.z;
-	float q = f * dir * next.q + (1.0f - f) * last.q;
+		const float bx = fNext * nx[i] + fLast * x[i];
+		const float by = fNext * ny[i] + fLast * y[i];
+		const float bz = fNext * nz[i] + fLast * z[i];
+		const float bq = fNext * nq[i] + fLast * q[i];
 
-	// Normalize the result for slightly better results
-	normQuaternion(x, y, z, q, x, y, z, q);
+		// Normalize the result for slightly better results
+		const float magnitude = sqrtf(bx * bx + by * by + bz * bz + bq * bq);
 
-	target->setOrientation(x, y, z, Common::rad2deg(acos(q) * 2.0));
+		x[i] = bx / magnitude;
+		y[i] = by / magnitude;
+		z[i] = bz / magnitude;
+		q[i] = bq / magnitude;
+	}
 }
 
 } // End of namespace Aurora
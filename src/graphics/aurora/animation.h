@@ -27,6 +27,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
 #include "src/common/ustring.h"
 #include "src/common/matrix4x4.h"
@@ -50,6 +51,46 @@ class AnimNode;
 
 class Animation {
 public:
+	/** One animated node, bound to the node of a model it animates. */
+	struct Track {
+		const ModelNode *animNode; ///< The node holding the keyframes.
+		ModelNode *target;         ///< The node within the model that's animated.
+
+		size_t positionFrame;    ///< The position keyframe last sampled.
+		size_t orientationFrame; ///< The orientation keyframe last sampled.
+
+		Track(const ModelNode *a = 0, ModelNode *t = 0);
+	};
+
+	/** The poses of several animated nodes, stored component by component.
+	 *
+	 *  The two keyframes surrounding the current time are gathered for every
+	 *  node first, so that they can then all be blended in one go.
+	 */
+	struct PoseBuffer {
+		std::vector<ModelNode *> targets; ///< The animated nodes.
+
+		std::vector<float> factor;    ///< How far to blend towards the next keyframe.
+		std::vector<float> values[4]; ///< The last keyframes, blended into the final pose.
+		std::vector<float> next  [4]; ///< The next keyframes.
+
+		void add(ModelNode *target);
+	};
+
+	/** An animation, bound to the nodes of a model. */
+	struct Binding {
+		const Animation *animation; ///< The animation that's bound.
+
+		float scale; ///< The scale of the animation within the model.
+
+		std::vector<Track> tracks; ///< All nodes of the animation that exist in the model.
+
+		PoseBuffer positions;    ///< The positions of all nodes with position keyframes.
+		PoseBuffer orientations; ///< The orientations of all nodes with orientation keyframes.
+
+		Binding();
+	};
+
 	Animation();
 	~Animation();
 
@@ -63,8 +104,21 @@ public:
 
 	void setTransTime(float transtime);
 
-	/** Update the model position and orientation */
-	void update(Model *model, float lastFrame, float nextFrame);
+	/** Bind the animation to the nodes of a model.
+	 *
+	 *  This resolves the animated nodes within the model once, so that
+	 *  update() doesn't need to look them up by name every frame.
+	 *
+	 *  @param model The model to bind the animation to, in its current state.
+	 *  @param binding The binding to fill.
+	 */
+	void bind(Model *model, Binding &binding) const;
+
+	/** Update the model position and orientation.
+	 *
+	 *  The binding needs to have been filled by bind() for this animation.
+	 */
+	void update(Binding &binding, float lastFrame, float nextFrame) const;
 
 	// Nodes
 
@@ -92,8 +146,11 @@ protected:
 	float _transtime;
 
 private:
-	void interpolatePosition(ModelNode *animNode, ModelNode *target, float time, float scale) const;
-	void interpolateOrientation(ModelNode *animNode, ModelNode *target, float time) const;
+	static void samplePosition(Track &track, float time, PoseBuffer &positions, size_t index);
+	static void sampleOrientation(Track &track, float time, PoseBuffer &orientations, size_t index);
+
+	static void blendPositions(PoseBuffer &positions, float scale);
+	static void blendOrientations(PoseBuffer &orientations);
 };
 
 } // End of namespace Aurora
@@ -34,12 +34,12 @@ namespace Graphics {
 
 namespace Aurora {
 
-FPS::FPS(const FontHandle &font) : Text(font, "0 fps"), _fps(0) {
+FPS::FPS(const FontHandle &font) : Text(font, "0 fps"), _fps(0), _drawn(0), _culled(0) {
 	init();
 }
 
 FPS::FPS(const FontHandle &font, float r, float g, float b, float a) :
-	Text(font, "0 fps", r, g, b, a), _fps(0) {
+	Text(font, "0 fps", r, g, b, a), _fps(0), _drawn(0), _culled(0) {
 
 	init();
 }
@@ -58,12 +58,19 @@ void FPS::render(RenderPass pass) {
 	if (pass == kRenderPassOpaque)
 		return;
 
-	uint32 fps = GfxMan.getFPS();
+	uint32 fps    = GfxMan.getFPS();
+	size_t drawn  = GfxMan.getDrawnObjectCount();
+	size_t culled = GfxMan.getCulledObjectCount();
 
-	if (fps != _fps) {
-		_fps = fps;
+	if ((fps != _fps) || (drawn != _drawn) || (culled != _culled)) {
+		_fps    = fps;
+		_drawn  = drawn;
+		_culled = culled;
 
-		set(Common::UString::format("%d fps", _fps));
+		if ((_drawn == 0) && (_culled == 0))
+			set(Common::UString::format("%d fps", _fps));
+		else
+			set(Common::UString::format("%d fps, %u drawn, %u culled", _fps, (uint) _drawn, (uint) _culled));
 	}
 
 	Text::render(pass);
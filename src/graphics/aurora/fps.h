@@ -33,7 +33,11 @@ namespace Graphics {
 
 namespace Aurora {
 
-/** An autonomous FPS display. */
+/** An autonomous FPS display.
+ *
+ *  While world objects are rendered, it also shows how many of them
+ *  were drawn and how many were culled for being outside the view.
+ */
 class FPS : public Text, public Events::Notifyable {
 public:
 	FPS(const FontHandle &font);
@@ -46,6 +50,9 @@ public:
 private:
 	uint32 _fps;
 
+	size_t _drawn;
+	size_t _culled;
+
 	void init();
 
 	void notifyResized(int oldWidth, int oldHeight, int newWidth, int newHeight);
@@ -29,8 +29,10 @@
 
 #include "src/common/readstream.h"
 #include "src/common/debug.h"
+#include "src/common/mutex.h"
 
 #include "src/graphics/camera.h"
+#include "src/graphics/frustum.h"
 
 #include "src/graphics/aurora/model.h"
 #include "src/graphics/aurora/textureman.h"
@@ -135,6 +137,25 @@ bool Model::isIn(float x1, float y1, float z1, float x2, float y2, float z2) con
 	return _absoluteBoundBox.isIn(x1, y1, z1, x2, y2, z2);
 }
 
+bool Model::isInFrustum(const Frustum &frustum) const {
+	if (_type == kModelTypeGUIFront)
+		return true;
+
+	return frustum.isIn(_absoluteBoundBox);
+}
+
+bool Model::getWorldBound(float &minX, float &minY, float &minZ,
+                          float &maxX, float &maxY, float &maxZ) const {
+
+	if ((_type == kModelTypeGUIFront) || _absoluteBoundBox.empty())
+		return false;
+
+	_absoluteBoundBox.getMin(minX, minY, minZ);
+	_absoluteBoundBox.getMax(maxX, maxY, maxZ);
+
+	return true;
+}
+
 float Model::getWidth() const {
 	return _boundBox.getWidth() * _scale[0];
 }
@@ -212,8 +233,16 @@ void Model::playDefaultAnimation() {
 	}
 }
 
+/** Animations of different models are advanced in parallel, but they share the random number generator. */
+static Common::Mutex defaultAnimationMutex;
+
 Animation *Model::selectDefaultAnimation() const {
-	uint8 pick = std::rand() % 100;
+	uint8 pick = 0;
+	{
+		Common::StackLock lock(defaultAnimationMutex);
+		pick = std::rand() % 100;
+	}
+
 	for (DefaultAnimations::const_iterator a = _defaultAnimations.begin(); a != _defaultAnimations.end(); ++a) {
 		if (pick < a->probability)
 			return a->animation;
@@ -347,6 +376,8 @@ void Model::createAbsolutePosition() {
 	_absoluteBoundBox = _boundBox;
 	_absoluteBoundBox.transform(_absolutePosition);
 	_absoluteBoundBox.absolutize();
+
+	invalidateWorldBound();
 }
 
 const std::list<Common::UString> &Model::getStates() const {
@@ -381,6 +412,9 @@ void Model::setState(const Common::UString &name) {
 
 	_currentState = state;
 
+	// The nodes changed, so the animation needs to be bound again
+	_animationBinding.animation = 0;
+
 	createBound();
 
 	if (visible) {
@@ -572,7 +606,7 @@ void Model::manageAnimations(float dt) {
 
 	// The loop of the animation ended: make sure to play the last frame
 	if ((lastFrame < _animationLoopLength) && (nextFrame >= _animationLoopLength)) {
-		_currentAnimation->update(this, lastFrame, _animationLoopLength);
+		updateAnimation(lastFrame, _animationLoopLength);
 
 		_animationTime    += dt;
 		_animationLoopTime = _animationLoopLength;
@@ -586,7 +620,7 @@ void Model::manageAnimations(float dt) {
 		_nextAnimation = 0;
 
 		if (_currentAnimation)
-			_currentAnimation->update(this, 0.0f, 0.0f);
+			updateAnimation(0.0f, 0.0f);
 
 		createBound();
 		return;
@@ -594,7 +628,7 @@ void Model::manageAnimations(float dt) {
 
 	// Start the next loop of the animation
 	if (lastFrame >= _animationLoopLength) {
-		_currentAnimation->update(this, 0.0f, 0.0f);
+		updateAnimation(0.0f, 0.0f);
 
 		lastFrame = 0.0f;
 		nextFrame = _animationSpeed * dt;
@@ -603,7 +637,7 @@ void Model::manageAnimations(float dt) {
 	}
 
 	// Update the animation
-	_currentAnimation->update(this, lastFrame, nextFrame);
+	updateAnimation(lastFrame, nextFrame);
 
 	_animationTime    += dt;
 	_animationLoopTime = nextFrame;
@@ -612,6 +646,13 @@ void Model::manageAnimations(float dt) {
 		createBound();
 }
 
+void Model::updateAnimation(float lastFrame, float nextFrame) {
+	if (_animationBinding.animation != _currentAnimation)
+		_currentAnimation->bind(this, _animationBinding);
+
+	_currentAnimation->update(_animationBinding, lastFrame, nextFrame);
+}
+
 void Model::render(RenderPass pass) {
 	if (!_currentState || (pass > kRenderPassAll))
 		return;
@@ -803,14 +844,8 @@ void Model::createBound() {
 	_absoluteBoundBox = _boundBox;
 	_absoluteBoundBox.transform(_absolutePosition);
 	_absoluteBoundBox.absolutize();
-}
-
-void Model::readValue(Common::SeekableReadStream &stream, uint32 &value) {
-	value = stream.readUint32LE();
-}
 
-void Model::readValue(Common::SeekableReadStream &stream, float &value) {
-	value = stream.readIEEEFloatLE();
+	invalidateWorldBound();
 }
 
 void Model::readArrayDef(Common::SeekableReadStream &stream,
@@ -835,8 +870,8 @@ void Model::readArray(Common::SeekableReadStream &stream,
 	const size_t pos = stream.seek(offset);
 
 	values.resize(count);
-	for (uint32 i = 0; i < count; i++)
-		readValue(stream, values[i]);
+	if (count > 0)
+		stream.readArrayLE(&values[0], count);
 
 	stream.seek(pos);
 }
@@ -38,6 +38,7 @@
 #include "src/graphics/renderable.h"
 
 #include "src/graphics/aurora/modelnode.h"
+#include "src/graphics/aurora/animation.h"
 #include "src/graphics/aurora/types.h"
 
 #include "src/graphics/shader/shaderrenderable.h"
@@ -80,6 +81,10 @@ public:
 	bool isIn(float x, float y, float z) const;
 	/** Does the line from x1.y1.z1 to x2.y2.z2 intersect with model's bounding box? */
 	bool isIn(float x1, float y1, float z1, float x2, float y2, float z2) const;
+	/** Is the model's bounding box at least partially within that view frustum? */
+	bool isInFrustum(const Frustum &frustum) const;
+	/** Get the model's bounding box in world coordinates. */
+	bool getWorldBound(float &minX, float &minY, float &minZ, float &maxX, float &maxY, float &maxZ) const;
 
 
 	// Positioning
@@ -279,6 +284,9 @@ private:
 	float _animationLoopLength; ///< The length of one loop of the current animation.
 	float _animationLoopTime;   ///< The time the current loop of the current animation has played.
 
+	/** The current animation, bound to the nodes of the current state. */
+	Animation::Binding _animationBinding;
+
 
 	/** Create the list of all state names. */
 	void createStateNamesList(std::list<Common::UString> *stateNames = 0);
@@ -288,6 +296,8 @@ private:
 	void createAbsolutePosition();
 
 	void manageAnimations(float dt);
+	/** Apply the current animation to the nodes of the current state. */
+	void updateAnimation(float lastFrame, float nextFrame);
 
 	Animation *selectDefaultAnimation() const;
 
@@ -296,9 +306,6 @@ private:
 public:
 	// General loading helpers
 
-	static void readValue(Common::SeekableReadStream &stream, uint32 &value);
-	static void readValue(Common::SeekableReadStream &stream, float  &value);
-
 	static void readArrayDef(Common::SeekableReadStream &stream,
 	                         uint32 &offset, uint32 &count);
 
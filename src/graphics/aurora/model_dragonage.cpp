@@ -534,7 +534,7 @@ void ModelNode_DragonAge::readTransformation(const GFF4Struct &nodeGFF) {
 			_orientation[0] = x;
 			_orientation[1] = y;
 			_orientation[2] = z;
-			_orientation[3] = Common::rad2deg(acos(w) * 2.0);
+			_orientation[3] = w;
 		}
 	}
 }
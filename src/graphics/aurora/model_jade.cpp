@@ -304,7 +304,7 @@ void ModelNode_Jade::load(Model_Jade::ParserContext &ctx) {
 	_position   [0] = ctx.mdl->readIEEEFloatLE();
 	_position   [1] = ctx.mdl->readIEEEFloatLE();
 	_position   [2] = ctx.mdl->readIEEEFloatLE();
-	_orientation[3] = Common::rad2deg(acos(ctx.mdl->readIEEEFloatLE()) * 2.0f);
+	_orientation[3] = ctx.mdl->readIEEEFloatLE();
 	_orientation[0] = ctx.mdl->readIEEEFloatLE();
 	_orientation[1] = ctx.mdl->readIEEEFloatLE();
 	_orientation[2] = ctx.mdl->readIEEEFloatLE();
@@ -1018,7 +1018,7 @@ void ModelNode_NWN_Binary::readNodeControllers(Model_NWN::ParserContext &ctx,
 					_orientation[0] = data[dataIndex + 0];
 					_orientation[1] = data[dataIndex + 1];
 					_orientation[2] = data[dataIndex + 2];
-					_orientation[3] = Common::rad2deg(acos(data[dataIndex + 3]) * 2.0);
+					_orientation[3] = data[dataIndex + 3];
 
 					ctx.hasOrientation = true;
 				}
@@ -1107,9 +1107,11 @@ void ModelNode_NWN_ASCII::load(Model_NWN::ParserContext &ctx,
 		} else if (line[0] == "position") {
 			readFloats(line, _position, 3, 1);
 		} else if (line[0] == "orientation") {
-			readFloats(line, _orientation, 4, 1);
+			float orientation[4];
+			readFloats(line, orientation, 4, 1);
 
-			_orientation[3] = Common::rad2deg(_orientation[3]);
+			axisAngleToQuaternion(orientation[0], orientation[1], orientation[2],
+			                      Common::rad2deg(orientation[3]), _orientation);
 		} else if (line[0] == "render") {
 			Common::parseString(line[1], _mesh->render);
 		} else if (line[0] == "transparencyhint") {
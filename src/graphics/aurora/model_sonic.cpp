@@ -1383,7 +1383,9 @@ void ModelNode_Sonic::load(Model_Sonic::ParserContext &ctx, Model_Sonic::Bone &b
 
 	// Decompose the bone's transformation matrix into TRS
 	bone.transform.getPosition(_position[0], _position[1], _position[2]);
-	bone.transform.getAxisAngle(_orientation[3], _orientation[0], _orientation[1], _orientation[2]);
+	float orientation[4];
+	bone.transform.getAxisAngle(orientation[3], orientation[0], orientation[1], orientation[2]);
+	axisAngleToQuaternion(orientation[0], orientation[1], orientation[2], orientation[3], _orientation);
 	bone.transform.getScale(_scale[0], _scale[1], _scale[2]);
 
 	if (bone.parent)
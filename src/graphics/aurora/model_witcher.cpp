@@ -905,7 +905,7 @@ void ModelNode_Witcher::readNodeControllers(Model_Witcher::ParserContext &ctx,
 			_orientation[0] = data[dataIndex + 0];
 			_orientation[1] = data[dataIndex + 1];
 			_orientation[2] = data[dataIndex + 2];
-			_orientation[3] = Common::rad2deg(acos(data[dataIndex + 3]) * 2.0);
+			_orientation[3] = data[dataIndex + 3];
 		}
 
 	}
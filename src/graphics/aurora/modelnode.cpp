@@ -69,7 +69,7 @@ ModelNode::ModelNode(Model &model) :
 	_orientation[0] = 0.0f;
 	_orientation[1] = 0.0f;
 	_orientation[2] = 0.0f;
-	_orientation[3] = 0.0f;
+	_orientation[3] = 1.0f;
 
 	_scale[0] = 1.0f;
 	_scale[1] = 1.0f;
@@ -153,7 +153,7 @@ void ModelNode::getOrientation(float &x, float &y, float &z, float &a) const {
 	x = _orientation[0];
 	y = _orientation[1];
 	z = _orientation[2];
-	a = _orientation[3];
+	a = Common::rad2deg(acos(CLIP(_orientation[3], -1.0f, 1.0f)) * 2.0f);
 }
 
 void ModelNode::getAbsolutePosition(float &x, float &y, float &z) const {
@@ -172,14 +172,18 @@ Common::Matrix4x4 ModelNode::getAsolutePosition() const {
 void ModelNode::setPosition(float x, float y, float z) {
 	lockFrameIfVisible();
 
+	doSetPosition(x, y, z);
+
+	unlockFrameIfVisible();
+}
+
+void ModelNode::doSetPosition(float x, float y, float z) {
 	_position[0] = x / _model->_scale[0];
 	_position[1] = y / _model->_scale[1];
 	_position[2] = z / _model->_scale[2];
 
 	if (_parent)
 		_parent->orderChildren();
-
-	unlockFrameIfVisible();
 }
 
 void ModelNode::setRotation(float x, float y, float z) {
@@ -195,12 +199,35 @@ void ModelNode::setRotation(float x, float y, float z) {
 void ModelNode::setOrientation(float x, float y, float z, float a) {
 	lockFrameIfVisible();
 
+	axisAngleToQuaternion(x, y, z, a, _orientation);
+
+	unlockFrameIfVisible();
+}
+
+void ModelNode::doSetQuaternion(float x, float y, float z, float w) {
 	_orientation[0] = x;
 	_orientation[1] = y;
 	_orientation[2] = z;
-	_orientation[3] = a;
+	_orientation[3] = w;
+}
 
-	unlockFrameIfVisible();
+void ModelNode::axisAngleToQuaternion(float x, float y, float z, float angle, float *quaternion) {
+	const float length = sqrtf(x * x + y * y + z * z);
+	if (length == 0.0f) {
+		quaternion[0] = 0.0f;
+		quaternion[1] = 0.0f;
+		quaternion[2] = 0.0f;
+		quaternion[3] = 1.0f;
+		return;
+	}
+
+	const float halfAngle = Common::deg2rad(angle) / 2.0f;
+	const float s = sinf(halfAngle) / length;
+
+	quaternion[0] = x * s;
+	quaternion[1] = y * s;
+	quaternion[2] = z * s;
+	quaternion[3] = cosf(halfAngle);
 }
 
 void ModelNode::move(float x, float y, float z) {
@@ -378,7 +405,7 @@ void ModelNode::createAbsoluteBound() {
 void ModelNode::createAbsoluteBound(Common::BoundingBox parentPosition) {
 	// Transform by our position/orientation/rotation
 	parentPosition.translate(_position[0], _position[1], _position[2]);
-	parentPosition.rotate(_orientation[3], _orientation[0], _orientation[1], _orientation[2]);
+	parentPosition.rotateQuaternion(_orientation[0], _orientation[1], _orientation[2], _orientation[3]);
 
 	parentPosition.rotate(_rotation[0], 1.0f, 0.0f, 0.0f);
 	parentPosition.rotate(_rotation[1], 0.0f, 1.0f, 0.0f);
@@ -550,7 +577,10 @@ void ModelNode::render(RenderPass pass) {
 	// Apply the node's transformation
 
 	glTranslatef(_position[0], _position[1], _position[2]);
-	glRotatef(_orientation[3], _orientation[0], _orientation[1], _orientation[2]);
+
+	Common::Matrix4x4 orientation;
+	orientation.rotateQuaternion(_orientation[0], _orientation[1], _orientation[2], _orientation[3]);
+	glMultMatrixf(orientation.get());
 
 	glRotatef(_rotation[0], 1.0f, 0.0f, 0.0f);
 	glRotatef(_rotation[1], 0.0f, 1.0f, 0.0f);
@@ -597,7 +627,7 @@ void ModelNode::drawSkeleton(const Common::Matrix4x4 &parent, bool showInvisible
 	Common::Matrix4x4 mine = parent;
 
 	mine.translate(_position[0], _position[1], _position[2]);
-	mine.rotate(_orientation[3], _orientation[0], _orientation[1], _orientation[2]);
+	mine.rotateQuaternion(_orientation[0], _orientation[1], _orientation[2], _orientation[3]);
 	mine.scale(_scale[0], _scale[1], _scale[2]);
 
 	if (_render || showInvisible) {
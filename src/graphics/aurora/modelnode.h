@@ -186,7 +186,7 @@ protected:
 	float _center     [3]; ///< The node's center.
 	float _position   [3]; ///< Position of the node.
 	float _rotation   [3]; ///< Node rotation.
-	float _orientation[4]; ///< Orientation of the node.
+	float _orientation[4]; ///< Orientation of the node, as a quaternion (x, y, z, w).
 	float _scale      [3]; ///< Scale of the node.
 
 	std::vector<PositionKeyFrame> _positionFrames;      ///< Keyframes for position animation.
@@ -220,12 +220,28 @@ protected:
 	void lockFrameIfVisible();
 	void unlockFrameIfVisible();
 
+	/** Convert a rotation around an axis, with the angle in degrees, into a quaternion. */
+	static void axisAngleToQuaternion(float x, float y, float z, float angle, float *quaternion);
+
 
 private:
 	const Common::BoundingBox &getAbsoluteBound() const;
 
 	void orderChildren();
 
+	/** Set the position without locking the frame, for animations.
+	 *
+	 *  Animations are advanced within Renderable::advanceTime(), which the
+	 *  GraphicsManager calls, maybe on a worker thread, only while nothing
+	 *  is rendered and no other thread holds the frame lock.
+	 */
+	void doSetPosition(float x, float y, float z);
+	/** Set the orientation as a quaternion without locking the frame, for animations.
+	 *
+	 *  See doSetPosition().
+	 */
+	void doSetQuaternion(float x, float y, float z, float w);
+
 	static void renderGeometry(Mesh &mesh);
 	static void renderGeometryNormal(Mesh &mesh);
 	static void renderGeometryEnvMappedUnder(Mesh &mesh);
@@ -0,0 +1,107 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A view frustum, for culling objects outside the view.
+ */
+
+#include <cstring>
+#include <cmath>
+
+#include "src/common/matrix4x4.h"
+#include "src/common/boundingbox.h"
+
+#include "src/graphics/frustum.h"
+
+namespace Graphics {
+
+Frustum::Frustum() {
+	// Without a view, everything is inside
+	std::memset(_planes, 0, sizeof(_planes));
+}
+
+Frustum::~Frustum() {
+}
+
+void Frustum::set(const Common::Matrix4x4 &projection, const Common::Matrix4x4 &modelview) {
+	/* Each plane is the sum or difference of the last row and one of the other
+	 * rows of the combined matrix. See Gribb & Hartmann, "Fast Extraction of
+	 * Viewing Frustum Planes from the World-View-Projection Matrix". */
+
+	const Common::Matrix4x4 clip = projection * modelview;
+
+	for (int i = 0; i < 4; i++) {
+		_planes[0][i] = clip(3, i) + clip(0, i); // Left
+		_planes[1][i] = clip(3, i) - clip(0, i); // Right
+		_planes[2][i] = clip(3, i) + clip(1, i); // Bottom
+		_planes[3][i] = clip(3, i) - clip(1, i); // Top
+		_planes[4][i] = clip(3, i) + clip(2, i); // Near
+		_planes[5][i] = clip(3, i) - clip(2, i); // Far
+	}
+
+	// Normalize the planes, so that the sphere test gets real distances
+	for (int p = 0; p < 6; p++) {
+		const float length = sqrtf(_planes[p][0] * _planes[p][0] +
+		                           _planes[p][1] * _planes[p][1] +
+		                           _planes[p][2] * _planes[p][2]);
+
+		if (length <= 0.0f)
+			continue;
+
+		for (int i = 0; i < 4; i++)
+			_planes[p][i] /= length;
+	}
+}
+
+bool Frustum::isIn(float x, float y, float z) const {
+	return isIn(x, y, z, 0.0f);
+}
+
+bool Frustum::isIn(float x, float y, float z, float radius) const {
+	for (int p = 0; p < 6; p++)
+		if ((_planes[p][0] * x + _planes[p][1] * y + _planes[p][2] * z + _planes[p][3]) < -radius)
+			return false;
+
+	return true;
+}
+
+bool Frustum::isIn(const Common::BoundingBox &box) const {
+	if (box.empty())
+		return true;
+
+	float min[3], max[3];
+	box.getMin(min[0], min[1], min[2]);
+	box.getMax(max[0], max[1], max[2]);
+
+	/* For each plane, only check the corner of the box furthest along the
+	 * plane's normal. If even that one is outside, the whole box is. */
+	for (int p = 0; p < 6; p++) {
+		const float x = (_planes[p][0] >= 0.0f) ? max[0] : min[0];
+		const float y = (_planes[p][1] >= 0.0f) ? max[1] : min[1];
+		const float z = (_planes[p][2] >= 0.0f) ? max[2] : min[2];
+
+		if ((_planes[p][0] * x + _planes[p][1] * y + _planes[p][2] * z + _planes[p][3]) < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,65 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A view frustum, for culling objects outside the view.
+ */
+
+#ifndef GRAPHICS_FRUSTUM_H
+#define GRAPHICS_FRUSTUM_H
+
+#include "src/common/types.h"
+
+namespace Common {
+	class Matrix4x4;
+	class BoundingBox;
+}
+
+namespace Graphics {
+
+/** The six clipping planes of a view, in world coordinates. */
+class Frustum {
+public:
+	Frustum();
+	~Frustum();
+
+	/** Extract the planes from a projection and a modelview (camera) matrix. */
+	void set(const Common::Matrix4x4 &projection, const Common::Matrix4x4 &modelview);
+
+	/** Is that point inside the frustum? */
+	bool isIn(float x, float y, float z) const;
+	/** Is that sphere at least partially inside the frustum? */
+	bool isIn(float x, float y, float z, float radius) const;
+
+	/** Is that axis-aligned box at least partially inside the frustum?
+	 *
+	 *  The box needs to be absolute, i.e. with its origin transformations
+	 *  already applied to the coordinates. An empty box is always inside.
+	 */
+	bool isIn(const Common::BoundingBox &box) const;
+
+private:
+	/** The planes, as (a, b, c, d) with a*x + b*y + c*z + d >= 0 for points inside. */
+	float _planes[6][4];
+};
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_FRUSTUM_H
@@ -35,6 +35,7 @@
 #include "src/common/configman.h"
 #include "src/common/debugman.h"
 #include "src/common/threads.h"
+#include "src/common/threadpool.h"
 #include "src/common/matrix4x4.h"
 #include "src/common/vector3.h"
 
@@ -101,6 +102,8 @@ GraphicsManager::GraphicsManager() : Events::Notifyable() {
 
 	_lastSampled = 0;
 
+	_culledObjectCount = 0;
+
 	glCompressedTexImage2D = 0;
 }
 
@@ -139,6 +142,10 @@ void GraphicsManager::init() {
 	MaterialMan.init();
 	MeshMan.init();
 
+	// Advance the animations of the world objects on all cores
+	if (Common::ThreadPool::getCPUCount() > 1)
+		_animationPool.reset(new Common::ThreadPool);
+
 	_ready = true;
 }
 
@@ -149,6 +156,9 @@ void GraphicsManager::deinit() {
 		return;
 
 	QueueMan.clearAllQueues();
+	_worldObjects.clear();
+
+	_animationPool.reset();
 
 	MeshMan.deinit();
 	MaterialMan.deinit();
@@ -187,6 +197,14 @@ uint32 GraphicsManager::getFPS() const {
 	return _fpsCounter->getFPS();
 }
 
+size_t GraphicsManager::getDrawnObjectCount() const {
+	return _drawnObjects.size();
+}
+
+size_t GraphicsManager::getCulledObjectCount() const {
+	return _culledObjectCount;
+}
+
 bool GraphicsManager::setFSAA(int level) {
 	// Force calling it from the main thread
 	if (!Common::isMainThread()) {
@@ -797,29 +815,52 @@ Renderable *GraphicsManager::getWorldObjectAt(float x, float y) const {
 	if (!unproject(x, y, x1, y1, z1, x2, y2, z2))
 		return 0;
 
-	Renderable *object = 0;
+	return getWorldObjectAt(x1, y1, z1, x2, y2, z2);
+}
 
-	QueueMan.lockQueue(kQueueVisibleWorldObject);
-	const std::list<Queueable *> &objects = QueueMan.getQueue(kQueueVisibleWorldObject);
+Renderable *GraphicsManager::getWorldObjectAt(float x1, float y1, float z1,
+                                              float x2, float y2, float z2) const {
 
-	for (std::list<Queueable *>::const_iterator o = objects.begin(); o != objects.end(); ++o) {
-		Renderable &r = static_cast<Renderable &>(**o);
+	/* The object tree checks the objects themselves for the final hit. Keep
+	 * the visible objects from being animated, or hidden, while we do that. */
 
-		if (!r.isClickable())
-			// Object isn't clickable, don't check
-			continue;
+	QueueMan.lockQueue(kQueueVisibleWorldObject);
 
-		// If the line intersects with the object, return it
-		if (r.isIn(x1, y1, z1, x2, y2, z2)) {
-			object = &r;
-			break;
-		}
-	}
+	Renderable *object = _worldObjects.findNearest(x1, y1, z1, x2, y2, z2, true);
 
 	QueueMan.unlockQueue(kQueueVisibleWorldObject);
 	return object;
 }
 
+void GraphicsManager::getWorldObjectsIn(float minX, float minY, float minZ,
+                                        float maxX, float maxY, float maxZ,
+                                        std::vector<Renderable *> &objects) const {
+
+	QueueMan.lockQueue(kQueueVisibleWorldObject);
+
+	_worldObjects.findInBox(minX, minY, minZ, maxX, maxY, maxZ, objects);
+
+	QueueMan.unlockQueue(kQueueVisibleWorldObject);
+}
+
+void GraphicsManager::getWorldObjectsIn(float x, float y, float z, float radius,
+                                        std::vector<Renderable *> &objects) const {
+
+	QueueMan.lockQueue(kQueueVisibleWorldObject);
+
+	_worldObjects.findInSphere(x, y, z, radius, objects);
+
+	QueueMan.unlockQueue(kQueueVisibleWorldObject);
+}
+
+void GraphicsManager::addWorldObject(Renderable &object) {
+	_worldObjects.add(object);
+}
+
+void GraphicsManager::removeWorldObject(Renderable &object) {
+	_worldObjects.remove(object);
+}
+
 Renderable *GraphicsManager::getObjectAt(float x, float y) {
 	Renderable *object = 0;
 
@@ -883,9 +924,78 @@ bool GraphicsManager::playVideo() {
 	return true;
 }
 
+void GraphicsManager::advanceWorldTime(const std::list<Queueable *> &objects, float dt) {
+	/* The animations of all objects are independent of each other, so we
+	 * split the objects into batches and advance them on the worker threads.
+	 * We wait for all of them to finish before rendering anything. */
+
+	static const size_t kMinBatchSize = 8;
+
+	_animatedObjects.clear();
+	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin(); o != objects.rend(); ++o)
+		_animatedObjects.push_back(static_cast<Renderable *>(*o));
+
+	if (_animatedObjects.empty())
+		return;
+
+	const size_t batchCount = _animationPool ?
+		MIN(_animationPool->getThreadCount() * 4, _animatedObjects.size() / kMinBatchSize) : 0;
+
+	if (batchCount <= 1) {
+		advanceTimeBatch(&_animatedObjects[0], _animatedObjects.size(), dt);
+		return;
+	}
+
+	const size_t batchSize = (_animatedObjects.size() + batchCount - 1) / batchCount;
+	for (size_t i = 0; i < _animatedObjects.size(); i += batchSize) {
+		const size_t count = MIN(batchSize, _animatedObjects.size() - i);
+
+		_animationPool->addJob(boost::bind(&GraphicsManager::advanceTimeBatch, &_animatedObjects[i], count, dt));
+	}
+
+	_animationPool->wait();
+}
+
+void GraphicsManager::advanceTimeBatch(Renderable *const *objects, size_t count, float dt) {
+	for (size_t i = 0; i < count; i++)
+		objects[i]->advanceTime(dt);
+}
+
+void GraphicsManager::updateWorldObjects(const std::list<Queueable *> &objects) {
+	/* Animations only mark the changed bounding boxes, so that the worker
+	 * threads don't fight over the object tree. Update it here, in one go. */
+
+	for (std::list<Queueable *>::const_iterator o = objects.begin(); o != objects.end(); ++o) {
+		Renderable &object = *static_cast<Renderable *>(*o);
+
+		if (object._worldBoundChanged.exchange(false, boost::memory_order_acquire))
+			_worldObjects.update(object);
+	}
+}
+
+void GraphicsManager::cullWorldObjects(const std::list<Queueable *> &objects) {
+	_drawnObjects.clear();
+	_culledObjectCount = 0;
+
+	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
+	     o != objects.rend(); ++o) {
+
+		Renderable *object = static_cast<Renderable *>(*o);
+
+		if (object->isInFrustum(_frustum))
+			_drawnObjects.push_back(object);
+		else
+			_culledObjectCount++;
+	}
+}
+
 bool GraphicsManager::renderWorld() {
-	if (QueueMan.isQueueEmpty(kQueueVisibleWorldObject))
+	if (QueueMan.isQueueEmpty(kQueueVisibleWorldObject)) {
+		_drawnObjects.clear();
+		_culledObjectCount = 0;
+
 		return false;
+	}
 
 	float cPos[3];
 	float cOrient[3];
@@ -915,6 +1025,8 @@ bool GraphicsManager::renderWorld() {
 	_modelview.rotate(-cOrient[2], 0.0f, 0.0f, 1.0f);
 	_modelview.translate(-cPos[0], -cPos[1], -cPos[2]);
 
+	_frustum.set(_projection, _modelview);
+
 	QueueMan.lockQueue(kQueueVisibleWorldObject);
 	const std::list<Queueable *> &objects = QueueMan.getQueue(kQueueVisibleWorldObject);
 
@@ -932,26 +1044,29 @@ bool GraphicsManager::renderWorld() {
 	// If game paused, skip the advanceTime loop below
 
 	// Advance time for animation queues
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
-		static_cast<Renderable *>(*o)->advanceTime(elapsedTime);
-	}
+	advanceWorldTime(objects, elapsedTime);
+
+	// Move the changed objects within the object tree
+	updateWorldObjects(objects);
+
+	// Skip objects outside the view
+	cullWorldObjects(objects);
 
 	// Draw opaque objects
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
+	for (std::vector<Renderable *>::const_iterator o = _drawnObjects.begin();
+	     o != _drawnObjects.end(); ++o) {
 
 		glPushMatrix();
-		static_cast<Renderable *>(*o)->render(kRenderPassOpaque);
+		(*o)->render(kRenderPassOpaque);
 		glPopMatrix();
 	}
 
 	// Draw transparent objects
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
+	for (std::vector<Renderable *>::const_iterator o = _drawnObjects.begin();
+	     o != _drawnObjects.end(); ++o) {
 
 		glPushMatrix();
-		static_cast<Renderable *>(*o)->render(kRenderPassTransparent);
+		(*o)->render(kRenderPassTransparent);
 		glPopMatrix();
 	}
 
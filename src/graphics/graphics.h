@@ -40,14 +40,21 @@
 
 #include "src/graphics/types.h"
 #include "src/graphics/windowman.h"
+#include "src/graphics/frustum.h"
+#include "src/graphics/objecttree.h"
 
 #include "src/events/notifyable.h"
 
+namespace Common {
+	class ThreadPool;
+}
+
 namespace Graphics {
 
 class FPSCounter;
 class Cursor;
 class Renderable;
+class Queueable;
 
 /** The graphics manager. */
 class GraphicsManager : public Common::Singleton<GraphicsManager>, public Events::Notifyable {
@@ -82,6 +89,11 @@ public:
 	/** How many frames per second to we render at the moments? */
 	uint32 getFPS() const;
 
+	/** How many world objects were rendered in the last frame? */
+	size_t getDrawnObjectCount() const;
+	/** How many world objects were skipped in the last frame, for being outside the view? */
+	size_t getCulledObjectCount() const;
+
 	/** Enable/Disable face culling. */
 	void setCullFace(bool enabled, GLenum mode = GL_BACK);
 
@@ -107,6 +119,16 @@ public:
 	/** Get the object at this screen position. */
 	Renderable *getObjectAt(float x, float y);
 
+	/** Get the clickable world object nearest to x1.y1.z1 on the line to x2.y2.z2. */
+	Renderable *getWorldObjectAt(float x1, float y1, float z1, float x2, float y2, float z2) const;
+
+	/** Get all visible world objects whose bounding boxes intersect with that box. */
+	void getWorldObjectsIn(float minX, float minY, float minZ, float maxX, float maxY, float maxZ,
+	                       std::vector<Renderable *> &objects) const;
+	/** Get all visible world objects whose bounding boxes intersect with that sphere. */
+	void getWorldObjectsIn(float x, float y, float z, float radius,
+	                       std::vector<Renderable *> &objects) const;
+
 	/** Recalculate all object distances to the camera and resort the objects. */
 	void recalculateObjectDistances();
 
@@ -172,6 +194,20 @@ private:
 
 	uint32 _lastSampled; ///< Timestamp used to advance animations.
 
+	/** Worker threads advancing the animations of the world objects. */
+	Common::ScopedPtr<Common::ThreadPool> _animationPool;
+	/** The world objects whose animations are advanced this frame. */
+	std::vector<Renderable *> _animatedObjects;
+
+	Frustum _frustum; ///< The view frustum of the current frame.
+
+	/** The world objects within the view frustum, rendered this frame. */
+	std::vector<Renderable *> _drawnObjects;
+	size_t _culledObjectCount; ///< Number of world objects outside the view frustum.
+
+	/** The visible world objects, for picking and area queries. */
+	ObjectTree _worldObjects;
+
 	Common::Matrix4x4 _projection;    ///< Our projection matrix.
 	Common::Matrix4x4 _projectionInv; ///< The inverse of our projection matrix.
 	Common::Matrix4x4 _modelview;     ///< Our base modelview matrix (i.e camera view).
@@ -217,6 +253,16 @@ private:
 
 	void buildNewTextures();
 
+	/** Advance the animations of all world objects, in parallel if possible. */
+	void advanceWorldTime(const std::list<Queueable *> &objects, float dt);
+	static void advanceTimeBatch(Renderable *const *objects, size_t count, float dt);
+
+	/** Update the object tree with the changed world bounding boxes of these objects. */
+	void updateWorldObjects(const std::list<Queueable *> &objects);
+
+	/** Collect all world objects within the view frustum, in rendering order. */
+	void cullWorldObjects(const std::list<Queueable *> &objects);
+
 	void beginScene();
 	bool playVideo();
 	bool renderWorld();
@@ -226,6 +272,11 @@ private:
 	void endScene();
 
 	void notifyResized(int oldWidth, int oldHeight, int newWidth, int newHeight);
+
+	void addWorldObject   (Renderable &object);
+	void removeWorldObject(Renderable &object);
+
+	friend class Renderable;
 };
 
 } // End of namespace Graphics
@@ -0,0 +1,540 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A bounding volume hierarchy over world objects, for picking and area queries.
+ */
+
+#include <cassert>
+
+#include "src/common/util.h"
+#include "src/common/maths.h"
+
+#include "src/graphics/objecttree.h"
+#include "src/graphics/renderable.h"
+
+namespace Graphics {
+
+/** The margin added around the bounding boxes of leaves, in world units. */
+static const float kMargin = 0.5f;
+
+ObjectTree::Node::Node() : object(0), parent(kNodeNone), left(kNodeNone), right(kNodeNone), height(0) {
+	for (int i = 0; i < 3; i++) {
+		box.min[i] = objectBox.min[i] = 0.0f;
+		box.max[i] = objectBox.max[i] = 0.0f;
+	}
+}
+
+bool ObjectTree::Node::isLeaf() const {
+	return left == kNodeNone;
+}
+
+
+ObjectTree::ObjectTree() : _root(kNodeNone), _freeNode(kNodeNone) {
+}
+
+ObjectTree::~ObjectTree() {
+}
+
+void ObjectTree::clear() {
+	Common::StackLock lock(_mutex);
+
+	_nodes.clear();
+	_objects.clear();
+
+	_root     = kNodeNone;
+	_freeNode = kNodeNone;
+}
+
+void ObjectTree::add(Renderable &object) {
+	Common::StackLock lock(_mutex);
+
+	if (_objects.find(&object) != _objects.end())
+		return;
+
+	Box box;
+	if (getBox(object, box))
+		_objects[&object] = createLeaf(object, box);
+	else
+		_objects[&object] = kNodeNone;
+}
+
+void ObjectTree::update(Renderable &object) {
+	Common::StackLock lock(_mutex);
+
+	ObjectMap::iterator o = _objects.find(&object);
+	if (o == _objects.end())
+		return;
+
+	Box box;
+	if (!getBox(object, box)) {
+		// The object lost its bounding box
+		if (o->second != kNodeNone)
+			destroyLeaf(o->second);
+
+		o->second = kNodeNone;
+		return;
+	}
+
+	if (o->second == kNodeNone) {
+		// The object got its first bounding box
+		o->second = createLeaf(object, box);
+		return;
+	}
+
+	Node &leaf = _nodes[o->second];
+
+	leaf.objectBox = box;
+
+	// Still within the margin, nothing to do
+	if (contains(leaf.box, box))
+		return;
+
+	removeLeaf(o->second);
+
+	for (int i = 0; i < 3; i++) {
+		leaf.box.min[i] = box.min[i] - kMargin;
+		leaf.box.max[i] = box.max[i] + kMargin;
+	}
+
+	insertLeaf(o->second);
+}
+
+void ObjectTree::remove(Renderable &object) {
+	Common::StackLock lock(_mutex);
+
+	ObjectMap::iterator o = _objects.find(&object);
+	if (o == _objects.end())
+		return;
+
+	if (o->second != kNodeNone)
+		destroyLeaf(o->second);
+
+	_objects.erase(o);
+}
+
+Renderable *ObjectTree::findNearest(float x1, float y1, float z1, float x2, float y2, float z2,
+                                    bool clickable) const {
+
+	Common::StackLock lock(_mutex);
+
+	if (_root == kNodeNone)
+		return 0;
+
+	const float start    [3] = { x1, y1, z1 };
+	const float direction[3] = { x2 - x1, y2 - y1, z2 - z1 };
+
+	Renderable *nearest = 0;
+	float nearestT = FLT_MAX;
+
+	std::vector<int> stack;
+	stack.push_back(_root);
+
+	while (!stack.empty()) {
+		const Node &node = _nodes[stack.back()];
+		stack.pop_back();
+
+		// Skip branches the line doesn't go through, or only behind what we already found
+		float t;
+		if (!intersect(node.box, start, direction, t) || (t >= nearestT))
+			continue;
+
+		if (!node.isLeaf()) {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+			continue;
+		}
+
+		if (clickable && !node.object->isClickable())
+			continue;
+
+		if (!intersect(node.objectBox, start, direction, t) || (t >= nearestT))
+			continue;
+
+		if (!node.object->isIn(x1, y1, z1, x2, y2, z2))
+			continue;
+
+		nearest  = node.object;
+		nearestT = t;
+	}
+
+	return nearest;
+}
+
+void ObjectTree::findInBox(float minX, float minY, float minZ, float maxX, float maxY, float maxZ,
+                           std::vector<Renderable *> &objects) const {
+
+	Common::StackLock lock(_mutex);
+
+	if (_root == kNodeNone)
+		return;
+
+	const Box box = { { minX, minY, minZ }, { maxX, maxY, maxZ } };
+
+	std::vector<int> stack;
+	stack.push_back(_root);
+
+	while (!stack.empty()) {
+		const Node &node = _nodes[stack.back()];
+		stack.pop_back();
+
+		if (!overlaps(node.box, box))
+			continue;
+
+		if (!node.isLeaf()) {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+			continue;
+		}
+
+		if (overlaps(node.objectBox, box))
+			objects.push_back(node.object);
+	}
+}
+
+void ObjectTree::findInSphere(float x, float y, float z, float radius,
+                              std::vector<Renderable *> &objects) const {
+
+	Common::StackLock lock(_mutex);
+
+	if (_root == kNodeNone)
+		return;
+
+	std::vector<int> stack;
+	stack.push_back(_root);
+
+	while (!stack.empty()) {
+		const Node &node = _nodes[stack.back()];
+		stack.pop_back();
+
+		if (!overlaps(node.box, x, y, z, radius))
+			continue;
+
+		if (!node.isLeaf()) {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+			continue;
+		}
+
+		if (overlaps(node.objectBox, x, y, z, radius))
+			objects.push_back(node.object);
+	}
+}
+
+int ObjectTree::allocateNode() {
+	if (_freeNode == kNodeNone) {
+		_nodes.push_back(Node());
+		return _nodes.size() - 1;
+	}
+
+	const int node = _freeNode;
+
+	_freeNode     = _nodes[node].parent;
+	_nodes[node] = Node();
+
+	return node;
+}
+
+void ObjectTree::freeNode(int node) {
+	_nodes[node] = Node();
+
+	_nodes[node].parent = _freeNode;
+	_nodes[node].height = -1;
+
+	_freeNode = node;
+}
+
+int ObjectTree::createLeaf(Renderable &object, const Box &box) {
+	const int leaf = allocateNode();
+
+	Node &node = _nodes[leaf];
+
+	node.object    = &object;
+	node.objectBox = box;
+
+	for (int i = 0; i < 3; i++) {
+		node.box.min[i] = box.min[i] - kMargin;
+		node.box.max[i] = box.max[i] + kMargin;
+	}
+
+	insertLeaf(leaf);
+
+	return leaf;
+}
+
+void ObjectTree::destroyLeaf(int leaf) {
+	removeLeaf(leaf);
+	freeNode(leaf);
+}
+
+void ObjectTree::insertLeaf(int leaf) {
+	if (_root == kNodeNone) {
+		_root = leaf;
+		_nodes[leaf].parent = kNodeNone;
+		return;
+	}
+
+	const Box box = _nodes[leaf].box;
+
+	/* Find the best sibling for the new leaf, by walking down the tree
+	 * along the branches whose boxes would grow the least. */
+	int sibling = _root;
+	while (!_nodes[sibling].isLeaf()) {
+		const Node &node = _nodes[sibling];
+
+		Box combined;
+		combine(node.box, box, combined);
+
+		const float area         = getArea(node.box);
+		const float combinedArea = getArea(combined);
+
+		// Cost of making a new parent for this node and the new leaf
+		const float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCost[2];
+		const int children[2] = { node.left, node.right };
+		for (int i = 0; i < 2; i++) {
+			const Node &child = _nodes[children[i]];
+
+			combine(child.box, box, combined);
+
+			childCost[i] = getArea(combined) + inheritanceCost;
+			if (!child.isLeaf())
+				childCost[i] -= getArea(child.box);
+		}
+
+		if ((cost < childCost[0]) && (cost < childCost[1]))
+			break;
+
+		sibling = (childCost[0] < childCost[1]) ? children[0] : children[1];
+	}
+
+	// Create a new parent for the sibling and the new leaf
+	const int oldParent = _nodes[sibling].parent;
+	const int newParent = allocateNode();
+
+	Node &parent = _nodes[newParent];
+
+	parent.parent = oldParent;
+	parent.left   = sibling;
+	parent.right  = leaf;
+	parent.height = _nodes[sibling].height + 1;
+	combine(_nodes[sibling].box, box, parent.box);
+
+	if (oldParent != kNodeNone) {
+		if (_nodes[oldParent].left == sibling)
+			_nodes[oldParent].left  = newParent;
+		else
+			_nodes[oldParent].right = newParent;
+	} else
+		_root = newParent;
+
+	_nodes[sibling].parent = newParent;
+	_nodes[leaf   ].parent = newParent;
+
+	refit(oldParent);
+}
+
+void ObjectTree::removeLeaf(int leaf) {
+	if (leaf == _root) {
+		_root = kNodeNone;
+		return;
+	}
+
+	const int parent      = _nodes[leaf].parent;
+	const int grandParent = _nodes[parent].parent;
+	const int sibling     = (_nodes[parent].left == leaf) ? _nodes[parent].right : _nodes[parent].left;
+
+	// Replace the parent with the sibling
+	if (grandParent != kNodeNone) {
+		if (_nodes[grandParent].left == parent)
+			_nodes[grandParent].left  = sibling;
+		else
+			_nodes[grandParent].right = sibling;
+	} else
+		_root = sibling;
+
+	_nodes[sibling].parent = grandParent;
+	_nodes[leaf   ].parent = kNodeNone;
+
+	freeNode(parent);
+
+	refit(grandParent);
+}
+
+void ObjectTree::refit(int node) {
+	while (node != kNodeNone) {
+		node = balance(node);
+
+		Node &n = _nodes[node];
+
+		const Node &left  = _nodes[n.left];
+		const Node &right = _nodes[n.right];
+
+		n.height = 1 + MAX(left.height, right.height);
+		combine(left.box, right.box, n.box);
+
+		node = n.parent;
+	}
+}
+
+int ObjectTree::balance(int a) {
+	Node &nodeA = _nodes[a];
+	if (nodeA.isLeaf() || (nodeA.height < 2))
+		return a;
+
+	const int b = nodeA.left;
+	const int c = nodeA.right;
+
+	Node &nodeB = _nodes[b];
+	Node &nodeC = _nodes[c];
+
+	const int difference = nodeC.height - nodeB.height;
+
+	if ((difference >= -1) && (difference <= 1))
+		return a;
+
+	/* One child is too high: Rotate it up into A's place, and hand its
+	 * higher child down to A in place of the rotated one. */
+
+	const int up       = (difference > 0) ? c : b;
+	const int stays    = (difference > 0) ? b : c;
+	Node     &nodeUp   = _nodes[up];
+
+	const int f = nodeUp.left;
+	const int g = nodeUp.right;
+
+	const int keep = (_nodes[f].height > _nodes[g].height) ? f : g;
+	const int move = (keep == f) ? g : f;
+
+	// Up takes A's place
+	nodeUp.parent = nodeA.parent;
+	if (nodeUp.parent != kNodeNone) {
+		if (_nodes[nodeUp.parent].left == a)
+			_nodes[nodeUp.parent].left  = up;
+		else
+			_nodes[nodeUp.parent].right = up;
+	} else
+		_root = up;
+
+	nodeUp.left  = a;
+	nodeUp.right = keep;
+	nodeA.parent = up;
+
+	// A gets the lower child of Up in its place
+	if (up == c)
+		nodeA.right = move;
+	else
+		nodeA.left  = move;
+
+	_nodes[move].parent = a;
+
+	combine(_nodes[stays].box, _nodes[move].box, nodeA.box);
+	nodeA.height = 1 + MAX(_nodes[stays].height, _nodes[move].height);
+
+	combine(nodeA.box, _nodes[keep].box, nodeUp.box);
+	nodeUp.height = 1 + MAX(nodeA.height, _nodes[keep].height);
+
+	return up;
+}
+
+bool ObjectTree::getBox(const Renderable &object, Box &box) {
+	return object.getWorldBound(box.min[0], box.min[1], box.min[2], box.max[0], box.max[1], box.max[2]);
+}
+
+void ObjectTree::combine(const Box &a, const Box &b, Box &result) {
+	for (int i = 0; i < 3; i++) {
+		result.min[i] = MIN(a.min[i], b.min[i]);
+		result.max[i] = MAX(a.max[i], b.max[i]);
+	}
+}
+
+float ObjectTree::getArea(const Box &box) {
+	const float x = box.max[0] - box.min[0];
+	const float y = box.max[1] - box.min[1];
+	const float z = box.max[2] - box.min[2];
+
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+bool ObjectTree::contains(const Box &outer, const Box &inner) {
+	for (int i = 0; i < 3; i++)
+		if ((inner.min[i] < outer.min[i]) || (inner.max[i] > outer.max[i]))
+			return false;
+
+	return true;
+}
+
+bool ObjectTree::overlaps(const Box &a, const Box &b) {
+	for (int i = 0; i < 3; i++)
+		if ((a.max[i] < b.min[i]) || (a.min[i] > b.max[i]))
+			return false;
+
+	return true;
+}
+
+bool ObjectTree::overlaps(const Box &box, float x, float y, float z, float radius) {
+	const float center[3] = { x, y, z };
+
+	// Distance from the center of the sphere to the closest point in the box
+	float distance = 0.0f;
+	for (int i = 0; i < 3; i++) {
+		const float closest = CLIP(center[i], box.min[i], box.max[i]);
+
+		distance += (center[i] - closest) * (center[i] - closest);
+	}
+
+	return distance <= (radius * radius);
+}
+
+bool ObjectTree::intersect(const Box &box, const float *start, const float *direction, float &t) {
+	// Slab test: clip the line against the three pairs of parallel box sides
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+
+	for (int i = 0; i < 3; i++) {
+		if (ABS(direction[i]) < 1e-9f) {
+			// Parallel to this pair of sides
+			if ((start[i] < box.min[i]) || (start[i] > box.max[i]))
+				return false;
+
+			continue;
+		}
+
+		float t1 = (box.min[i] - start[i]) / direction[i];
+		float t2 = (box.max[i] - start[i]) / direction[i];
+		if (t1 > t2)
+			SWAP(t1, t2);
+
+		tMin = MAX(tMin, t1);
+		tMax = MIN(tMax, t2);
+
+		if (tMin > tMax)
+			return false;
+	}
+
+	t = tMin;
+	return true;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,164 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A bounding volume hierarchy over world objects, for picking and area queries.
+ */
+
+#ifndef GRAPHICS_OBJECTTREE_H
+#define GRAPHICS_OBJECTTREE_H
+
+#include <vector>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/mutex.h"
+
+namespace Graphics {
+
+class Renderable;
+
+/** A dynamic bounding volume hierarchy over the bounding boxes of renderables.
+ *
+ *  Every object is a leaf in a balanced binary tree of axis-aligned boxes,
+ *  so that a query only needs to look at the objects in the branches that
+ *  overlap with it.
+ *
+ *  The leaves are stored with a bit of margin around their boxes. When an
+ *  object moves only slightly, its leaf still contains it and the tree stays
+ *  as it is. Only when it leaves the margin is the leaf reinserted.
+ *
+ *  All methods are thread-safe. However, the tree reads the bounding boxes
+ *  of the objects, and findNearest() checks the objects themselves for
+ *  the final hit. The caller has to make sure the objects don't change
+ *  while that happens.
+ */
+class ObjectTree : boost::noncopyable {
+public:
+	ObjectTree();
+	~ObjectTree();
+
+	/** Remove all objects from the tree. */
+	void clear();
+
+	/** Add an object to the tree.
+	 *
+	 *  If the object doesn't have a bounding box yet, it's kept track of
+	 *  and will appear in the tree once update() finds one.
+	 */
+	void add(Renderable &object);
+	/** Update the position of an object already in the tree, after its bounding box changed. */
+	void update(Renderable &object);
+	/** Remove an object from the tree. */
+	void remove(Renderable &object);
+
+	/** Find the object nearest to the start of the line from x1.y1.z1 to x2.y2.z2.
+	 *
+	 *  Only objects whose bounding boxes intersect with the line and whose own
+	 *  isIn() check for the line succeeds are considered.
+	 *
+	 *  @param  clickable If true, only consider clickable objects.
+	 *  @return The nearest such object, or 0 if there is none.
+	 */
+	Renderable *findNearest(float x1, float y1, float z1, float x2, float y2, float z2,
+	                        bool clickable) const;
+
+	/** Find all objects whose bounding boxes intersect with this box. */
+	void findInBox(float minX, float minY, float minZ, float maxX, float maxY, float maxZ,
+	               std::vector<Renderable *> &objects) const;
+	/** Find all objects whose bounding boxes intersect with this sphere. */
+	void findInSphere(float x, float y, float z, float radius,
+	                  std::vector<Renderable *> &objects) const;
+
+private:
+	/** An axis-aligned box. */
+	struct Box {
+		float min[3];
+		float max[3];
+	};
+
+	/** A node in the tree. Leaves contain an object, inner nodes exactly two children. */
+	struct Node {
+		Box box; ///< The bounding box of the node, including the margin for leaves.
+
+		Box objectBox; ///< For leaves, the actual bounding box of the object.
+
+		Renderable *object; ///< For leaves, the object.
+
+		int parent; ///< The parent node, or the next free node for unused nodes.
+		int left;   ///< The left child, or kNodeNone for leaves.
+		int right;  ///< The right child, or kNodeNone for leaves.
+
+		int height; ///< Height of the subtree, 0 for leaves and -1 for unused nodes.
+
+		Node();
+
+		bool isLeaf() const;
+	};
+
+	typedef std::map<Renderable *, int> ObjectMap;
+
+	static const int kNodeNone = -1;
+
+	std::vector<Node> _nodes; ///< All nodes, used and unused.
+
+	int _root;     ///< The root node of the tree.
+	int _freeNode; ///< The first unused node.
+
+	/** The leaf of each object in the tree, or kNodeNone if it has no bounding box. */
+	ObjectMap _objects;
+
+	mutable Common::Mutex _mutex;
+
+	int  allocateNode();
+	void freeNode(int node);
+
+	/** Create a leaf for an object with this bounding box and insert it. */
+	int createLeaf(Renderable &object, const Box &box);
+	/** Remove a leaf from the tree and free it. */
+	void destroyLeaf(int leaf);
+
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+
+	/** Fix up the boxes and heights from that node upwards, rebalancing on the way. */
+	void refit(int node);
+	/** Rotate the tree at that node if it's out of balance, returning the node now in its place. */
+	int balance(int node);
+
+	/** Get the bounding box of an object. */
+	static bool getBox(const Renderable &object, Box &box);
+
+	static void combine(const Box &a, const Box &b, Box &result);
+	static float getArea(const Box &box);
+
+	static bool contains(const Box &outer, const Box &inner);
+	static bool overlaps(const Box &a, const Box &b);
+	static bool overlaps(const Box &box, float x, float y, float z, float radius);
+
+	/** Where does the line start + t * direction, with t in [0, 1], enter this box? */
+	static bool intersect(const Box &box, const float *start, const float *direction, float &t);
+};
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_OBJECTTREE_H
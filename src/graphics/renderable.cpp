@@ -30,7 +30,9 @@
 
 namespace Graphics {
 
-Renderable::Renderable(RenderableType type) : _clickable(false), _distance(0.0f) {
+Renderable::Renderable(RenderableType type) : _clickable(false), _distance(0.0f),
+	_worldBoundChanged(false) {
+
 	switch (type) {
 		case kRenderableTypeVideo:
 			_queueExists  = kQueueVideo;
@@ -112,11 +114,18 @@ void Renderable::show() {
 	addToQueue(_queueVisible);
 	sortQueue(_queueVisible);
 
+	// Still locked, so that the object isn't animated while its bounding box is read
+	if (_queueVisible == kQueueVisibleWorldObject)
+		GfxMan.addWorldObject(*this);
+
 	unlockQueue(_queueVisible);
 }
 
 void Renderable::hide() {
 	removeFromQueue(_queueVisible);
+
+	if (_queueVisible == kQueueVisibleWorldObject)
+		GfxMan.removeWorldObject(*this);
 }
 
 bool Renderable::isIn(float UNUSED(x), float UNUSED(y)) const {
@@ -133,6 +142,21 @@ bool Renderable::isIn(float UNUSED(x1), float UNUSED(y1), float UNUSED(z1),
 	return false;
 }
 
+bool Renderable::isInFrustum(const Frustum &UNUSED(frustum)) const {
+	return true;
+}
+
+bool Renderable::getWorldBound(float &UNUSED(minX), float &UNUSED(minY), float &UNUSED(minZ),
+                               float &UNUSED(maxX), float &UNUSED(maxY), float &UNUSED(maxZ)) const {
+
+	return false;
+}
+
+void Renderable::invalidateWorldBound() {
+	if (_queueVisible == kQueueVisibleWorldObject)
+		_worldBoundChanged.store(true, boost::memory_order_release);
+}
+
 void Renderable::lockFrame() {
 	GfxMan.lockFrame();
 }
@@ -26,6 +26,7 @@
 #define GRAPHICS_RENDERABLE_H
 
 #include <boost/noncopyable.hpp>
+#include <boost/atomic.hpp>
 
 #include "src/common/ustring.h"
 
@@ -36,6 +37,8 @@
 
 namespace Graphics {
 
+class Frustum;
+
 /** An object that can be displayed by the graphics manager. */
 class Renderable : boost::noncopyable, public Queueable {
 public:
@@ -47,7 +50,16 @@ public:
 	/** Calculate the object's distance. */
 	virtual void calculateDistance() = 0;
 
-	/** Advance time (used by renderables with animations). */
+	/** Advance time (used by renderables with animations).
+	 *
+	 *  The GraphicsManager calls this for all visible world objects before
+	 *  rendering a frame, possibly on several worker threads at the same
+	 *  time. It must therefore only modify the renderable itself, and it
+	 *  must not lock the frame.
+	 *
+	 *  All calls have finished before the frame's first object is rendered,
+	 *  and they never run while another thread holds the frame lock.
+	 */
 	virtual void advanceTime(float dt);
 
 	/** Render the object. */
@@ -81,6 +93,23 @@ public:
 	/** Does the line from x1.y1.z1 to x2.y2.z2 intersect with the object? */
 	virtual bool isIn(float x1, float y1, float z1, float x2, float y2, float z2) const;
 
+	/** Is the object at least partially within that view frustum?
+	 *
+	 *  Objects outside are not rendered. By default, an object is always
+	 *  considered to be inside.
+	 */
+	virtual bool isInFrustum(const Frustum &frustum) const;
+
+	/** Get the object's bounding box in world coordinates.
+	 *
+	 *  Visible world objects with a bounding box are found by picking and
+	 *  area queries through the GraphicsManager's object tree.
+	 *
+	 *  @return false if the object has no bounding box (the default).
+	 */
+	virtual bool getWorldBound(float &minX, float &minY, float &minZ,
+	                           float &maxX, float &maxY, float &maxZ) const;
+
 protected:
 	QueueType _queueExists;
 	QueueType _queueVisible;
@@ -94,11 +123,25 @@ protected:
 
 	void resort();
 
+	/** Mark the object's world bounding box as changed.
+	 *
+	 *  This is safe to call from within advanceTime(). The GraphicsManager
+	 *  updates its object tree with the new bounding box before the next
+	 *  frame is rendered.
+	 */
+	void invalidateWorldBound();
+
 	void lockFrame();
 	void unlockFrame();
 
 	void lockFrameIfVisible();
 	void unlockFrameIfVisible();
+
+private:
+	/** Has the world bounding box changed since the object tree was updated? */
+	boost::atomic<bool> _worldBoundChanged;
+
+	friend class GraphicsManager;
 };
 
 } // End of namespace Graphics
@@ -117,7 +117,7 @@ void XMVWMV2Codec::CBP::decode(uint32 cbp, const CBP &topLeft, const CBP &top,
 }
 
 
-XMVWMV2Codec::DecodeContext::DecodeContext(Common::BitStream &b) : bits(b),
+XMVWMV2Codec::DecodeContext::DecodeContext(Common::BitStream32LEMSB &b) : bits(b),
 	hasACPerMacroBlock(false), hasACPrediction(false),
 	acRLERunLength(0), acRLELevelLength(0) {
 
@@ -801,7 +801,7 @@ void XMVWMV2Codec::IDCTCol(int32 *b) {
 	b[8 * 7] = (a0 + a2 - a1 - a5 + (1 << 13)) >> 14;
 }
 
-uint8 XMVWMV2Codec::getTrit(Common::BitStream &bits) {
+uint8 XMVWMV2Codec::getTrit(Common::BitStream32LEMSB &bits) {
 	// 0 -> 0;  10 -> 1;  11 -> 2
 
 	uint8 n = bits.getBit();
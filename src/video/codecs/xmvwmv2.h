@@ -52,11 +52,11 @@
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
+#include "src/common/bitstream.h"
 
 #include "src/video/codecs/codec.h"
 
 namespace Common {
-	class BitStream;
 	class Huffman;
 }
 
@@ -130,7 +130,7 @@ private:
 
 	/** Context for decoding a frame. */
 	struct DecodeContext {
-		Common::BitStream &bits;
+		Common::BitStream32LEMSB &bits;
 
 		int32 qScale;
 		int32 dcStepSize;
@@ -159,7 +159,7 @@ private:
 		BlockContext block[6];
 
 
-		DecodeContext(Common::BitStream &b);
+		DecodeContext(Common::BitStream32LEMSB &b);
 
 		/** Set the quantizer scale and calculate the DC step size and default predictor. */
 		void setQScale(int32 qS);
@@ -253,7 +253,7 @@ private:
 	void decodeIBlock(DecodeContext &ctx, BlockContext &block);
 
 	/** Decode a "tri-state". */
-	static uint8 getTrit(Common::BitStream &bits);
+	static uint8 getTrit(Common::BitStream32LEMSB &bits);
 
 	// IDCT
 
@@ -48,6 +48,9 @@
 #include "src/aurora/talkman.h"
 #include "src/aurora/util.h"
 
+#include "src/aurora/nwscript/ncsprogram.h"
+#include "src/aurora/nwscript/profiler.h"
+
 #include "src/graphics/queueman.h"
 #include "src/graphics/graphics.h"
 
@@ -256,6 +259,8 @@ static void initConfig() {
 
 	ConfigMan.setBool(Common::kConfigRealmDefault, "skipvideos", false);
 
+	ConfigMan.setBool(Common::kConfigRealmDefault, "resourceindex", true);
+
 	ConfigMan.setBool(Common::kConfigRealmDefault, "saveconf", true);
 
 	// Populate the new config with the defaults
@@ -319,6 +324,8 @@ static void deinit() {
 	Aurora::LanguageManager::destroy();
 	Aurora::TalkManager::destroy();
 	Aurora::TwoDARegistry::destroy();
+	Aurora::NWScript::NCSProgramCache::destroy();
+	Aurora::NWScript::Profiler::destroy();
 	Aurora::ResourceManager::destroy();
 	Aurora::FileTypeManager::destroy();
 